@@ -0,0 +1,119 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+
+#include <util/file_utils.hpp>
+#include <core/thread_pool.hpp>
+#include <core/graphics/mesh.hpp>
+#include <core/platform/async_io.hpp>
+
+namespace Engine {
+
+class Renderer;
+class FileWatcher;
+
+/**
+ * @class AssetLoader
+ * @brief Parses assets on worker threads and hands them to the renderer at frame boundaries.
+ *
+ * Loads return a handle immediately. Its mesh handle is usable right away and
+ * draws a placeholder until the real data has been parsed and uploaded.
+ * With a FileWatcher attached, changed files are reloaded behind the same handle.
+ * Cooked meshes are read through AsyncIO, so many of them can be in flight at once
+ * while streaming, and decoded on the worker that completes the read.
+ */
+class AssetLoader {
+public:
+  enum class State : uint8_t {
+    Pending,
+    Ready,
+    Failed,
+  };
+
+  struct MeshOptions {
+    bool generate_lods = false;
+    bool build_meshlets = false;
+  };
+
+private:
+  struct Request {
+    File::Path path;
+    MeshOptions options;
+    Mesh::Handle mesh = Mesh::InvalidHandle;
+    std::atomic<State> state = State::Pending;
+    uint32_t sequence = 0; /* bumped by every (re)load, main thread only */
+  };
+
+  struct Completion {
+    std::shared_ptr<Request> request;
+    uint32_t sequence = 0; /* of the load that produced it, older ones are dropped */
+    std::optional<Mesh> mesh;
+  };
+
+public:
+  /* Future-style view of a load request, cheap to copy */
+  class MeshHandle {
+    std::shared_ptr<const Request> request;
+
+    friend class AssetLoader;
+    explicit MeshHandle(std::shared_ptr<const Request> _request) noexcept : request(std::move(_request)) {}
+
+  public:
+    MeshHandle() noexcept = default;
+
+    inline State getState() const noexcept {
+      return request ? request->state.load(std::memory_order_acquire) : State::Failed;
+    }
+
+    inline bool isPending() const noexcept { return getState() == State::Pending; }
+    inline bool isReady()   const noexcept { return getState() == State::Ready; }
+    inline bool isFailed()  const noexcept { return getState() == State::Failed; }
+
+    /** Mesh handle, valid immediately (renders the placeholder while pending) */
+    inline Mesh::Handle getMesh() const noexcept { return request ? request->mesh : Mesh::InvalidHandle; }
+  };
+
+  explicit AssetLoader(Renderer &, uint32_t worker_threads = 0, FileWatcher * = nullptr);
+  ~AssetLoader() noexcept = default;
+
+  AssetLoader(const AssetLoader &) = delete;
+  AssetLoader &operator=(const AssetLoader &) = delete;
+
+  /** Queue an OBJ, glTF or cooked mesh for loading, loading the same file with the same options again shares the request */
+  MeshHandle loadMesh(File::Path, MeshOptions);
+  inline MeshHandle loadMesh(File::Path path) { return loadMesh(std::move(path), MeshOptions{}); }
+
+  /** Main thread, once per frame: hands finished meshes over to the renderer */
+  void update();
+
+  inline Mesh::Handle getPlaceholderMesh() const noexcept { return placeholder; }
+
+private:
+  Renderer &renderer;
+  FileWatcher *watcher = nullptr;
+  Mesh::StagingAllocator staging_allocator; /* lets workers decode straight into upload memory */
+  Mesh::Handle placeholder = Mesh::InvalidHandle;
+
+  std::unordered_map<std::string, std::shared_ptr<Request>> requests; /* by path and options */
+
+  std::mutex completed_mutex;
+  std::vector<Completion> completed;
+
+  /* workers are joined before anything they touch is destroyed */
+  ThreadPool workers;
+
+  /* last member: drains its reads while the workers that run their callbacks are still alive */
+  AsyncIO io;
+
+  void enqueue(std::shared_ptr<Request>);
+  void read(std::shared_ptr<Request>, uint32_t sequence);
+  void process(std::shared_ptr<Request>, uint32_t sequence);
+  void complete(std::shared_ptr<Request>, uint32_t sequence, std::optional<Mesh>);
+};
+
+} /* namespace Engine */
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <string_view>
+
+#include <util/hash.hpp>
+#include <util/file_utils.hpp>
+
+namespace Engine {
+
+/*
+ * Read-only asset archive, memory-mapped as a whole:
+ *   Header
+ *   entry data, every entry aligned to 16 bytes
+ *   Entry [entry_count] sorted by path hash
+ *   name table, the entry paths back to back
+ * Paths are relative to the packed directory, with forward slashes.
+ */
+class Pack {
+public:
+  enum class Compression : uint32_t {
+    None = 0, /* readable in place, see view() */
+    LZ   = 1, /* util/lz.hpp */
+  };
+
+  struct Header {
+    static constexpr uint32_t MAGIC   = 0x4B415045; /* "EPAK" */
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t entry_count = 0;
+    uint32_t name_table_size = 0;
+    uint64_t toc_offset = 0;
+    uint64_t name_table_offset = 0;
+  };
+
+  struct Entry {
+    Hash::Hash128 path_hash {};
+    uint64_t offset = 0;      /* from the start of the archive */
+    uint64_t stored_size = 0; /* bytes in the archive */
+    uint64_t size = 0;        /* bytes once decompressed */
+    uint32_t name_offset = 0; /* into the name table */
+    uint32_t name_length = 0;
+    Compression compression = Compression::None;
+    uint32_t reserved = 0;
+  };
+
+  class Writer;
+
+  Pack() noexcept = default;
+  ~Pack() noexcept = default;
+
+  Pack(Pack &&) noexcept = default;
+  Pack &operator=(Pack &&) noexcept = default;
+
+  /* Maps the archive and validates its table of contents */
+  bool open(const File::Path &);
+  void close() noexcept;
+
+  inline bool isOpen() const noexcept { return mapping.isOpen(); }
+  inline const File::Path &getPath() const noexcept { return path; }
+
+  /* Binary search over the sorted hashes, nullptr if the archive has no such path */
+  const Entry *find(std::string_view path) const;
+
+  /* Stored bytes of an uncompressed entry straight from the mapping, empty for compressed ones */
+  std::span<const char> view(const Entry &) const;
+
+  /* Decompressed contents, `out` has to be exactly Entry::size bytes */
+  bool read(const Entry &, std::span<char> out) const;
+  bool read(const Entry &, std::vector<char> &) const;
+
+  std::string_view getName(const Entry &) const;
+  inline std::span<const Entry> getEntries() const noexcept { return entries; }
+
+  /* Forward slashes, no `.` or `..` components, no leading slash */
+  static std::string normalizePath(std::string_view);
+  static Hash::Hash128 hashPath(std::string_view normalized);
+
+private:
+  File::Path path;
+  File::MappedFile mapping;
+  std::span<const Entry> entries;
+  std::string_view names;
+};
+
+/* Streams entries into a new archive, the table of contents is written by finish() */
+class Pack::Writer {
+public:
+  Writer() noexcept = default;
+  ~Writer() noexcept = default;
+
+  bool open(const File::Path &);
+
+  /* Compression::LZ falls back to storing entries it does not shrink */
+  bool add(std::string_view path, std::span<const char> data, Compression);
+
+  bool finish();
+
+  inline size_t getEntryCount() const noexcept { return entries.size(); }
+  inline uint64_t getStoredBytes() const noexcept { return offset - sizeof(Header); }
+
+private:
+  File::Path path;
+  std::ofstream ofs;
+  std::vector<Entry> entries;
+  std::string names;
+  uint64_t offset = 0;
+
+  bool pad();
+};
+
+} /* namespace Engine */
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include <util/hash.hpp>
+#include <util/file_utils.hpp>
+#include <core/assets/pack.hpp>
+
+namespace File {
+
+/* Read-only contents of a file, together with whatever keeps the bytes alive */
+class Data {
+  MappedFile mapping;         /* loose files */
+  Buffer buffer;              /* compressed pack entries */
+  std::span<const char> bytes; /* into either of them, or straight into a pack mapping */
+
+  friend class VFS;
+
+public:
+  Data() noexcept = default;
+
+  /* Plain OS path, no VFS involved */
+  bool map(const Path &, MappedFile::Access = MappedFile::Access::Sequential);
+
+  inline const char *data() const noexcept { return bytes.data(); }
+  inline size_t size() const noexcept { return bytes.size(); }
+  inline std::span<const char> view() const noexcept { return bytes; }
+};
+
+/**
+ * @class VFS
+ * @brief Virtual file system over mounted directories and pack archives.
+ *
+ * Every mount is indexed once, by the hash of each normalized virtual path, so
+ * lookups never touch the disk. A path present in several mounts resolves to the
+ * mount with the highest priority, later mounts winning ties: a patch mounted
+ * after the base game overrides it. Mount everything up front, lookups are safe
+ * from any thread afterwards.
+ */
+class VFS {
+public:
+  /* Where the bytes of a file are stored */
+  struct Location {
+    Path file;               /* the loose file, or the archive holding it */
+    uint64_t offset = 0;
+    uint64_t size = 0;       /* stored bytes, as indexed at mount time */
+    bool packed = false;
+    bool compressed = false; /* the stored bytes have to go through Engine::Pack::read */
+  };
+
+  VFS() noexcept = default;
+  ~VFS() noexcept = default;
+
+  VFS(const VFS &) = delete;
+  VFS &operator=(const VFS &) = delete;
+
+  /* `mount_point` prefixes every path of the mount, empty mounts at the root */
+  bool mountDirectory(const Path &directory, std::string_view mount_point = {}, int priority = 0);
+  bool mountPack(const Path &archive, std::string_view mount_point = {}, int priority = 0);
+
+  /* Directories as directories, anything else as a pack */
+  bool mount(const Path &source, std::string_view mount_point = {}, int priority = 0);
+
+  bool exists(std::string_view path) const;
+  std::optional<Location> locate(std::string_view path) const;
+
+  /* Loose files are mapped, stored pack entries viewed in place and compressed ones decompressed */
+  bool open(std::string_view path, Data &, MappedFile::Access = MappedFile::Access::Sequential) const;
+
+  inline size_t getFileCount() const noexcept { return index.size(); }
+
+  /* The engine-wide instance File::load goes through, installed by Engine::Instance */
+  static inline VFS *instance() noexcept { return installed; }
+  static inline void setInstance(VFS *vfs) noexcept { installed = vfs; }
+
+private:
+  struct Mount {
+    Path source;
+    std::string point;
+    int priority = 0;
+    std::unique_ptr<Engine::Pack> pack; /* stable, the index points into its table of contents */
+  };
+
+  struct Node {
+    std::string path; /* normalized, settles hash collisions */
+    uint32_t mount = 0;
+    uint64_t size = 0;
+    const Engine::Pack::Entry *entry = nullptr; /* pack mounts only */
+  };
+
+  std::vector<Mount> mounts;
+  std::unordered_map<Hash::Hash128, Node, Hash::Hash128Hasher> index;
+
+  static inline VFS *installed = nullptr;
+
+  void insert(Node);
+  const Node *find(std::string_view path) const;
+  Path realPath(const Node &) const;
+};
+
+/* Loader entry points: through the installed VFS when it knows `path`, the OS path otherwise */
+bool load(const Path &, Data &, MappedFile::Access = MappedFile::Access::Sequential);
+std::optional<VFS::Location> locate(const Path &);
+
+} /* namespace File */
@@ -20,12 +20,14 @@ struct Config {
   struct Window;
   struct Renderer;
   struct Camera;
+  struct Assets;
 
   /* essential configs for engine initialization */
   Config::Logger &logger;
   Config::Window &window;
   Config::Renderer &renderer;
   Config::Camera &camera;
+  Config::Assets &assets;
 };
 
 struct Config::Logger {
@@ -53,6 +55,21 @@ struct Config::Renderer {
 
   bool vsync = false;
   uint32_t frames_in_flight = 3;
+
+  /* largest screen-space error (in pixels) a mesh LOD may introduce */
+  float lod_pixel_error = 1.0f;
+
+  /* bytes of mesh data uploaded per frame at most, larger meshes still go up alone */
+  size_t upload_budget = 32ull * 1024 * 1024;
+
+  /* what happens to CPU copies of mesh data after upload */
+  MeshInfo::Residency mesh_residency = MeshInfo::Residency::Release;
+
+  /* SPIR-V of shaders/cull.comp, instances are culled on the GPU when set */
+  File::Path cull_shader {};
+
+  /* compiled pipelines kept across runs (an OS path, not a VFS one), empty keeps them in memory only */
+  File::Path pipeline_cache {};
 };
 
 struct Config::Camera {
@@ -70,4 +87,24 @@ struct Config::Camera {
 
 };
 
+struct Config::Assets {
+  /* a directory or a pack archive, mounted into the virtual file system under `mount_point` */
+  struct Mount {
+    File::Path source;
+    std::string mount_point {};
+
+    /* the highest priority wins where mounts overlap, later mounts win ties */
+    int priority = 0;
+  };
+
+  /* asset and shader paths resolve through these first, then relative to the working directory */
+  std::vector<Mount> mounts;
+
+  /* background loader threads, 0 picks one per hardware thread minus the main thread */
+  uint32_t worker_threads = 0;
+
+  /* watch loaded meshes and shaders on disk and reload them when they change */
+  bool hot_reload = false;
+};
+
 } /* namespace Engine */
\ No newline at end of file
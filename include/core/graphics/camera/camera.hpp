@@ -47,9 +47,17 @@ public:
   inline glm::vec3 getPosition() const { return position; }
   inline glm::vec3 getOrientation() const { return orientation; }
 
+  /* width / height of the viewport, for projections that depend on it */
+  virtual void setAspectRatio(float) {}
+
   virtual glm::mat4 getProjectionMatrix() const = 0;
   virtual glm::mat4 getViewMatrix() const = 0;
 
+  /* pixels covered by one world unit at distance 1, used for screen-space error metrics */
+  inline float getProjectionScale(float viewport_height) const {
+    return getProjectionMatrix()[1][1] * viewport_height * 0.5f;
+  }
+
 };
 
 };
\ No newline at end of file
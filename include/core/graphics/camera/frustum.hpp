@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+/* View frustum as six inward-facing planes (xyz = normal, w = distance) */
+struct Frustum {
+  std::array<glm::vec4, 6> planes {};
+
+  /*
+   * Extracts the planes from a combined projection * view (* model) matrix (Gribb-Hartmann).
+   * Passing a model matrix in as well yields the frustum in that object's local space.
+   * The near plane is where Vulkan clips, 0 <= z <= w, whatever depth range the projection
+   * was built for. OpenGL clips at -w <= z instead, see `zero_to_one_depth`.
+   */
+  static Frustum fromMatrix(const glm::mat4 &m, bool zero_to_one_depth = true) noexcept {
+    auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0); /* left */
+    frustum.planes[1] = row(3) - row(0); /* right */
+    frustum.planes[2] = row(3) + row(1); /* bottom */
+    frustum.planes[3] = row(3) - row(1); /* top */
+    frustum.planes[4] = zero_to_one_depth ? row(2) : row(3) + row(2); /* near */
+    frustum.planes[5] = row(3) - row(2); /* far */
+
+    for (glm::vec4 &plane : frustum.planes)
+      plane = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+
+    return frustum;
+  }
+
+  inline bool intersectsSphere(glm::vec3 center, float radius) const noexcept {
+    for (const glm::vec4 &plane : planes)
+      if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+        return false;
+    return true;
+  }
+};
+
+} /* namespace Engine */
@@ -18,6 +18,7 @@ public:
       aspect(_aspect) {};
   ~Perspective() noexcept = default;
 
+  inline void setAspectRatio(float _aspect) override { aspect = _aspect; }
 
   glm::mat4 getProjectionMatrix() const override {
     return glm::perspective(glm::radians(fov), aspect, near, far);
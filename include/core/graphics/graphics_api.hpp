@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <cstdint>
 #include <glm/vec3.hpp>
 
@@ -14,6 +15,8 @@ struct DrawInfo {
   virtual ~DrawInfo() noexcept = default;
 
   uint32_t index_count = 0;
+  uint32_t instance_count = 1;
+  uint32_t first_instance = 0; /* record of the first instance, see GraphicsAPI::mapInstances */
 
   struct OpenGL;
   struct Vulkan;
@@ -40,9 +43,22 @@ public:
 
   virtual bool init(Window *) = 0;
   virtual void enableVsync() = 0;
+  /* False when no frame could be started (e.g. minimized), nothing is recorded or ended until the next one */
   virtual bool beginFrame() = 0;
   virtual bool endFrame(Window *) = 0;
+
+  /* The window's framebuffer changed size, picked up by the next beginFrame */
+  virtual void resize(uint32_t width, uint32_t height) = 0;
   virtual bool drawIndexed(DrawInfo &) = 0;
+
+  /* Issues the draws queued for the bound pipeline, see MeshManager::queueDraw */
+  virtual bool flushDraws() = 0;
+
+  /*
+   * Per-instance records of the frame's draws, `count` of them, written once per frame
+   * before the first pipeline is bound. Empty when they cannot be provided.
+   */
+  virtual std::span<Mesh::InstanceData> mapInstances(uint32_t count) = 0;
   virtual bool updateUBO(UniformBufferType, const void *, size_t, size_t) = 0;
   virtual void setClearColor(glm::vec3, float = 1.0f) = 0;
 
@@ -2,12 +2,23 @@
 #include <glm/glm.hpp>
 #include <span>
 #include <vector>
+#include <limits>
+#include <future>
+#include <memory>
+#include <cassert>
 #include <optional>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
 
+#include <util/hash.hpp>
 #include <util/file_utils.hpp>
+#include <core/graphics/camera/frustum.hpp>
 
 namespace Engine {
 
+class ThreadPool;
+
 class Mesh {
 public:
 
@@ -16,31 +27,262 @@ public:
     glm::vec3 color;
     glm::vec2 uv;
     glm::vec3 normal;
+    glm::vec4 tangent; /* xyz tangent, w the bitangent sign: bitangent = w * cross(normal, tangent) */
   };
 
   using Handle = uint32_t;
   using Index = uint32_t;
   static constexpr Handle InvalidHandle = std::numeric_limits<Handle>::max();
 
+  /* Per-instance record vertex shaders fetch with gl_InstanceIndex, std430 layout of block.vert's InstanceData */
+  struct InstanceData {
+    glm::mat4 model { 1.0f };
+    uint32_t material = 0;
+    uint32_t padding[3] {};
+  };
+
+  /* Object-space axis-aligned box and the sphere around its center that encloses every vertex */
+  struct Bounds {
+    glm::vec3 min {};
+    glm::vec3 max {};
+    glm::vec3 center {};
+    float radius = 0.0f;
+  };
+
+  /* a contiguous run of indices inside the mesh index buffer */
+  struct IndexRange {
+    uint32_t first_index = 0;
+    uint32_t index_count = 0;
+  };
+
+  /*
+   * One level of detail. All levels share the vertex buffer of the mesh,
+   * `error` is the object-space deviation from the full-resolution surface.
+   */
+  struct LOD {
+    IndexRange range;
+    float error = 0.0f;
+    Bounds bounds {}; /* of the vertices this level references */
+  };
+
+  struct LODSettings {
+    /* target triangle count of each level, relative to LOD 0 */
+    std::vector<float> ratios { 0.5f, 0.25f, 0.125f, 0.0625f };
+
+    /* chain stops once a level would deviate more than this (fraction of the mesh radius) */
+    float max_error = 0.05f;
+  };
+
+  struct NormalSettings {
+    /* faces meeting at a sharper angle (degrees) keep separate normals, splitting the vertex */
+    float crease_angle = 60.0f;
+
+    /* optional, the kernels run on the calling thread alone without one */
+    ThreadPool *pool = nullptr;
+  };
+
+  /*
+   * A cluster of LOD 0 triangles, small enough to be culled on its own.
+   * The cluster triangles are stored contiguously, so a surviving meshlet is simply an index range.
+   */
+  struct Meshlet {
+    IndexRange range;
+    uint32_t vertex_count = 0;
+
+    /* bounding sphere */
+    glm::vec3 center {};
+    float radius = 0.0f;
+
+    /* normal cone for backface culling (counter-clockwise front faces), cutoff 1 disables it */
+    glm::vec3 cone_axis {};
+    float cone_cutoff = 1.0f;
+  };
+
+  static constexpr size_t MESHLET_MAX_VERTICES  = 64;
+  static constexpr size_t MESHLET_MAX_TRIANGLES = 124;
+
+  /*
+   * Memory handed out by a renderer (see MeshManager::getStagingAllocator) that importers
+   * decode vertices and indices into directly, instead of the mesh's own vectors.
+   * Vertices come first, indices follow.
+   */
+  class Staging {
+  public:
+    virtual ~Staging() noexcept = default;
+
+    virtual std::span<Vertex> getVertices() = 0;
+    virtual std::span<Index> getIndices() = 0;
+  };
+
+  /* Returns staging memory for the given vertex and index counts, or nullptr to fall back to the heap */
+  using StagingAllocator = std::function<std::shared_ptr<Staging>(size_t vertex_count, size_t index_count)>;
+
   Mesh() noexcept = default;
+  Mesh(std::vector<Vertex> _vertices, std::vector<Index> _indices) noexcept;
   ~Mesh() noexcept = default;
 
-  inline std::span<Vertex> getVerticesView() { return std::span<Mesh::Vertex>{vertices}; }
-  inline std::span<Index> getIndicesView() { return std::span<Mesh::Index>{indices}; }
+  inline std::span<Vertex> getVerticesView() { return staging ? staging->getVertices() : std::span<Mesh::Vertex>{vertices}; }
+  inline std::span<Index> getIndicesView() { return staging ? staging->getIndices() : std::span<Mesh::Index>{indices}; }
+  inline std::span<const LOD> getLODs() const { return std::span<const LOD>{lods}; }
+  inline std::span<const Meshlet> getMeshlets() const { return std::span<const Meshlet>{meshlets}; }
+  inline const Bounds &getBounds() const { return bounds; }
+
+  /* Staged meshes have fixed-size buffers, LODs and meshlets have to be generated before staging */
+  inline bool isStaged() const { return staging != nullptr; }
+
+  /*
+   * Both importers decode straight into `allocator` memory when one is given.
+   * OBJ faces without `vn` get smooth normals, OBJ tangents are always generated, on `pool` if given.
+   */
+  static std::optional<Mesh> fromOBJ(File::Path, const StagingAllocator &allocator = nullptr, ThreadPool *pool = nullptr);
+
+  /*
+   * All triangle primitives of a glTF (.gltf or .glb) file merged into one mesh, node transforms are not applied.
+   * Normals are generated when a primitive has none, tangents always.
+   */
+  static std::optional<Mesh> fromGLTF(File::Path, const StagingAllocator &allocator = nullptr, ThreadPool *pool = nullptr);
+
+  /* Cooked (engine-native) mesh format, written by the asset pipeline */
+  static constexpr uint32_t COOKED_VERSION = 4; /* 2: Mesh::Vertex::tangent, 3: bounds, 4: compressed streams */
+  static std::optional<Mesh> fromCooked(File::Path, const StagingAllocator &allocator = nullptr);
+  /* Same format from bytes already in memory, `name` only labels error messages */
+  static std::optional<Mesh> fromCooked(std::span<const char> data, std::string_view name, const StagingAllocator &allocator = nullptr);
+  bool writeCooked(File::Path) const;
+
+  /*
+   * Replaces all normals with area- and angle-weighted smooth normals. Positions are welded first,
+   * so UV seams stay smooth, while edges sharper than the crease angle split their vertices.
+   * Has to run before LODs and meshlets are built. Returns the new vertex count.
+   */
+  size_t generateNormals(const NormalSettings &);
+
+  /*
+   * Per-vertex tangent frames following MikkTSpace conventions: angle-weighted face tangents,
+   * orthogonalized against the normal, with the bitangent sign in `tangent.w`. Works on staged meshes.
+   */
+  void generateTangents(ThreadPool *pool = nullptr);
+
+  /*
+   * Renumbers vertices in the order the indices first use them, dropping unreferenced ones.
+   * Improves vertex fetch locality and cooked compression. Returns the new vertex count.
+   */
+  size_t optimizeVertexFetch();
+
+  /*
+   * Builds the LOD chain with quadric edge-collapse simplification.
+   * Simplified indices are appended after LOD 0, so every level is an index range
+   * into the same vertex buffer. Returns the number of levels (including LOD 0).
+   */
+  size_t generateLODs(const LODSettings &);
+
+  /*
+   * Picks the coarsest level whose projected error stays under `max_pixel_error`.
+   * `projection_scale` converts object-space size at distance 1 into pixels (see Camera::getProjectionScale).
+   */
+  static uint32_t selectLOD(std::span<const LOD>, float distance, float projection_scale, float max_pixel_error);
+
+  /*
+   * Partitions LOD 0 into meshlets. LOD 0 indices are reordered so every meshlet is contiguous.
+   * Returns the number of meshlets.
+   */
+  size_t buildMeshlets(size_t max_vertices = MESHLET_MAX_VERTICES, size_t max_triangles = MESHLET_MAX_TRIANGLES);
+
+  /*
+   * Moves heap vertices and indices into staging memory, if the allocator provides it.
+   * Staged buffers have a fixed size: LODs and meshlets have to be built before.
+   */
+  void stage(const StagingAllocator &);
 
-  static std::optional<Mesh> fromOBJ(File::Path);
+  /*
+   * Appends the index ranges of meshlets that survive frustum and backface-cone culling.
+   * Frustum and camera position are expected in the mesh's object space, adjacent ranges are merged.
+   * Returns the number of triangles emitted.
+   */
+  static size_t cullMeshlets(std::span<const Meshlet>, const Frustum &, glm::vec3 camera_position, std::vector<IndexRange> &);
+
+  /* SIMD min/max reduction over all vertices, or only over those the indices reference */
+  static Bounds computeBounds(std::span<const Vertex>);
+  static Bounds computeBounds(std::span<const Vertex>, std::span<const Index>);
 
 private:
   std::vector<Vertex> vertices;
   std::vector<Index> indices;
+  std::vector<LOD> lods;
+  std::vector<Meshlet> meshlets;
+  std::shared_ptr<Staging> staging; /* replaces `vertices` and `indices` when set */
+  Bounds bounds;                    /* of all vertices, encloses every LOD */
+
+  /* Sizes the vertex and index storage, in staging memory when the allocator provides it */
+  void allocate(size_t vertex_count, size_t index_count, const StagingAllocator &);
+
+  /* Recomputes the mesh bounds and those of every LOD */
+  void updateBounds();
+
+  friend class MeshManager; /* takes the buffers over on addMesh(Mesh &&) */
 };
 
 struct MeshInfo {
+  /* What happens to the CPU copy of the vertex and index data once it is on the GPU */
+  enum class Residency : uint8_t {
+    Release, /* freed, the mesh cannot be re-uploaded */
+    Keep,    /* kept in memory */
+    Mapped,  /* moved into a file mapping the OS can page out, re-read for re-uploads */
+  };
+
   std::vector<Mesh::Vertex> cpu_vertices;
   std::vector<Mesh::Index>  cpu_indices;
+  std::shared_ptr<Mesh::Staging> staging; /* imported straight into staging memory instead */
+  File::MappedFile          mapped_data;  /* Residency::Mapped: vertices followed by indices */
+  std::future<File::MappedFile> mapping;  /* Residency::Mapped: written in the background, see finishMappings */
+  std::vector<Mesh::LOD>    lods;
+  std::vector<Mesh::Meshlet> meshlets;
+  Mesh::Bounds bounds;                             /* of the whole mesh, per LOD bounds live in `lods` */
+  size_t vertex_count      = 0;
+  size_t index_count       = 0;
+  Mesh::Handle fallback    = Mesh::InvalidHandle; /* drawn instead until this mesh is first on the GPU */
+  Mesh::Handle alias       = Mesh::InvalidHandle; /* reservations: the mesh holding their data, referenced */
+  Mesh::Handle replaces    = Mesh::InvalidHandle; /* referenced until this mesh is on the GPU, its fallback until then */
+  Hash::Hash128 content_hash {};                   /* set for meshes shared through addMesh */
+  uint32_t ref_count       = 1;
+  uint32_t revision        = 0;                    /* bumped by update, tells asynchronous uploads of older data apart */
+  Residency residency      = Residency::Release;
   bool gpu_uploaded        = false;
+  bool reserved            = false;                /* created by reserve, holds no data itself */
   bool alive              = true;
 
+  MeshInfo() noexcept = default;
+  virtual ~MeshInfo() noexcept = default;
+
+  /* Bounds of one level, the whole mesh for levels it does not have */
+  inline const Mesh::Bounds &getBounds(uint32_t lod = 0) const {
+    return lod < lods.size() ? lods[lod].bounds : bounds;
+  }
+
+  inline size_t getSizeInBytes() const {
+    return vertex_count * sizeof(Mesh::Vertex) + index_count * sizeof(Mesh::Index);
+  }
+
+  inline bool hasCPUData() const {
+    return staging || mapped_data.isOpen() || (vertex_count > 0 && cpu_vertices.size() == vertex_count);
+  }
+
+  /* CPU copy from memory, staging or the mapping, empty once released */
+  inline std::span<const Mesh::Vertex> getVertices() const {
+    if (staging)
+      return staging->getVertices();
+    if (mapped_data.isOpen())
+      return { reinterpret_cast<const Mesh::Vertex *>(mapped_data.data()), vertex_count };
+    return cpu_vertices;
+  }
+
+  inline std::span<const Mesh::Index> getIndices() const {
+    if (staging)
+      return staging->getIndices();
+    if (mapped_data.isOpen())
+      return { reinterpret_cast<const Mesh::Index *>(mapped_data.data() + vertex_count * sizeof(Mesh::Vertex)), index_count };
+    return cpu_indices;
+  }
+
   struct OpenGL;
   struct Vulkan;
 };
@@ -48,21 +290,171 @@ struct MeshInfo {
 class MeshManager {
 protected:
   std::vector<std::unique_ptr<MeshInfo>> meshes;
+  std::unordered_map<Hash::Hash128, Mesh::Handle, Hash::Hash128Hasher> unique_meshes;
 
 public:
-  MeshManager() noexcept = default;
-  virtual ~MeshManager() noexcept = default;
+  struct Stats {
+    size_t mesh_count = 0;      /* live meshes */
+    size_t reference_count = 0; /* handles given out for them */
+    size_t resident_bytes = 0;  /* vertex + index data actually stored */
+    size_t saved_bytes = 0;     /* what storing every reference separately would have added */
+    size_t cpu_bytes = 0;       /* CPU copies still held in memory, see MeshInfo::Residency */
+  };
+
+  MeshManager() noexcept;
+  virtual ~MeshManager() noexcept;
 
   inline MeshInfo &get(Mesh::Handle handle) {
     assert(handle < meshes.size() && "handle >= meshes.size()");
     return *meshes.at(handle);
   }
 
-  virtual Mesh::Handle addMesh(Mesh &) = 0;
-  virtual void uploadPending() = 0;
+  /* The mesh holding the data of `handle`: itself, or the one an updated reservation shares */
+  inline Mesh::Handle getDataHandle(Mesh::Handle handle) {
+    MeshInfo &info = get(handle);
+    return info.alias != Mesh::InvalidHandle ? info.alias : handle;
+  }
+
+  /* Follows reservations to their data, then the fallback of meshes that have never been uploaded */
+  inline Mesh::Handle resolve(Mesh::Handle handle) {
+    handle = getDataHandle(handle);
+    MeshInfo &info = get(handle);
+    return info.fallback != Mesh::InvalidHandle ? info.fallback : handle;
+  }
+
+  inline uint32_t selectLOD(Mesh::Handle handle, float distance, float projection_scale, float max_pixel_error) {
+    return Mesh::selectLOD(get(handle).lods, distance, projection_scale, max_pixel_error);
+  }
+
+  /* The camera's side of LOD selection, see Mesh::selectLOD */
+  struct LODSelection {
+    glm::vec3 camera_position {};
+    float projection_scale = std::numeric_limits<float>::infinity(); /* until a camera is set, LOD 0 */
+    float max_pixel_error = 1.0f;
+  };
+
+  /* LOD of a mesh placed by `model`, its errors scaled like its bounding sphere */
+  uint32_t selectLOD(Mesh::Handle, const glm::mat4 &model, const LODSelection &);
+
+  /* Bounding sphere (center, radius) of `bounds` placed by `model`, conservative under non-uniform scaling */
+  static glm::vec4 getWorldSphere(const Mesh::Bounds &, const glm::mat4 &model);
+
+  /* see Mesh::cullMeshlets, meshes without meshlets emit their whole LOD 0 */
+  size_t cullMeshlets(Mesh::Handle, const Frustum &, glm::vec3 camera_position, std::vector<Mesh::IndexRange> &);
+
+  /*
+   * Meshes with identical contents share one MeshInfo: the existing handle is
+   * returned with its reference count raised. Every addMesh needs a matching release.
+   */
+  Mesh::Handle addMesh(Mesh &);
+
+  /* Same as above, but takes the mesh's buffers over instead of copying them */
+  Mesh::Handle addMesh(Mesh &&);
+
+  /* Drops one reference, the last one frees the mesh (its handle is not reused) */
+  void release(Mesh::Handle);
+
+  /* Residency of meshes added from now on, and of a single mesh */
+  inline void setResidency(MeshInfo::Residency residency) { default_residency = residency; }
+  inline void setResidency(Mesh::Handle handle, MeshInfo::Residency residency) {
+    get(getDataHandle(handle)).residency = residency;
+  }
+
+  /* Main thread, once per frame: swaps in the file mappings of Residency::Mapped meshes written since */
+  void finishMappings();
+
+  /* Uploads the mesh again from its CPU copy, false if that was released */
+  bool reupload(Mesh::Handle);
+
+  Stats getStats() const;
+
+  /*
+   * Allocator importers can decode into (see Mesh::Staging), callable from any thread.
+   * Meshes staged this way skip the host-side copy on upload. Empty when the backend has none.
+   */
+  virtual Mesh::StagingAllocator getStagingAllocator() { return nullptr; }
+
+  /* Creates an empty mesh that renders as `placeholder` until `update` provides its data */
+  Mesh::Handle reserve(Mesh::Handle placeholder);
+
+  /*
+   * Replaces the data behind `handle`, deduplicated like addMesh. The new data is uploaded by a
+   * following uploadPending, until then the mesh keeps rendering its previous GPU copy.
+   * Reservations keep their handle. Other meshes continue as the returned handle: a mesh with
+   * the same contents, or a new one when `handle` was shared and its other holders keep the old data.
+   */
+  Mesh::Handle update(Mesh::Handle, Mesh &);
+  Mesh::Handle update(Mesh::Handle, Mesh &&);
+
+  /*
+   * Uploads meshes that are not on the GPU yet, stopping once `byte_budget` is used up.
+   * At least one mesh is uploaded per call so large meshes cannot starve. Returns the bytes uploaded.
+   */
+  virtual size_t uploadPending(size_t byte_budget = std::numeric_limits<size_t>::max()) = 0;
+
+  /*
+   * Queues one draw of a level of `handle` for the next GraphicsAPI::flushDraws, of
+   * `instance_count` instances whose records start at `first_instance`, see GraphicsAPI::mapInstances.
+   * False when the mesh has nothing on the GPU yet, or the backend has no draw queue.
+   */
+  virtual bool queueDraw(Mesh::Handle, uint32_t /* lod */ = 0, uint32_t /* instance_count */ = 1,
+                         uint32_t /* first_instance */ = 0) { return false; }
+
+  /*
+   * Same for a single instance at LOD 0, split into the meshlets left by cullMeshlets.
+   * `frustum` and `camera_position` are in the mesh's object space. Meshes without
+   * meshlets are drawn whole.
+   */
+  virtual bool queueMeshletDraws(Mesh::Handle, const Frustum &, glm::vec3 /* camera_position */,
+                                 uint32_t /* first_instance */) { return false; }
+
+  /* Persistent instance of a mesh, see addInstance */
+  using InstanceHandle = uint32_t;
+  static constexpr InstanceHandle InvalidInstance = std::numeric_limits<InstanceHandle>::max();
+
+  /*
+   * Instances stay registered across frames, the backend culls and draws them without
+   * per-instance CPU work as long as neither the set nor their meshes change. Their
+   * InstanceData is indexed by handle. `group` is what drawInstances selects them by.
+   * InvalidInstance when the backend has no such path.
+   */
+  virtual InstanceHandle addInstance(Mesh::Handle, uint32_t /* group */, const Mesh::InstanceData &) {
+    return InvalidInstance;
+  }
+  virtual void removeInstance(InstanceHandle) {}
+
+  /* Hands instance changes and the camera over before the frame begins, instance levels follow the camera */
+  virtual void cullInstances(const Frustum &, const LODSelection &) {}
+
+  /* Draws the visible instances of `group` with the pipeline bound for it */
+  virtual bool drawInstances(uint32_t /* group */) { return false; }
 
   class OpenGL;
   class Vulkan;
+
+protected:
+  MeshInfo::Residency default_residency = MeshInfo::Residency::Release;
+
+  virtual std::unique_ptr<MeshInfo> createInfo() const = 0;
+
+  /* Called by backends once a mesh is on the GPU, applies its residency */
+  void markUploaded(MeshInfo &);
+
+  /* Drops the GPU copy of a mesh, backends must keep it alive for frames still in flight */
+  virtual void releaseGPU(MeshInfo &) = 0;
+
+private:
+  static void assignMeshData(MeshInfo &, Mesh &&);
+  Mesh::Handle acquireShared(const Hash::Hash128 &);
+  Mesh::Handle insertMesh(const Hash::Hash128 &, Mesh &&);
+  Mesh::Handle updateReserved(Mesh::Handle, Mesh &&);
+  void writeMapping(MeshInfo &);
+
+  /* meshes are never erased, the pointers stay valid */
+  std::vector<MeshInfo *> mapping_writes;
+
+  /* created on first use, destroyed before the meshes whose data its jobs read */
+  std::unique_ptr<ThreadPool> mapping_writer;
 };
 
 } /* namespace Engine */
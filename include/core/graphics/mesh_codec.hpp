@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Engine {
+
+/*
+ * Lossless vertex and index buffer compression for cooked meshes, in the spirit of meshoptimizer's codecs.
+ * Vertices: per-byte deltas between consecutive vertices, zigzag coded and bit-packed in groups of 16.
+ * Indices: triangles coded against a FIFO of recently seen edges and vertices, one or two bytes each.
+ * Both compress best when vertices are ordered by first use, which the importers already do.
+ */
+namespace MeshCodec {
+
+static constexpr size_t MAX_VERTEX_SIZE = 256;
+
+/* `vertex_size` has to be a multiple of 4 and at most MAX_VERTEX_SIZE */
+std::vector<uint8_t> encodeVertices(const void *vertices, size_t vertex_count, size_t vertex_size);
+bool decodeVertices(void *vertices, size_t vertex_count, size_t vertex_size, std::span<const uint8_t> encoded);
+
+/*
+ * `indices` is a triangle list. Decoding returns the same triangles in the same order, though
+ * a triangle's vertices may come back rotated (b, c, a), which keeps its winding.
+ */
+std::vector<uint8_t> encodeIndices(std::span<const uint32_t> indices);
+bool decodeIndices(std::span<uint32_t> indices, std::span<const uint8_t> encoded);
+
+/* Most elements a stream of `encoded_size` bytes can decode to, bounds counts read from a file before allocating */
+size_t maxVertexCount(size_t encoded_size, size_t vertex_size);
+size_t maxIndexCount(size_t encoded_size);
+
+} /* namespace MeshCodec */
+
+} /* namespace Engine */
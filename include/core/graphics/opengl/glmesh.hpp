@@ -16,16 +16,24 @@ class MeshManager::OpenGL final : public MeshManager {
 public:
   OpenGL() noexcept = default;
   ~OpenGL() noexcept {
-    for (std::unique_ptr<MeshInfo> &mesh_data : meshes) {
-      auto gl_mesh_data = static_cast<MeshInfo::OpenGL *>(mesh_data.get());
-      glDeleteBuffers(1, &gl_mesh_data->vbo);
-      glDeleteBuffers(1, &gl_mesh_data->ibo);
-      glDeleteVertexArrays(1, &gl_mesh_data->vao);
-    }
+    for (std::unique_ptr<MeshInfo> &mesh_data : meshes)
+      releaseGPU(*mesh_data);
   };
 
-  Mesh::Handle addMesh(Mesh &) override;
-  void uploadPending() override;
+  size_t uploadPending(size_t) override;
+
+protected:
+  std::unique_ptr<MeshInfo> createInfo() const override {
+    return std::make_unique<MeshInfo::OpenGL>();
+  }
+
+  void releaseGPU(MeshInfo &mesh_data) override {
+    auto &gl_mesh_data = static_cast<MeshInfo::OpenGL &>(mesh_data);
+    glDeleteBuffers(1, &gl_mesh_data.vbo);
+    glDeleteBuffers(1, &gl_mesh_data.ibo);
+    glDeleteVertexArrays(1, &gl_mesh_data.vao);
+    gl_mesh_data.vbo = gl_mesh_data.ibo = gl_mesh_data.vao = 0;
+  }
 };
 
 }; /* namespace Engine */
\ No newline at end of file
@@ -22,6 +22,9 @@ public:
   ~OpenGL() noexcept override;
 
   bool create(ShaderStages) override;
+  bool reload() override;
+  inline const ShaderStages &getStages() const override { return stages; }
+
   void bind(uint32_t) override;
 
 private:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <vector>
 
 #include <core/platform/window.hpp>
 #include <core/graphics/graphics_api.hpp>
@@ -19,12 +20,17 @@ struct GraphicsAPI::OpenGL final : public GraphicsAPI {
   void enableVsync() override;
   bool beginFrame() override;
   bool endFrame(Window *) override;
+  void resize(uint32_t, uint32_t) override;
   bool drawIndexed(DrawInfo &) override;
+  bool flushDraws() override;
+  std::span<Mesh::InstanceData> mapInstances(uint32_t) override;
   bool updateUBO(UniformBufferType, const void *, size_t, size_t) override;
   void setClearColor(glm::vec3 rgb, float a) override {
     glClearColor(rgb.r, rgb.g, rgb.b, a);
   };
 
+private:
+  std::vector<Mesh::InstanceData> instances;
 };
 
 } /* namespace Engine */
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <limits>
 #include <cstdint>
+#include <unordered_map>
 
 #include <core/config.hpp>
 #include <core/graphics/mesh.hpp>
@@ -12,6 +14,7 @@
 namespace Engine {
 
 class Window;
+class Camera;
 
 /**
  * @class Renderer
@@ -22,33 +25,136 @@ class Renderer {
   std::unique_ptr<MeshManager> mesh_manager;
   std::vector<std::unique_ptr<Pipeline>> pipelines;
   std::unique_ptr<UniformBufferManager> ub_manager;
+  size_t upload_budget = 0;
+
+  struct QueuedDraw {
+    Mesh::Handle mesh;
+    uint32_t lod;
+    Mesh::InstanceData instance;
+  };
+
+  /* Draws of one mesh level with one pipeline, issued as a single instanced draw */
+  struct InstanceGroup {
+    Mesh::Handle mesh;
+    uint32_t lod;
+    uint32_t draw;   /* first of its QueuedDraws */
+    uint32_t first;  /* first record in the frame's instance data */
+    uint32_t count;
+  };
+
+  /* per pipeline, issued as one indirect batch each by endFrame */
+  std::vector<std::vector<QueuedDraw>> draws;
+  uint32_t bound_pipeline = 0;
+
+  /* reused every frame, (mesh, lod) to its index in `groups` */
+  std::unordered_map<uint64_t, uint32_t> group_indices;
+  std::vector<InstanceGroup> groups;
+
+  /* pipeline of every instance handle, and how many instances each pipeline has */
+  std::vector<uint32_t> instance_pipelines;
+  std::vector<uint32_t> instance_counts;
+
+  /* camera of the frame, see setCamera */
+  Frustum frustum {};
+  glm::mat4 proj_view { 1.0f };
+  glm::vec3 camera_position {};
+  MeshManager::LODSelection lod_selection {};
+
+  /* beginFrame could start a frame, endFrame has something to submit */
+  bool frame_active = false;
 
 protected:
   Engine::Window *window = nullptr; /**< Associated window pointer */
 
 public:
+  /** Level of detail picked from the camera, see setCamera */
+  static constexpr uint32_t AutoLOD = std::numeric_limits<uint32_t>::max();
+
   explicit Renderer(Engine::Window *_window) noexcept : window(_window) {}
   ~Renderer() = default;
 
   /** Initialize renderer with configuration */
   bool init(Config::Renderer &);
 
-  /** Called at the start of each frame */
+  /** Called at the start of each frame, false when the frame is skipped (e.g. minimized window) */
   bool beginFrame();
 
-  /** Called at the end of each frame */
+  /** Called at the end of each frame, draws queued during a skipped frame are dropped */
   bool endFrame();
 
-  bool render(Mesh::Handle);
+  /** The window's framebuffer changed size */
+  void resize(uint32_t width, uint32_t height);
+
+  /** Queue a draw of one level of a mesh with the bound pipeline, recorded at endFrame */
+  bool render(Mesh::Handle, uint32_t lod = AutoLOD);
 
-  /** Bind a shader by ID */
+  /**
+   * Same, placed by `transform`. Draws of the same mesh level with the same pipeline are
+   * issued as one instanced draw, the material index is the bound pipeline's.
+   */
+  bool render(Mesh::Handle, const glm::mat4 &transform, uint32_t lod = AutoLOD);
+
+  /** Bind a shader by ID for the draws that follow */
   bool bindPipeline(uint32_t);
 
-  /** Add a mesh to the renderer and return its handle */
+  /** Register a mesh drawn with `pipeline` every frame until removed, culled on the GPU when the backend can */
+  MeshManager::InstanceHandle addInstance(Mesh::Handle, uint32_t pipeline, const glm::mat4 &transform = glm::mat4(1.0f));
+
+  /** Stop drawing an instance returned by addInstance */
+  void removeInstance(MeshManager::InstanceHandle);
+
+  /**
+   * Camera of the frame, set before beginFrame. Instances are culled against it, and
+   * single draws at LOD 0 per meshlet. Draws without an explicit LOD and instances get
+   * their level from it.
+   */
+  void setCamera(const Camera &);
+
+  /** Rebuild every pipeline that uses the given shader file, returns how many were rebuilt */
+  size_t reloadShader(const File::Path &);
+
+  /** Pick the LOD of a mesh placed at `position` for the given camera, see AutoLOD */
+  uint32_t selectLOD(Mesh::Handle, const Camera &, glm::vec3 position) const;
+
+  /** Add a mesh to the renderer and return its handle, identical meshes share one */
   __forceinline Mesh::Handle addMesh(Mesh &mesh) const {
     return mesh_manager->addMesh(mesh);
   }
 
+  /** Add a mesh, taking its buffers over instead of copying them */
+  __forceinline Mesh::Handle addMesh(Mesh &&mesh) const {
+    return mesh_manager->addMesh(std::move(mesh));
+  }
+
+  /** Drop a reference taken by addMesh or reserveMesh */
+  __forceinline void releaseMesh(Mesh::Handle handle) const {
+    mesh_manager->release(handle);
+  }
+
+  /** Staging memory importers can decode into, see Mesh::Staging */
+  __forceinline Mesh::StagingAllocator getStagingAllocator() const {
+    return mesh_manager->getStagingAllocator();
+  }
+
+  /** Mesh memory and deduplication statistics */
+  __forceinline MeshManager::Stats getMeshStats() const {
+    return mesh_manager->getStats();
+  }
+
+  /** Reserve a mesh handle that renders as `placeholder` until updateMesh provides its data */
+  __forceinline Mesh::Handle reserveMesh(Mesh::Handle placeholder) const {
+    return mesh_manager->reserve(placeholder);
+  }
+
+  /** Replace the data behind a mesh handle, uploaded at the start of a following frame. Returns the handle to use from now on */
+  __forceinline Mesh::Handle updateMesh(Mesh::Handle handle, Mesh &mesh) const {
+    return mesh_manager->update(handle, mesh);
+  }
+
+  __forceinline Mesh::Handle updateMesh(Mesh::Handle handle, Mesh &&mesh) const {
+    return mesh_manager->update(handle, std::move(mesh));
+  }
+
   /**
    * @brief Update a uniform buffer object
    * @tparam T Type of the UBO
@@ -59,7 +165,8 @@ public:
    */
   template <typename T>
   __forceinline bool updateUniformBuffer(UniformBufferType type, const T &ubo, size_t offset_in_bytes = 0) const {
-    return graphics_api->updateUBO(type, &ubo, sizeof(T), offset_in_bytes);
+    /* every frame in flight has its own copy, the one of the frame being recorded is no longer read */
+    return ub_manager->update(type, graphics_api->getCurrentFrameIndex(), &ubo, sizeof(T), offset_in_bytes);
   }
 
 private:
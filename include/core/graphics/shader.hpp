@@ -40,6 +40,21 @@ public:
   virtual bool create(ShaderStages) = 0;
   virtual void bind(uint32_t) = 0;
 
+  /* Rebuilds from the current stage files, the previous pipeline is kept if that fails */
+  virtual bool reload() = 0;
+  virtual const ShaderStages &getStages() const = 0;
+
+  /* Virtual paths compare by name, paths on disk by the file they point to */
+  inline bool usesShader(const File::Path &path) const {
+    const ShaderStages &current = getStages();
+    std::error_code error;
+    for (const File::Path *stage : { &current.vertex, &current.fragment, &current.geometry, &current.compute })
+      if (!stage->empty() && (stage->lexically_normal() == path.lexically_normal() ||
+                              std::filesystem::equivalent(*stage, path, error)))
+        return true;
+    return false;
+  }
+
   class OpenGL;
   class Vulkan;
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * Device memory sub-allocator.
+ * Memory is taken from the driver in large blocks per memory type and handed out
+ * in aligned ranges, each block managed as a two-level segregated fit (TLSF) heap:
+ * allocation and release are O(1) and free neighbours merge right away.
+ * Linear resources (buffers) and optimal-tiling images never share a block, so
+ * bufferImageGranularity never has to be padded for.
+ * Resources the driver wants on their own, or too large to pack sensibly, get a
+ * dedicated allocation. Safe to call from any thread.
+ */
+struct GraphicsAPI::Vulkan::MemoryAllocator {
+  /* Bytes per block, smaller on heaps that could not hold many of them */
+  static constexpr VkDeviceSize BLOCK_SIZE = 64ull * 1024 * 1024;
+
+  /* Per memory heap, see getStatistics() */
+  struct Statistics {
+    VkDeviceSize heap_size = 0;
+    VkDeviceSize reserved = 0;    /* taken from the driver, blocks and dedicated allocations */
+    VkDeviceSize used = 0;        /* handed out, alignment padding included */
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+    uint32_t dedicated_count = 0;
+  };
+
+  MemoryAllocator() noexcept;
+  ~MemoryAllocator() noexcept;
+
+  bool init(DeviceManager *);
+
+  /*
+   * Picks a memory type with every `required` flag, and every `preferred` one when
+   * such a type exists. Host-visible memory comes back persistently mapped.
+   */
+  bool allocate(const VkMemoryRequirements &, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+                bool linear, bool dedicated, Allocation &);
+  void free(Allocation &);
+
+  /* Creates `buffer` and binds it to a fresh allocation */
+  bool createBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+                    VkBuffer &, Allocation &);
+  void destroyBuffer(VkBuffer &, Allocation &);
+
+  std::vector<Statistics> getStatistics() const;
+  void logStatistics() const;
+
+private:
+  struct Block;
+
+  VkDevice device = VK_NULL_HANDLE;
+  VkPhysicalDeviceMemoryProperties memory_properties {};
+  uint32_t max_allocations = 0; /* maxMemoryAllocationCount */
+  uint32_t driver_allocations = 0;
+
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<Block>> blocks; /* nullptr slots are reused */
+  std::vector<VkDeviceSize> dedicated_bytes;  /* per heap */
+  std::vector<uint32_t> dedicated_counts;     /* per heap */
+
+  uint32_t findMemoryType(uint32_t type_bits, VkMemoryPropertyFlags) const;
+  VkDeviceSize getBlockSize(uint32_t memory_type) const;
+  bool allocateMemory(uint32_t memory_type, VkDeviceSize, const void *next, VkDeviceMemory &, void *&mapped);
+  bool allocateFromBlocks(uint32_t memory_type, const VkMemoryRequirements &, bool linear, Allocation &);
+  bool allocateDedicated(uint32_t memory_type, const VkMemoryRequirements &, VkBuffer, Allocation &);
+  bool allocate(const VkMemoryRequirements &, VkMemoryPropertyFlags, VkMemoryPropertyFlags, bool, bool, VkBuffer, Allocation &);
+};
+
+} /* namespace Engine */
@@ -8,9 +8,9 @@
 namespace Engine {
 struct BufferFrame {
   size_t size = 0;
-  void *mapped = nullptr;
+  void *mapped = nullptr; /* into the allocation, which stays mapped */
   VkBuffer buffer = VK_NULL_HANDLE;
-  VkDeviceMemory memory = VK_NULL_HANDLE;
+  GraphicsAPI::Vulkan::Allocation allocation {};
 };
 
 struct UniformBuffer {
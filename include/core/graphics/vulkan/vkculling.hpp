@@ -0,0 +1,149 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <util/file_utils.hpp>
+#include <core/graphics/camera/frustum.hpp>
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * GPU-driven drawing of a persistent instance set.
+ * Instances live in a device-local buffer that is only rewritten when the set changes,
+ * along with the LOD ranges of their meshes. Every frame a compute pass (shaders/cull.comp)
+ * tests them against the camera frustum, picks their level from the camera distance
+ * and writes the indirect commands of the visible ones, packed per batch of instances
+ * sharing a group and geometry pages, along with a draw count per batch consumed by
+ * vkCmdDrawIndexedIndirectCount. Without drawIndirectCount every instance keeps its
+ * slot and culled ones get an instance count of 0. The CPU cost of a frame is one
+ * dispatch plus one indirect call per batch, whatever the number of instances.
+ * Render thread only.
+ */
+struct GraphicsAPI::Vulkan::GpuCulling {
+  static constexpr uint32_t WORKGROUP_SIZE = 64; /* local_size_x of cull.comp */
+
+  /* std430 layout of cull.comp's LOD, the levels of a mesh are consecutive and start with LOD 0 */
+  struct LOD {
+    uint32_t first_index = 0;
+    uint32_t index_count = 0;
+    float error = 0.0f;    /* Mesh::LOD::error */
+    uint32_t padding = 0;
+  };
+
+  struct Instance {
+    glm::vec4 sphere {};   /* bounding sphere: center, radius */
+    uint32_t id = 0;       /* firstInstance of its draw */
+    uint32_t group = 0;    /* drawn by draw(group) */
+    VkBuffer vertex_buffer = VK_NULL_HANDLE;
+    VkBuffer index_buffer  = VK_NULL_HANDLE;
+    int32_t vertex_offset  = 0;
+    uint32_t first_lod     = 0; /* into the levels passed to setInstances */
+    uint32_t lod_count     = 1;
+    float lod_scale        = 1.0f; /* world over object size, the errors are in object space */
+  };
+
+  GpuCulling() noexcept = default;
+  ~GpuCulling() noexcept;
+
+  /* False leaves the pass disabled, callers keep drawing through IndirectDraws */
+  bool init(Vulkan *, const File::Path &shader);
+
+  inline bool isEnabled() const { return pipeline != VK_NULL_HANDLE; }
+
+  /* Replaces the instance set and their levels, uploaded through the staging ring before the next frame culls it */
+  bool setInstances(std::span<const Instance>, std::span<const LOD>);
+
+  inline void setFrustum(const Frustum &_frustum) { frustum = _frustum; }
+
+  /* Levels are picked like Mesh::selectLOD */
+  inline void setLODSelection(glm::vec3 camera_position, float projection_scale, float max_pixel_error) {
+    camera = glm::vec4(camera_position, projection_scale / max_pixel_error);
+  }
+
+  /* Records the culling pass into the frame's command buffer, outside of the render pass and before any draw */
+  void record(VkCommandBuffer, uint32_t frame_index);
+
+  /* Draws the visible instances of `group` with the pipeline bound in `command_buffer` */
+  void draw(VkCommandBuffer, uint32_t group);
+
+  inline uint32_t getInstanceCount() const { return instance_count; }
+  inline uint32_t getBatchCount() const { return static_cast<uint32_t>(batches.size()); }
+
+private:
+  /* std430 layout of cull.comp's Instance */
+  struct GpuInstance {
+    glm::vec4 sphere;
+    uint32_t first_lod;
+    uint32_t lod_count;
+    int32_t vertex_offset;
+    uint32_t batch;
+    uint32_t id;
+    float lod_scale;
+    uint32_t padding[2];
+  };
+
+  /* the 128 bytes every device supports */
+  struct PushConstants {
+    std::array<glm::vec4, 6> planes;
+    uint32_t instance_count;
+    uint32_t compact;
+    uint32_t padding[2];
+    glm::vec4 camera; /* position, projection scale over the allowed pixel error */
+  };
+
+  /* Consecutive instances of one group drawn from the same geometry pages */
+  struct Batch {
+    uint32_t group = 0;
+    VkBuffer vertex_buffer = VK_NULL_HANDLE;
+    VkBuffer index_buffer  = VK_NULL_HANDLE;
+    uint32_t first = 0; /* first instance, also its first command slot */
+    uint32_t count = 0;
+  };
+
+  struct Buffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    Allocation allocation {};
+    VkDeviceSize size = 0;
+  };
+
+  Vulkan *vulkan = nullptr;
+  VkDevice device = VK_NULL_HANDLE;
+  VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+  VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+
+  bool count_draws = false;      /* drawIndirectCount */
+  uint32_t max_draw_count = 1;   /* per indirect call, 1 without multiDrawIndirect */
+  VkDeviceSize storage_alignment = 1;
+
+  Buffer scene {};    /* GpuInstance records, then the first slot of every batch, then the levels */
+  Buffer commands {};
+  Buffer counts {};
+  VkDeviceSize batches_offset = 0;
+  VkDeviceSize lods_offset = 0;
+  uint32_t lod_count = 0;
+
+  std::vector<Batch> batches;
+  uint32_t instance_count = 0;
+  uint64_t version = 0; /* bumped whenever the buffers above are replaced */
+
+  std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> sets {};
+  std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> set_versions {};
+
+  Frustum frustum {};
+  glm::vec4 camera { 0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity() }; /* LOD 0 until a camera is set */
+
+  bool createPipeline(const File::Path &shader);
+  bool reserve(Buffer &, VkDeviceSize size, VkBufferUsageFlags);
+  void retire(Buffer &);
+};
+
+} /* namespace Engine */
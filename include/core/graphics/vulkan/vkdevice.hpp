@@ -1,8 +1,11 @@
 #pragma once
 
+#include <span>
 #include <optional>
 #include <cassert>
+#include <filesystem>
 
+#include <util/file_utils.hpp>
 #include <core/graphics/vulkan/vulkan.hpp>
 
 namespace Engine {
@@ -30,9 +33,32 @@ struct GraphicsAPI::Vulkan::DeviceManager {
     assert(present_queue != VK_NULL_HANDLE && "Present queue not initialized");
     return present_queue;
   }
+  inline VkQueue getTransferQueue() {
+    assert(transfer_queue != VK_NULL_HANDLE && "Transfer queue not initialized");
+    return transfer_queue;
+  }
 
   inline uint32_t getGraphicsQueueFamily() const { return graphics_queue_family.value(); }
   inline uint32_t getPresentQueueFamily()  const { return present_queue_family.value(); }
+  inline uint32_t getTransferQueueFamily() const { return transfer_queue_family.value(); }
+
+  /* Uploads run on a queue family of their own, buffers written there change owner before rendering uses them */
+  inline bool hasDedicatedTransferQueue() const { return transfer_queue_family != graphics_queue_family; }
+
+  /*
+   * Creates the pipeline cache shared by all pipeline creation, seeded from `path` when the
+   * file was written by the same vendor, device and driver. An empty path keeps it in memory.
+   * Returns false on failure.
+   */
+  bool createPipelineCache(const File::Path &path);
+
+  /* Writes the cache back to its file atomically, merged with what other runs wrote there since it was loaded */
+  bool savePipelineCache();
+
+  inline VkPipelineCache getPipelineCache() const { return pipeline_cache; }
+
+  /* Seeded from disk, pipeline creation mostly skips compiling */
+  inline bool isPipelineCacheWarm() const { return pipeline_cache_warm; }
 
   inline void waitIdle() const { vkDeviceWaitIdle(device); }
   inline VkResult waitForFences(const std::vector<VkFence> &fences) const {
@@ -54,12 +80,19 @@ private:
 
   VkQueue graphics_queue = VK_NULL_HANDLE;
   VkQueue present_queue  = VK_NULL_HANDLE;
+  VkQueue transfer_queue = VK_NULL_HANDLE;
 
   VkInstance instance     = VK_NULL_HANDLE;
   VkSurfaceKHR surface    = VK_NULL_HANDLE;
 
   std::optional<uint32_t> graphics_queue_family;
   std::optional<uint32_t> present_queue_family;
+  std::optional<uint32_t> transfer_queue_family; /* the graphics family when there is no dedicated one */
+
+  VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+  File::Path pipeline_cache_path {};
+  std::filesystem::file_time_type pipeline_cache_time {}; /* of the file when loaded, a later write was another run */
+  bool pipeline_cache_warm = false;
 
   /*
    * Selects the first suitable physical device.
@@ -74,7 +107,8 @@ private:
   bool createLogicalDevice();
 
   /*
-   * Finds queue families that support graphics and present operations.
+   * Finds queue families that support graphics and present operations,
+   * and the best transfer family: transfer-only (DMA engines) over compute, over graphics.
    * Returns true on success, false otherwise.
    */
   bool findQueueFamilies(VkPhysicalDevice) ;
@@ -91,6 +125,12 @@ private:
    */
   bool checkDeviceExtensionSupport(VkPhysicalDevice, std::span<const char*>) const;
 
+  /*
+   * Checks the header of serialized cache data against the physical device,
+   * drivers may crash on data written by another one.
+   */
+  bool isPipelineCacheCompatible(std::span<const char>) const;
+
 };
 
 } /* namespace Engine */
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include <core/graphics/mesh.hpp>
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * Shared vertex and index storage for every mesh.
+ * Each pool is a list of large device-local pages, meshes get ranges of them counted
+ * in elements, so draws address their geometry through vertexOffset and firstIndex
+ * and a frame only rebinds buffers when it moves to another page. Pools grow a page
+ * at a time, ranges larger than a page get a page of their own, and pages are released
+ * again once empty, through deferDestroy as other frames may still bind them. Freeing a
+ * range makes it reusable right away, callers defer it while frames in flight may still
+ * read it. Render thread only.
+ */
+struct GraphicsAPI::Vulkan::GeometryArena {
+  enum class Pool : uint8_t {
+    Vertex,
+    Index,
+  };
+
+  static constexpr uint32_t VERTEX_PAGE = 1u << 20; /* vertices, 60 MiB */
+  static constexpr uint32_t INDEX_PAGE  = 1u << 22; /* indices, 16 MiB */
+  static constexpr uint32_t NO_PAGE = std::numeric_limits<uint32_t>::max();
+
+  /* Elements [first, first + count) of one page */
+  struct Range {
+    uint32_t page  = NO_PAGE;
+    uint32_t first = 0;
+    uint32_t count = 0;
+
+    inline explicit operator bool() const noexcept { return page != NO_PAGE; }
+  };
+
+  struct Statistics {
+    uint32_t page_count = 0;
+    VkDeviceSize reserved = 0; /* bytes of every page */
+    VkDeviceSize used = 0;     /* bytes handed out */
+  };
+
+  GeometryArena() noexcept = default;
+  ~GeometryArena() noexcept;
+
+  bool init(Vulkan *);
+
+  bool allocate(Pool, uint32_t count, Range &);
+  void free(Pool, Range &);
+
+  inline VkBuffer getBuffer(Pool pool, const Range &range) const {
+    return pools[static_cast<size_t>(pool)].pages[range.page].buffer;
+  }
+
+  static inline VkDeviceSize getStride(Pool pool) {
+    return pool == Pool::Vertex ? sizeof(Mesh::Vertex) : sizeof(Mesh::Index);
+  }
+
+  /* Byte offset of the range in its page's buffer, for copies into it */
+  static inline VkDeviceSize getOffset(Pool pool, const Range &range) {
+    return range.first * getStride(pool);
+  }
+
+  Statistics getStatistics(Pool) const;
+
+private:
+  struct Page {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    Allocation allocation {};
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    std::map<uint32_t, uint32_t> free_ranges; /* first element to count, neighbours always merged */
+  };
+
+  struct PagePool {
+    std::vector<Page> pages; /* released pages keep their slot with a null buffer, ranges hold indices */
+    uint32_t page_size = 0;
+    VkDeviceSize stride = 0;
+    VkBufferUsageFlags usage = 0;
+  };
+
+  Vulkan *vulkan = nullptr;
+  MemoryAllocator *allocator = nullptr;
+  std::array<PagePool, 2> pools;
+
+  bool addPage(PagePool &, uint32_t capacity, uint32_t &index);
+  static bool allocateFrom(Page &, uint32_t count, uint32_t &first);
+};
+
+} /* namespace Engine */
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * Indirect draw stream of the frame being recorded.
+ * Draws are queued as VkDrawIndexedIndirectCommand records and written by flush()
+ * into a persistently mapped buffer per frame in flight, then issued with one
+ * vkCmdDrawIndexedIndirect per set of draws sharing geometry buffers. With the arena
+ * that is one call per pipeline, whatever the number of draws. Devices without
+ * multiDrawIndirect get one indirect call per draw out of the same buffer, devices
+ * without drawIndirectFirstInstance one direct call per draw.
+ * Render thread only.
+ */
+struct GraphicsAPI::Vulkan::IndirectDraws {
+  static constexpr uint32_t INITIAL_CAPACITY = 4096; /* draws per frame, grows on demand */
+
+  IndirectDraws() noexcept = default;
+  ~IndirectDraws() noexcept;
+
+  bool init(Vulkan *);
+
+  /* Starts a frame, its buffer is no longer read by the GPU once the frame's fence was waited on */
+  void begin(uint32_t frame_index);
+
+  void queue(const DrawInfo::Vulkan &);
+
+  /* Records everything queued since the last call into `command_buffer`, for the pipeline bound there */
+  bool flush(VkCommandBuffer);
+
+  inline uint32_t getDrawCount() const { return written; }
+
+private:
+  /* Draws sharing geometry buffers, in queue order */
+  struct Batch {
+    VkBuffer vertex_buffer = VK_NULL_HANDLE;
+    VkBuffer index_buffer  = VK_NULL_HANDLE;
+    std::vector<VkDrawIndexedIndirectCommand> commands;
+  };
+
+  struct FrameBuffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    Allocation allocation {};
+    uint32_t capacity = 0; /* draws */
+  };
+
+  Vulkan *vulkan = nullptr;
+  bool multi_draw = false;
+  bool first_instance = false; /* drawIndirectFirstInstance */
+  uint32_t max_draw_count = 1;
+
+  std::array<FrameBuffer, MAX_FRAMES_IN_FLIGHT> frames;
+  uint32_t frame = 0;
+  uint32_t written = 0; /* records in the frame's buffer so far */
+
+  std::vector<Batch> batches; /* queued, not flushed yet, kept around for their capacity */
+  uint32_t queued = 0;
+
+  bool reserve(FrameBuffer &, uint32_t draw_count);
+};
+
+} /* namespace Engine */
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstdint>
+
+#include <core/graphics/mesh.hpp>
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * Storage buffers of Mesh::InstanceData that graphics pipelines read at descriptor set SET.
+ * Every frame in flight has a persistently mapped buffer the renderer writes the records
+ * of its instanced draws into, and persistent instances have a device-local buffer that
+ * is only replaced when their set changes. Both are bound through the same set layout,
+ * so draws pick either by binding its set. Render thread only.
+ */
+struct GraphicsAPI::Vulkan::InstanceBuffer {
+  static constexpr uint32_t INITIAL_CAPACITY = 4096; /* records per frame, grows on demand */
+  static constexpr uint32_t SET = 1;                 /* set 0 is the camera */
+
+  InstanceBuffer() noexcept = default;
+  ~InstanceBuffer() noexcept;
+
+  bool init(Vulkan *);
+
+  inline VkDescriptorSetLayout getSetLayout() const { return set_layout; }
+
+  /* `count` records of the frame, the frame's fence must have been waited on and none of its pipelines bound yet */
+  std::span<Mesh::InstanceData> map(uint32_t frame_index, uint32_t count);
+
+  /* Binds the frame's records for `layout` and the pipelines compatible with it */
+  void bind(VkCommandBuffer, VkPipelineLayout, uint32_t frame_index);
+
+  /* Replaces the records of persistent instances, uploaded through the staging ring before the next frame */
+  bool setPersistent(std::span<const Mesh::InstanceData>);
+
+  /* Binds the persistent records in place of the frame's, for the layout last passed to bind() */
+  bool bindPersistent(VkCommandBuffer);
+
+private:
+  struct Buffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    Allocation allocation {};
+    uint32_t capacity = 0; /* records */
+  };
+
+  Vulkan *vulkan = nullptr;
+  VkDevice device = VK_NULL_HANDLE;
+  VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+  VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+
+  std::array<Buffer, MAX_FRAMES_IN_FLIGHT> frames;
+  std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> frame_sets {};
+
+  /* one set per frame in flight as well, a set cannot change while a frame still uses it */
+  Buffer persistent {};
+  uint64_t persistent_version = 0;
+  std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> persistent_sets {};
+  std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> persistent_set_versions {};
+
+  VkPipelineLayout bound_layout = VK_NULL_HANDLE;
+  uint32_t bound_frame = 0;
+
+  bool createFrameBuffer(uint32_t frame_index, uint32_t capacity);
+  void writeSet(VkDescriptorSet, VkBuffer, uint32_t capacity);
+};
+
+} /* namespace Engine */
@@ -1,17 +1,31 @@
 #pragma once
 
 #include <cassert>
+#include <optional>
 #include <core/graphics/mesh.hpp>
 #include <core/graphics/vulkan/vulkan.hpp>
+#include <core/graphics/vulkan/vkgeometry.hpp>
 
 namespace Engine {
 
 struct MeshInfo::Vulkan final : public MeshInfo {
-  VkBuffer vertex_buffer   = VK_NULL_HANDLE;
-  VkBuffer index_buffer    = VK_NULL_HANDLE;
+  using Range = GraphicsAPI::Vulkan::GeometryArena::Range;
 
-  VkDeviceMemory vertex_memory   = VK_NULL_HANDLE;
-  VkDeviceMemory index_memory   = VK_NULL_HANDLE;
+  /* ranges of the geometry arena, vertex indices are relative to the mesh's first vertex */
+  Range vertices {};
+  Range indices {};
+
+  /* Ranges still being written by the staging ring, swapped in once its batch completes */
+  struct Upload {
+    Range vertices {};
+    Range indices {};
+    uint32_t revision = 0;
+  };
+  std::unique_ptr<Upload> upload;
+  std::optional<uint32_t> failed_revision; /* not retried until updated again */
+
+  inline int32_t getVertexOffset() const { return static_cast<int32_t>(vertices.first); }
+  inline uint32_t getFirstIndex() const { return indices.first; }
 };
 
 class MeshManager::Vulkan final : public MeshManager {
@@ -21,9 +35,79 @@ public:
   explicit Vulkan(GraphicsAPI::Vulkan *_vulkan) noexcept : vulkan(_vulkan) {}
   ~Vulkan() noexcept;
 
-  Mesh::Handle addMesh(Mesh &) override;
-  void uploadPending() override;
+  size_t uploadPending(size_t) override;
+  bool queueDraw(Mesh::Handle, uint32_t, uint32_t, uint32_t) override;
+  bool queueMeshletDraws(Mesh::Handle, const Frustum &, glm::vec3, uint32_t) override;
+  Mesh::StagingAllocator getStagingAllocator() override;
+
+  InstanceHandle addInstance(Mesh::Handle, uint32_t, const Mesh::InstanceData &) override;
+  void removeInstance(InstanceHandle) override;
+  void cullInstances(const Frustum &, const LODSelection &) override;
+  bool drawInstances(uint32_t) override;
+
+  class Staging;
+
+protected:
+  std::unique_ptr<MeshInfo> createInfo() const override;
+  void releaseGPU(MeshInfo &) override;
+
+private:
+  struct InstanceSlot {
+    Mesh::Handle mesh = Mesh::InvalidHandle; /* invalid once removed, the slot is reused */
+    uint32_t group = 0;
+    uint32_t lod = 0; /* picked by cullInstances when there is no culling pass */
+    Mesh::InstanceData data {};
+  };
+
+  std::vector<InstanceSlot> instances;
+  std::vector<InstanceHandle> free_instances;
+  bool instances_changed = false; /* the records of persistent instances have to be uploaded again */
+  uint64_t geometry_version = 0; /* bumped whenever the ranges of a mesh change */
+  uint64_t culled_version = 0;   /* geometry_version the GPU instance set was built at */
+  Frustum frustum {};            /* for the CPU fallback without GPU culling */
+  std::vector<Mesh::IndexRange> meshlet_ranges; /* reused by queueMeshletDraws */
+
+  bool getDraw(const MeshInfo::Vulkan &, uint32_t lod, DrawInfo::Vulkan &) const;
+  static void freeRanges(GraphicsAPI::Vulkan *, MeshInfo::Vulkan::Range &vertices, MeshInfo::Vulkan::Range &indices);
+  /* Frees the ranges once the frames in flight, and the acquire barriers of their upload, are done with them */
+  void retireRanges(const MeshInfo::Vulkan::Range &vertices, const MeshInfo::Vulkan::Range &indices);
+  bool allocateRanges(MeshInfo::Vulkan::Upload &, size_t vertex_count, size_t index_count);
+  bool uploadStaged(const std::shared_ptr<Staging> &, MeshInfo::Vulkan::Upload &);
+  bool uploadHost(const MeshInfo &, MeshInfo::Vulkan::Upload &);
+  void completeUpload(MeshInfo::Vulkan &, bool completed);
+
+};
+
+/* Persistently mapped staging buffer importers write into, copied to the GPU without a host-side copy */
+class MeshManager::Vulkan::Staging final : public Mesh::Staging {
+  GraphicsAPI::Vulkan *vulkan = nullptr;
+  VkBuffer buffer = VK_NULL_HANDLE;
+  GraphicsAPI::Vulkan::Allocation allocation {};
+  size_t vertex_count = 0;
+  size_t index_count = 0;
+
+  friend class MeshManager::Vulkan;
+
+public:
+  Staging(GraphicsAPI::Vulkan *_vulkan, size_t _vertex_count, size_t _index_count) noexcept :
+    vulkan(_vulkan), vertex_count(_vertex_count), index_count(_index_count) {}
+
+  /* the staging ring holds a reference until the copy out of this buffer has completed */
+  ~Staging() noexcept override {
+    if (buffer || allocation)
+      vulkan->destroyBuffer(buffer, allocation);
+  }
+
+  inline size_t getVertexBytes() const { return vertex_count * sizeof(Mesh::Vertex); }
+  inline size_t getIndexBytes() const { return index_count * sizeof(Mesh::Index); }
+
+  std::span<Mesh::Vertex> getVertices() override {
+    return { static_cast<Mesh::Vertex *>(allocation.mapped), vertex_count };
+  }
 
+  std::span<Mesh::Index> getIndices() override {
+    return { reinterpret_cast<Mesh::Index *>(static_cast<char *>(allocation.mapped) + getVertexBytes()), index_count };
+  }
 };
 
 
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <filesystem>
+#include <type_traits>
+#include <unordered_map>
+
+#include <util/hash.hpp>
+#include <util/file_utils.hpp>
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * Everything baked into a graphics pipeline, the key of PipelineStateCache.
+ * Viewport and scissor are dynamic state and not part of it. Compared and hashed
+ * as raw bytes: fields are laid out without padding and unused attributes stay zeroed.
+ */
+struct GraphicsAPI::Vulkan::PipelineState {
+  static constexpr uint32_t MAX_ATTRIBUTES = 8;
+
+  /* SPIR-V contents, zero for a stage without a shader */
+  Hash::Hash128 vertex_shader {};
+  Hash::Hash128 fragment_shader {};
+
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  VkRenderPass render_pass = VK_NULL_HANDLE;
+
+  /* vertex layout, a single interleaved binding */
+  uint32_t vertex_stride = 0;
+  uint32_t attribute_count = 0;
+  std::array<VkVertexInputAttributeDescription, MAX_ATTRIBUTES> attributes {};
+  VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+  /* raster */
+  VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
+  VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
+  VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+
+  /* blend, of the single color attachment */
+  VkBool32 blend_enable = VK_FALSE;
+  VkBlendFactor src_color_factor = VK_BLEND_FACTOR_ONE;
+  VkBlendFactor dst_color_factor = VK_BLEND_FACTOR_ZERO;
+  VkBlendOp color_op = VK_BLEND_OP_ADD;
+  VkBlendFactor src_alpha_factor = VK_BLEND_FACTOR_ONE;
+  VkBlendFactor dst_alpha_factor = VK_BLEND_FACTOR_ZERO;
+  VkBlendOp alpha_op = VK_BLEND_OP_ADD;
+  VkColorComponentFlags color_write_mask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+  /* depth */
+  VkBool32 depth_test = VK_TRUE;
+  VkBool32 depth_write = VK_TRUE;
+  VkCompareOp depth_compare = VK_COMPARE_OP_LESS;
+
+  uint32_t padding = 0; /* rounds the size up to the alignment of the handles */
+
+  inline bool operator==(const PipelineState &other) const noexcept {
+    return std::memcmp(this, &other, sizeof(PipelineState)) == 0;
+  }
+
+  struct Hasher {
+    inline size_t operator()(const PipelineState &state) const noexcept {
+      return static_cast<size_t>(Hash::murmur3_128(&state, sizeof(PipelineState)).low);
+    }
+  };
+};
+
+static_assert(std::has_unique_object_representations_v<GraphicsAPI::Vulkan::PipelineState>,
+              "PipelineState is hashed as raw bytes, it must not contain padding");
+
+/*
+ * Graphics pipelines by PipelineState, so identical state combinations share one
+ * VkPipeline and requesting an existing one is a hash lookup. Shader modules only
+ * exist while a missing pipeline is compiled. Pipelines live as long as the cache:
+ * a shader reloaded back to an earlier version finds its pipeline again. Shader hashes
+ * are memoized per file, so a hit does not read the SPIR-V again.
+ * Render thread only.
+ */
+struct GraphicsAPI::Vulkan::PipelineStateCache {
+  /* A stage of a pipeline to build, only read on a miss */
+  struct Shader {
+    VkShaderStageFlagBits stage;
+    std::span<const char> code; /* SPIR-V */
+  };
+
+  PipelineStateCache() noexcept = default;
+  ~PipelineStateCache() noexcept;
+
+  bool init(Vulkan *);
+
+  /*
+   * The layout of every graphics pipeline: set 0 the camera, set 1 InstanceBuffer.
+   * Created on first use, once the camera's set layout exists. VK_NULL_HANDLE on failure.
+   */
+  VkPipelineLayout getLayout();
+
+  /* The pipeline of `state`, built from `shaders` on a miss. VK_NULL_HANDLE on failure */
+  VkPipeline get(const PipelineState &, std::span<const Shader> shaders);
+
+  /* The pipeline of `state` if it was built already, VK_NULL_HANDLE otherwise */
+  VkPipeline find(const PipelineState &) const;
+
+  /* Last write of the file holding a shader, loose or packed. Empty if it cannot be located */
+  static std::optional<std::filesystem::file_time_type> getWriteTime(const File::Path &);
+
+  /* The hash remembered for a shader file, false if there is none or the file was written since */
+  bool findShaderHash(const File::Path &, Hash::Hash128 &) const;
+
+  /* Remembers the hash of a shader file's contents, read after its last write at `write_time` */
+  void rememberShaderHash(const File::Path &, std::filesystem::file_time_type write_time, const Hash::Hash128 &);
+
+  inline size_t getPipelineCount() const { return pipelines.size(); }
+
+private:
+  Vulkan *vulkan = nullptr;
+  VkDevice device = VK_NULL_HANDLE;
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+
+  std::unordered_map<PipelineState, VkPipeline, PipelineState::Hasher> pipelines;
+
+  struct ShaderFile {
+    Hash::Hash128 hash {};
+    std::filesystem::file_time_type write_time {};
+  };
+
+  std::unordered_map<std::string, ShaderFile> shader_files; /* by path */
+
+  VkPipeline create(const PipelineState &, std::span<const Shader>);
+};
+
+} /* namespace Engine */
@@ -1,40 +1,50 @@
 #pragma once
 
 #include "vulkan/vulkan_core.h"
+#include <span>
 #include <vector>
 #include <cassert>
 
 #include <util/file_utils.hpp>
+#include <core/assets/vfs.hpp>
 #include <core/graphics/shader.hpp>
 #include <core/graphics/vulkan/vulkan.hpp>
 #include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkpipelines.hpp>
 
 namespace Engine {
 
+/*
+ * A set of shader stages over a fixed-function state, the VkPipeline itself
+ * belongs to the PipelineStateCache and is shared with identical states.
+ */
 class Pipeline::Vulkan : public Pipeline {
+  using State = GraphicsAPI::Vulkan::PipelineState;
+
   ShaderStages stages;
-  VkPipeline pipeline = nullptr;
-  VkPipelineLayout layout = nullptr;
-  std::vector<VkShaderModule> modules;
+  State state;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkPipelineLayout layout = VK_NULL_HANDLE;
   GraphicsAPI::Vulkan *vulkan = nullptr;
 
 public:
-  Vulkan(GraphicsAPI::Vulkan *_vulkan) noexcept : vulkan(_vulkan) {}
-  ~Vulkan() noexcept override;
-  
+  /* Raster, blend and depth state come from `_state`, shaders, vertex layout and render pass are filled by create() */
+  Vulkan(GraphicsAPI::Vulkan *_vulkan, const State &_state = {}) noexcept : state(_state), vulkan(_vulkan) {}
+  ~Vulkan() noexcept override = default;
+
   bool create(ShaderStages) override;
-  void bind(uint32_t frame_index) override {
-    VkCommandBuffer command_buffer = vulkan->getCommandBuffer(frame_index);
-    vkCmdBindPipeline(
-      command_buffer,
-      VK_PIPELINE_BIND_POINT_GRAPHICS,
-      pipeline
-    );
-  }
+  bool reload() override;
+  inline const ShaderStages &getStages() const override { return stages; }
+
+  /* Also binds the camera and the frame's instance records, every pipeline reads them */
+  void bind(uint32_t image_index) override;
 
 
 private:
-  VkShaderModule loadShader(File::Path);
+  bool loadShader(const File::Path &, File::Data &);
+
+  /* Also hashes the code and remembers the hash in the PipelineStateCache */
+  bool loadShader(const File::Path &, File::Data &, Hash::Hash128 &);
 };
 
 } /* namespace Engine */
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include <core/graphics/vulkan/vulkan.hpp>
+
+namespace Engine {
+
+/*
+ * Persistently mapped staging ring for buffer uploads.
+ * Uploads are copied into the ring and their transfers recorded into one command
+ * buffer, submitted as a single batch on the transfer queue by submit(). Every batch
+ * signals the next value of a timeline semaphore; ring space and the batch's command
+ * buffer are reclaimed once reclaim() sees that value reached, so the CPU only ever
+ * waits when the ring is full.
+ * With a dedicated transfer family, destination buffers are released to the graphics
+ * family at the end of their batch and acquired by a graphics command buffer through
+ * acquire(). Render thread only.
+ */
+struct GraphicsAPI::Vulkan::StagingRing {
+  static constexpr VkDeviceSize SIZE = 32ull * 1024 * 1024;
+  static constexpr VkDeviceSize ALIGNMENT = 16;
+
+  StagingRing() noexcept = default;
+  ~StagingRing() noexcept;
+
+  bool init(DeviceManager *, MemoryAllocator *);
+
+  /* Queues `size` bytes of `data` for `buffer` at `offset`, null `data` uploads zeroes */
+  bool upload(const void *data, VkDeviceSize size, VkBuffer buffer, VkDeviceSize offset = 0);
+
+  /* Queues a copy out of a caller-owned buffer, which must outlive the batch, see onComplete() */
+  bool copy(VkBuffer source, VkDeviceSize source_offset, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+
+  /* `completed` is false when the batch failed to submit, none of its copies ran then */
+  using Callback = std::function<void(bool completed)>;
+
+  /* Runs `callback` from reclaim() once every copy queued so far has completed on the GPU */
+  void onComplete(Callback callback);
+
+  /*
+   * Submits everything queued since the last call. A batch that fails keeps its ring space
+   * until the batches before it have retired, its callbacks see `completed` false.
+   */
+  bool submit();
+
+  /* Frees the space of every batch the GPU is done with and runs its callbacks, without waiting */
+  void reclaim();
+
+  /*
+   * Records into a graphics command buffer, outside of any render pass, the acquire
+   * side of the ownership transfers of every completed batch, and of submitted batches
+   * up to `required`. Returns the timeline value its submission has to wait for before
+   * vertex input, 0 when there is none.
+   */
+  uint64_t acquire(VkCommandBuffer, uint64_t required = 0);
+
+  /* Timeline value the batch currently being recorded will signal */
+  inline uint64_t getRecordingValue() const { return submitted_value + 1; }
+  inline VkSemaphore getTimeline() const { return timeline; }
+
+  inline VkDeviceSize getPendingBytes() const { return recording ? head - recording_start : 0; }
+
+  /* Stages the frame's timeline wait covers, what an acquired buffer can be read by */
+  static constexpr VkPipelineStageFlags CONSUMER_STAGES =
+    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+private:
+  struct Batch {
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    uint64_t value = 0; /* timeline value signalled on completion */
+    uint64_t end = 0;   /* ring head when submitted, everything before it is free once the batch completes */
+    bool failed = false; /* never reached the GPU, retires along with the batch submitted before it */
+    std::vector<VkBufferMemoryBarrier> releases;
+    std::vector<Callback> callbacks;
+  };
+
+  struct Acquire {
+    uint64_t value = 0;
+    VkBufferMemoryBarrier barrier {};
+  };
+
+  VkDevice device = VK_NULL_HANDLE;
+  VkQueue queue = VK_NULL_HANDLE;
+  uint32_t transfer_family = 0;
+  uint32_t graphics_family = 0;
+  bool transfer_ownership = false; /* dedicated transfer family */
+  MemoryAllocator *allocator = nullptr;
+  VkCommandPool command_pool = VK_NULL_HANDLE;
+  VkSemaphore timeline = VK_NULL_HANDLE;
+  uint64_t submitted_value = 0;
+
+  VkBuffer buffer = VK_NULL_HANDLE;
+  Allocation allocation {};
+
+  /* monotonic byte counters, positions in the ring modulo SIZE */
+  uint64_t head = 0;
+  uint64_t tail = 0;
+
+  Batch current {};
+  bool recording = false;
+  uint64_t recording_start = 0;
+
+  std::deque<Batch> in_flight;
+  std::vector<Batch> idle;
+  std::deque<Acquire> acquires; /* in submission order */
+
+  bool begin();
+  void record(VkBuffer source, VkDeviceSize source_offset, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+  bool reserve(VkDeviceSize, VkDeviceSize &offset);
+  bool wait(const Batch &);
+  void retire(Batch &);
+};
+
+} /* namespace Engine */
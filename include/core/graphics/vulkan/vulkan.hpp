@@ -4,8 +4,10 @@
 #include <span>
 #include <vector>
 #include <array>
+#include <deque>
 #include <memory>
 #include <cassert>
+#include <functional>
 
 #include <vulkan/vulkan.h>
 #include <core/graphics/graphics_api.hpp>
@@ -14,8 +16,10 @@ namespace Engine {
 class Window;
 
 struct DrawInfo::Vulkan : DrawInfo {
-  VkBuffer vertex_buffer   = VK_NULL_HANDLE;
+  VkBuffer vertex_buffer   = VK_NULL_HANDLE; /* geometry arena pages, only rebound when they change */
   VkBuffer index_buffer    = VK_NULL_HANDLE;
+  int32_t vertex_offset    = 0;
+  uint32_t first_index     = 0;
   VkCommandBuffer command_buffer = VK_NULL_HANDLE;
 };
 
@@ -30,6 +34,27 @@ struct GraphicsAPI::Vulkan final : public GraphicsAPI {
   struct DeviceManager;
   struct SurfaceManager;
   struct DescriptorManager;
+  struct MemoryAllocator;
+  struct StagingRing;
+  struct GeometryArena;
+  struct IndirectDraws;
+  struct GpuCulling;
+  struct InstanceBuffer;
+  struct PipelineState;
+  struct PipelineStateCache;
+
+  /* A range of device memory handed out by MemoryAllocator */
+  struct Allocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr; /* host-visible memory stays mapped for as long as it is allocated */
+    uint32_t memory_type = 0;
+    uint32_t block = 0;     /* owned by MemoryAllocator */
+    uint32_t region = 0;
+
+    inline explicit operator bool() const noexcept { return memory != VK_NULL_HANDLE; }
+  };
 
   Vulkan() noexcept;
   ~Vulkan() noexcept;
@@ -39,7 +64,10 @@ struct GraphicsAPI::Vulkan final : public GraphicsAPI {
   void enableVsync() override;
   bool beginFrame() override;
   bool endFrame(Window *) override;
+  void resize(uint32_t, uint32_t) override;
   bool drawIndexed(DrawInfo &) override;
+  bool flushDraws() override;
+  std::span<Mesh::InstanceData> mapInstances(uint32_t) override;
   bool updateUBO(UniformBufferType, const void *, size_t, size_t) override;
   void setClearColor(glm::vec3 rgb, float a) override {
     clear_color.color.float32[0] = rgb.r;
@@ -65,6 +93,34 @@ struct GraphicsAPI::Vulkan final : public GraphicsAPI {
     assert(descriptor_manager != nullptr && "DescriptorManager is not initialized");
     return *descriptor_manager;
   }
+  inline MemoryAllocator &getMemoryAllocator() {
+    assert(memory_allocator != nullptr && "MemoryAllocator is not initialized");
+    return *memory_allocator;
+  }
+  inline StagingRing &getStagingRing() {
+    assert(staging_ring != nullptr && "StagingRing is not initialized");
+    return *staging_ring;
+  }
+  inline GeometryArena &getGeometryArena() {
+    assert(geometry_arena != nullptr && "GeometryArena is not initialized");
+    return *geometry_arena;
+  }
+  inline IndirectDraws &getIndirectDraws() {
+    assert(indirect_draws != nullptr && "IndirectDraws is not initialized");
+    return *indirect_draws;
+  }
+  inline InstanceBuffer &getInstanceBuffer() {
+    assert(instance_buffer != nullptr && "InstanceBuffer is not initialized");
+    return *instance_buffer;
+  }
+  inline PipelineStateCache &getPipelineStateCache() {
+    assert(pipeline_states != nullptr && "PipelineStateCache is not initialized");
+    return *pipeline_states;
+  }
+  inline GpuCulling &getGpuCulling() {
+    assert(gpu_culling != nullptr && "GpuCulling is not initialized");
+    return *gpu_culling;
+  }
 
   /* === Vulkan Objects Access === */
   inline VkSwapchainKHR getSwapchain() const { return swapchain; }
@@ -81,12 +137,16 @@ struct GraphicsAPI::Vulkan final : public GraphicsAPI {
   /* === Command Buffer Utilities === */
   VkResult submitQueue(VkQueue, const std::vector<VkSubmitInfo> &, uint32_t);
 
+  /* Binds geometry buffers unless the current frame already has them bound */
+  void bindGeometry(VkCommandBuffer, VkBuffer vertex_buffer, VkBuffer index_buffer);
+
+  /* Device-local buffer filled with `data` (zeroes when null) through the staging ring, usable by the next frame */
   bool createBuffer(
     void *,
     uint32_t,
     VkBufferUsageFlags,
     VkBuffer &,
-    VkDeviceMemory &
+    Allocation &
   );
 
   bool createRawBuffer(
@@ -94,9 +154,31 @@ struct GraphicsAPI::Vulkan final : public GraphicsAPI {
     VkBufferUsageFlags,
     VkMemoryPropertyFlags,
     VkBuffer &,
-    VkDeviceMemory &
+    Allocation &
+  );
+
+  /* Host-visible transfer source that stays mapped through Allocation::mapped, prefers cached memory so it can be read back cheaply */
+  bool createStagingBuffer(
+    size_t,
+    VkBuffer &,
+    Allocation &
   );
 
+  /* Any buffer from the functions above */
+  void destroyBuffer(VkBuffer &, Allocation &);
+
+  /*
+   * Makes the next frame wait on the GPU for the staging ring batch signalling `value`,
+   * for buffers it cannot render without. Anything else is picked up once its batch is done.
+   */
+  void requireUpload(uint64_t value);
+
+  /*
+   * Runs `destroy` once every frame submitted so far has finished on the GPU,
+   * for resources replaced while frames in flight may still reference them.
+   */
+  void deferDestroy(std::function<void()> destroy);
+
   VkCommandBuffer beginSingleTimeCommands() const;
   bool endSingleTimeCommands(VkCommandBuffer) const;
   uint32_t findMemoryType(uint32_t, VkMemoryPropertyFlags) const;
@@ -111,15 +193,36 @@ private:
   bool createCommandBuffers();
   bool createSyncObjects();
 
+  /*
+   * Builds a swapchain for the current framebuffer size out of the old one, whose views,
+   * framebuffers and handle are retired through deferDestroy once the frames in flight
+   * that may use them are done. False while the window is minimized or on failure,
+   * the swapchain stays marked for recreation either way.
+   */
+  bool recreateSwapchain();
+
   VkSurfaceFormatKHR &chooseSwapSurfaceFormat(std::span<VkSurfaceFormatKHR>);
   VkPresentModeKHR choosePresentMode(std::span<VkPresentModeKHR>);
   VkExtent2D chooseSwapExtent(VkSurfaceCapabilitiesKHR&);
 
+  void collectDeferred(bool everything);
+
   /* === Vulkan Resource Managers === */
   std::unique_ptr<InstanceManager> instance_manager;
   std::unique_ptr<SurfaceManager> surface_manager;
   std::unique_ptr<DeviceManager> device_manager;
   std::unique_ptr<DescriptorManager> descriptor_manager;
+  std::unique_ptr<MemoryAllocator> memory_allocator; /* destroyed before the device */
+  std::unique_ptr<GeometryArena> geometry_arena;     /* destroyed before the allocator */
+  std::unique_ptr<StagingRing> staging_ring;         /* destroyed before the arena it copies into */
+  std::unique_ptr<IndirectDraws> indirect_draws;     /* destroyed before the allocator */
+  std::unique_ptr<InstanceBuffer> instance_buffer;   /* destroyed before the allocator */
+  std::unique_ptr<PipelineStateCache> pipeline_states;
+  std::unique_ptr<GpuCulling> gpu_culling;           /* initialised by the renderer, it needs a shader */
+  uint64_t required_upload = 0;   /* staging ring value the next frame must wait for */
+  uint64_t upload_wait_value = 0; /* staging ring value the current frame waits for, 0 for none */
+  VkBuffer bound_vertex_buffer = VK_NULL_HANDLE; /* in the current frame, see bindGeometry */
+  VkBuffer bound_index_buffer = VK_NULL_HANDLE;
 
   /* === Swapchain & Images === */
   VkSwapchainKHR swapchain = VK_NULL_HANDLE;
@@ -140,6 +243,18 @@ private:
   std::vector<VkFence> in_flight_images;
   VkClearValue clear_color {};
 
+  Window *window = nullptr;
+  bool swapchain_dirty = false; /* resized, or reported out of date or suboptimal */
+
+  /* === Deferred Destruction === */
+  struct DeferredDestroy {
+    uint64_t frame;
+    std::function<void()> destroy;
+  };
+
+  uint64_t submitted_frames = 0;
+  std::deque<DeferredDestroy> deferred_destroys;
+
 };
 
 } /* namespace Engine */
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <span>
+#include <mutex>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+#include <util/file_utils.hpp>
+#include <core/thread_pool.hpp>
+
+namespace Engine {
+
+/**
+ * @class AsyncIO
+ * @brief Batched asynchronous file reads, backed by io_uring on Linux.
+ *
+ * Reads are queued from any thread and run concurrently, up to the queue depth at
+ * a time. Callbacks and futures complete on the thread pool passed in. Without
+ * io_uring (other platforms, old kernels, sandboxes) every read is a positional
+ * read on that pool instead.
+ */
+class AsyncIO {
+public:
+  struct Result {
+    size_t bytes = 0; /* short of the requested size only at the end of the file */
+    int error = 0;    /* errno value, 0 on success */
+
+    inline bool ok() const noexcept { return error == 0; }
+  };
+
+  using Callback = std::function<void(Result)>;
+
+  struct Read {
+    File::Path path;
+    uint64_t offset = 0;
+    size_t size = 0;
+    void *destination = nullptr; /* at least `size` bytes, untouched by anyone else until the callback */
+    Callback callback;
+  };
+
+  explicit AsyncIO(ThreadPool &completions, uint32_t queue_depth = 256) noexcept;
+
+  /* Waits for every outstanding read and its callback to be queued */
+  ~AsyncIO() noexcept;
+
+  AsyncIO(const AsyncIO &) = delete;
+  AsyncIO &operator=(const AsyncIO &) = delete;
+
+  /* Falls back to pool reads when io_uring is unavailable, false only if neither works */
+  [[nodiscard]] bool init();
+
+  /* Each distinct path in a batch is opened once and shared by its reads */
+  void submit(std::span<Read>);
+  inline void submit(Read read) { submit(std::span<Read>{ &read, 1 }); }
+
+  std::future<Result> read(File::Path path, uint64_t offset, size_t size, void *destination);
+
+  inline bool isUsingIoUring() const noexcept { return ring != nullptr; }
+
+private:
+  struct Ring;
+  struct Handle;
+  struct Operation;
+
+  ThreadPool &completions;
+  uint32_t queue_depth;
+
+  std::unique_ptr<Ring> ring;
+  std::jthread reaper; /* io_uring completions, idle otherwise */
+
+  std::mutex mutex;
+  std::condition_variable idle;
+  std::deque<Operation *> backlog; /* waiting for a free submission slot */
+  size_t in_flight = 0;
+  size_t outstanding = 0;          /* in flight, in the backlog or on the pool */
+
+  void start(Operation *);
+  void finish(Operation *, Result);
+  void fill();                     /* moves the backlog into free ring slots, under `mutex` */
+  void reap(std::stop_token);
+  static void readBlocking(Operation &, Result &);
+};
+
+} /* namespace Engine */
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include <util/file_utils.hpp>
+
+namespace Engine {
+
+/**
+ * @class FileWatcher
+ * @brief Reports changes to individual files, backed by inotify on Linux.
+ *
+ * Directories are watched instead of the files themselves so editors that save
+ * through a rename are still picked up. Other platforms fall back to comparing
+ * modification times on every poll.
+ */
+class FileWatcher {
+public:
+  using Callback = std::function<void(const File::Path &)>;
+
+  FileWatcher() noexcept = default;
+  ~FileWatcher() noexcept;
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  [[nodiscard]] bool init();
+
+  /** Call `callback` on the polling thread whenever `path` is rewritten */
+  bool watch(const File::Path &path, Callback callback);
+
+  /** Non-blocking, fires each changed file's callbacks once no matter how many events it produced */
+  void poll();
+
+private:
+  struct Entry {
+    std::vector<Callback> callbacks;
+    File::Path path;
+    std::filesystem::file_time_type last_write {};
+  };
+
+  int fd = -1;
+  std::unordered_map<int, File::Path> directories; /* watch descriptor -> directory */
+  std::unordered_map<std::string, Entry> files;    /* keyed by the normalized absolute path */
+
+  static std::string makeKey(const File::Path &);
+};
+
+} /* namespace Engine */
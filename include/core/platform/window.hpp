@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <string_view>
+#include <functional>
+#include <utility>
 #include <chrono>
 
 #include <glfw/glfw3.h>
@@ -72,6 +74,15 @@ public:
     return glm::uvec2(static_cast<uint32_t>(w), static_cast<uint32_t>(h));
   }
 
+  /** Whether the framebuffer was resized since the last call, clears the flag */
+  [[nodiscard]] inline bool consumeResize() noexcept { return std::exchange(resized, false); }
+
+  /**
+   * @brief Set what redraws the window while the OS holds the event loop
+   * @param callback Called from pollEvents() during interactive resizes and moves, and on expose
+   */
+  inline void setRefreshCallback(std::function<void()> callback) noexcept { on_refresh = std::move(callback); }
+
   /** Set the window title */
   inline void setTitle(Title title) const noexcept {
     if (handle) glfwSetWindowTitle(handle, title.data());
@@ -128,6 +139,8 @@ private:
 
   InputManager input_manager;       /**< Input manager for keyboard/mouse */
   GLFWwindow *handle = nullptr;     /**< Native GLFW window handle */
+  bool resized = false;             /**< Set by the framebuffer size callback */
+  std::function<void()> on_refresh; /**< Set through setRefreshCallback */
   std::chrono::milliseconds tick_interval; /**< Tick interval for updates */
 };
 
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace Engine {
+
+/* Fixed-size pool of worker threads consuming a FIFO job queue */
+class ThreadPool {
+public:
+  using Job = std::function<void()>;
+
+  /* 0 threads means one per hardware thread, minus the main thread */
+  explicit ThreadPool(uint32_t thread_count = 0) {
+    if (thread_count == 0)
+      thread_count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    workers.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i)
+      workers.emplace_back([this](std::stop_token stop) { work(stop); });
+  }
+
+  /* Pending jobs are dropped, running jobs are finished */
+  ~ThreadPool() noexcept {
+    std::queue<Job> pending;
+    {
+      std::scoped_lock lock(mutex);
+      pending.swap(jobs);
+    }
+
+    for (std::jthread &worker : workers)
+      worker.request_stop();
+    condition.notify_all();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void enqueue(Job job) {
+    {
+      std::scoped_lock lock(mutex);
+      jobs.push(std::move(job));
+    }
+    condition.notify_one();
+  }
+
+  /*
+   * Runs `fn(begin, end)` over [0, count) in chunks of `grain` and returns once all chunks are done.
+   * The calling thread works on chunks too, so this is safe to call from inside a job of the same pool.
+   */
+  void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    if (count == 0)
+      return;
+
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunk_count = (count + grain - 1) / grain;
+    if (chunk_count == 1) {
+      fn(0, count);
+      return;
+    }
+
+    /* shared, helpers may only get to run after the caller has finished every chunk */
+    struct Range {
+      const std::function<void(size_t, size_t)> *fn;
+      size_t count, grain, chunk_count;
+      std::atomic<size_t> next { 0 };
+      std::atomic<size_t> done { 0 };
+    };
+
+    auto range = std::make_shared<Range>();
+    range->fn = &fn;
+    range->count = count;
+    range->grain = grain;
+    range->chunk_count = chunk_count;
+
+    auto run = [](Range &r) {
+      for (size_t chunk; (chunk = r.next.fetch_add(1)) < r.chunk_count;) {
+        const size_t begin = chunk * r.grain;
+        (*r.fn)(begin, std::min(begin + r.grain, r.count));
+        if (r.done.fetch_add(1) + 1 == r.chunk_count)
+          r.done.notify_all();
+      }
+    };
+
+    const size_t helpers = std::min<size_t>(chunk_count - 1, workers.size());
+    for (size_t i = 0; i < helpers; ++i)
+      enqueue([range, run] { run(*range); });
+
+    run(*range);
+
+    for (size_t done; (done = range->done.load()) < chunk_count;)
+      range->done.wait(done);
+  }
+
+  inline uint32_t getThreadCount() const noexcept { return static_cast<uint32_t>(workers.size()); }
+
+private:
+  std::mutex mutex;
+  std::condition_variable_any condition;
+  std::queue<Job> jobs;
+  std::vector<std::jthread> workers;
+
+  void work(std::stop_token stop) {
+    while (true) {
+      Job job;
+      {
+        std::unique_lock lock(mutex);
+        /* jobs queued by running ones during shutdown are dropped too */
+        if (!condition.wait(lock, stop, [this] { return !jobs.empty(); }) || stop.stop_requested())
+          return;
+
+        job = std::move(jobs.front());
+        jobs.pop();
+      }
+      job();
+    }
+  }
+};
+
+} /* namespace Engine */
@@ -6,8 +6,11 @@
 #include <core/config.hpp>
 #include <core/logging.hpp>
 #include <core/platform/window.hpp>
+#include <core/platform/file_watcher.hpp>
 #include <core/graphics/renderer.hpp>
 #include <core/graphics/camera/camera.hpp>
+#include <core/assets/vfs.hpp>
+#include <core/assets/asset_loader.hpp>
 
 namespace Engine {
 
@@ -19,19 +22,24 @@ struct Application;
  *
  * This class provides initialization and lifecycle management
  * of the engine runtime. It is responsible for:
+ * - Mounting the virtual file system assets are read through
  * - Creating and owning the main application window
  * - Managing the rendering backend
  * - Managing the active camera
+ * - Loading assets in the background
  * - Running the main loop
  */
 class Instance {
+  std::unique_ptr<File::VFS> vfs;   /**< Mounted asset sources, outlives everything reading through it */
   std::unique_ptr<Window> window;   /**< Main application window */
   std::unique_ptr<Renderer> renderer; /**< Rendering backend */
   std::unique_ptr<Camera> camera;   /**< Active camera */
+  std::unique_ptr<FileWatcher> file_watcher; /**< Hot reload source, only created when enabled */
+  std::unique_ptr<AssetLoader> asset_loader; /**< Background asset loading, destroyed before the renderer */
 
 public:
   Instance() = default;
-  ~Instance() = default;
+  ~Instance() noexcept;
 
   Instance(const Instance &) = delete;
   Instance &operator=(const Instance &) = delete;
@@ -54,6 +62,18 @@ public:
    */
   inline Camera &getCamera() { return *camera; }
 
+  /**
+   * @brief Access the virtual file system
+   * @return Reference to the virtual file system
+   */
+  inline File::VFS &getVFS() { return *vfs; }
+
+  /**
+   * @brief Access the asset loader
+   * @return Reference to the asset loader
+   */
+  inline AssetLoader &getAssetLoader() { return *asset_loader; }
+
   /**
    * @brief Initialize the engine with configuration
    * @param config Engine configuration
@@ -66,6 +86,13 @@ public:
    * @param app Application instance implementing game logic
    */
   void run(Application &);
+
+private:
+  /**
+   * @brief Update, tick and render one frame
+   * @return false once the application asks to stop
+   */
+  bool frame(Application &, Timer &);
 };
 
 } /* namespace Engine */
\ No newline at end of file
@@ -1,33 +1,113 @@
 #pragma once
 
-#include <fstream>
-#include <iterator>
+#include <new>
+#include <span>
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <utility>
+#include <filesystem>
 
 namespace File {
 using Path = std::filesystem::path;
 
-static inline bool readContent(Path file_path, std::string &source) {
-  std::ifstream f(file_path);
-  if (!f)
-    return false;
-  source.assign(std::istreambuf_iterator<char>(f), {});
-  return true;
-}
-
-static inline bool readContentBytes(Path file_path, std::vector<char> &v) {
-  std::ifstream file(file_path, std::ios::binary |
-                                    std::ios::ate); // open at end to get size
-  if (!file)
-    return false;
-
-  std::streamsize size = file.tellg();
-  file.seekg(0, std::ios::beg);
-
-  v.reserve(size);
-  v.assign(std::istreambuf_iterator<char>(file), {});
-  return true;
-}
+/* Heap bytes aligned to Buffer::ALIGNMENT, enough to view them as SPIR-V words, vertices or SIMD lanes */
+class Buffer {
+  char *bytes = nullptr;
+  size_t length = 0;
+
+public:
+  static constexpr size_t ALIGNMENT = 64;
+
+  Buffer() noexcept = default;
+  explicit Buffer(size_t size) : length(size) {
+    if (size > 0)
+      bytes = static_cast<char *>(::operator new(size, std::align_val_t{ ALIGNMENT }));
+  }
+  ~Buffer() noexcept { reset(); }
+
+  Buffer(const Buffer &) = delete;
+  Buffer &operator=(const Buffer &) = delete;
+
+  Buffer(Buffer &&other) noexcept { *this = std::move(other); }
+  Buffer &operator=(Buffer &&other) noexcept {
+    if (this != &other) {
+      reset();
+      bytes = std::exchange(other.bytes, nullptr);
+      length = std::exchange(other.length, 0);
+    }
+    return *this;
+  }
+
+  inline void reset() noexcept {
+    if (bytes)
+      ::operator delete(bytes, std::align_val_t{ ALIGNMENT });
+    bytes = nullptr;
+    length = 0;
+  }
+
+  inline char *data() noexcept { return bytes; }
+  inline const char *data() const noexcept { return bytes; }
+  inline size_t size() const noexcept { return length; }
+  inline bool empty() const noexcept { return length == 0; }
+  inline std::span<char> span() noexcept { return { bytes, length }; }
+  inline std::span<const char> view() const noexcept { return { bytes, length }; }
+};
+
+/* Whole-file reads, one bulk read() each instead of streaming through iostreams */
+bool readAll(const Path &, Buffer &);
+bool readContent(const Path &, std::string &);
+bool readContentBytes(const Path &, std::vector<char> &);
+
+/* Read-only memory mapping of a whole file, unmapped on destruction */
+class MappedFile {
+  const char *bytes = nullptr;
+  size_t length = 0;
+  bool opened = false; /* empty files are open without a mapping */
+
+  /* Win32 file and mapping handles, unused elsewhere */
+  void *file_handle = nullptr;
+  void *mapping_handle = nullptr;
+
+public:
+  MappedFile() noexcept = default;
+  ~MappedFile() noexcept { close(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+  MappedFile &operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      close();
+      bytes = std::exchange(other.bytes, nullptr);
+      length = std::exchange(other.length, 0);
+      opened = std::exchange(other.opened, false);
+      file_handle = std::exchange(other.file_handle, nullptr);
+      mapping_handle = std::exchange(other.mapping_handle, nullptr);
+    }
+    return *this;
+  }
+
+  /* Readahead hints, for the whole mapping on open() or for a range of it through advise() */
+  enum class Access {
+    Normal,
+    Sequential, /* read front to back once, pages behind the reader can be dropped early */
+    Random,     /* scattered lookups, readahead would only waste memory */
+    WillNeed,   /* fault the range in ahead of use */
+  };
+
+  /* Empty files open as an empty view. The file may be deleted while mapped, the contents stay valid until close() */
+  bool open(const Path &, Access = Access::Normal);
+  void close() noexcept;
+
+  /* Widened to whole pages, a no-op where the platform has no equivalent */
+  void advise(Access, size_t offset = 0, size_t size = SIZE_MAX) const noexcept;
+
+  inline bool isOpen() const noexcept { return opened; }
+  inline const char *data() const noexcept { return bytes; }
+  inline size_t size() const noexcept { return length; }
+  inline std::span<const char> view() const noexcept { return { bytes, length }; }
+};
 
 }; /* namespace File */
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+namespace Hash {
+
+struct Hash128 {
+  uint64_t low = 0;
+  uint64_t high = 0;
+
+  constexpr bool operator==(const Hash128 &) const noexcept = default;
+};
+
+/* For unordered containers, the bits are already well mixed */
+struct Hash128Hasher {
+  inline size_t operator()(const Hash128 &hash) const noexcept { return static_cast<size_t>(hash.low); }
+};
+
+/* Incremental MurmurHash3 x64 128-bit, identical to the one-shot reference for the same bytes */
+class Murmur3_128 {
+  static constexpr uint64_t C1 = 0x87c37b91114253d5ull;
+  static constexpr uint64_t C2 = 0x4cf5ad432745937full;
+
+  uint64_t h1;
+  uint64_t h2;
+  uint64_t length = 0;
+
+  uint8_t tail[16] {};
+  size_t tail_size = 0;
+
+  static constexpr uint64_t rotl(uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+
+  static constexpr uint64_t fmix(uint64_t k) noexcept {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+  }
+
+  inline void block(const uint8_t *data) noexcept {
+    uint64_t k1, k2;
+    std::memcpy(&k1, data, 8);
+    std::memcpy(&k2, data + 8, 8);
+
+    k1 *= C1; k1 = rotl(k1, 31); k1 *= C2; h1 ^= k1;
+    h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= C2; k2 = rotl(k2, 33); k2 *= C1; h2 ^= k2;
+    h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+
+public:
+  explicit Murmur3_128(uint64_t seed = 0) noexcept : h1(seed), h2(seed) {}
+
+  inline Murmur3_128 &update(const void *data, size_t size) noexcept {
+    auto bytes = static_cast<const uint8_t *>(data);
+    length += size;
+
+    if (tail_size > 0) {
+      size_t take = std::min(size, sizeof(tail) - tail_size);
+      std::memcpy(tail + tail_size, bytes, take);
+      tail_size += take;
+      bytes += take;
+      size -= take;
+
+      if (tail_size < sizeof(tail))
+        return *this;
+
+      block(tail);
+      tail_size = 0;
+    }
+
+    for (; size >= 16; bytes += 16, size -= 16)
+      block(bytes);
+
+    std::memcpy(tail, bytes, size);
+    tail_size = size;
+    return *this;
+  }
+
+  template <typename T>
+  inline Murmur3_128 &update(std::span<const T> data) noexcept {
+    return update(data.data(), data.size_bytes());
+  }
+
+  inline Hash128 finish() const noexcept {
+    uint64_t a = h1, b = h2;
+    uint64_t k1 = 0, k2 = 0;
+
+    for (size_t i = tail_size; i > 8; --i)
+      k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+    for (size_t i = std::min<size_t>(tail_size, 8); i > 0; --i)
+      k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+
+    if (tail_size > 8) { k2 *= C2; k2 = rotl(k2, 33); k2 *= C1; b ^= k2; }
+    if (tail_size > 0) { k1 *= C1; k1 = rotl(k1, 31); k1 *= C2; a ^= k1; }
+
+    a ^= length;
+    b ^= length;
+    a += b;
+    b += a;
+    a = fmix(a);
+    b = fmix(b);
+    a += b;
+    b += a;
+
+    return Hash128 { .low = a, .high = b };
+  }
+};
+
+static inline Hash128 murmur3_128(const void *data, size_t size, uint64_t seed = 0) {
+  return Murmur3_128(seed).update(data, size).finish();
+}
+
+}; /* namespace Hash */
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+/*
+ * Byte-oriented LZ77 in the LZ4 block layout: a token with literal and match lengths,
+ * the literals, a 16-bit offset and length extensions. Fast to decode, for archive entries.
+ */
+namespace LZ {
+
+/* A length byte extends a match by at most 255 bytes, no input decompresses to more than this many times its size */
+inline constexpr size_t MAX_RATIO = 255;
+
+std::vector<char> compress(std::span<const char>);
+
+/* `out` has to be exactly the decompressed size, false on corrupt input */
+bool decompress(std::span<const char> in, std::span<char> out);
+
+} /* namespace LZ */
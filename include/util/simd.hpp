@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace SIMD {
+
+/* Four floats processed in lockstep, SSE2 when available and plain loops otherwise */
+struct Float4 {
+#if SIMD_SSE2
+  __m128 v;
+
+  Float4() noexcept : v(_mm_setzero_ps()) {}
+  Float4(__m128 _v) noexcept : v(_v) {}
+  explicit Float4(float s) noexcept : v(_mm_set1_ps(s)) {}
+  Float4(float a, float b, float c, float d) noexcept : v(_mm_setr_ps(a, b, c, d)) {}
+
+  static inline Float4 load(const float *in) noexcept { return _mm_loadu_ps(in); }
+  inline void store(float *out) const noexcept { _mm_storeu_ps(out, v); }
+
+  friend inline Float4 operator+(Float4 a, Float4 b) noexcept { return _mm_add_ps(a.v, b.v); }
+  friend inline Float4 operator-(Float4 a, Float4 b) noexcept { return _mm_sub_ps(a.v, b.v); }
+  friend inline Float4 operator*(Float4 a, Float4 b) noexcept { return _mm_mul_ps(a.v, b.v); }
+  friend inline Float4 operator/(Float4 a, Float4 b) noexcept { return _mm_div_ps(a.v, b.v); }
+
+  friend inline Float4 min(Float4 a, Float4 b) noexcept { return _mm_min_ps(a.v, b.v); }
+  friend inline Float4 max(Float4 a, Float4 b) noexcept { return _mm_max_ps(a.v, b.v); }
+  friend inline Float4 sqrt(Float4 a) noexcept { return _mm_sqrt_ps(a.v); }
+
+  /* lanes where `mask` is set take `b`, the others `a` */
+  friend inline Float4 select(Float4 a, Float4 b, Float4 mask) noexcept {
+    return _mm_or_ps(_mm_and_ps(mask.v, b.v), _mm_andnot_ps(mask.v, a.v));
+  }
+  friend inline Float4 greater(Float4 a, Float4 b) noexcept { return _mm_cmpgt_ps(a.v, b.v); }
+#else
+  float v[4];
+
+  Float4() noexcept : v { 0.0f, 0.0f, 0.0f, 0.0f } {}
+  explicit Float4(float s) noexcept : v { s, s, s, s } {}
+  Float4(float a, float b, float c, float d) noexcept : v { a, b, c, d } {}
+
+  static inline Float4 load(const float *in) noexcept { return Float4(in[0], in[1], in[2], in[3]); }
+  inline void store(float *out) const noexcept { std::copy(v, v + 4, out); }
+
+  template <typename F>
+  static inline Float4 map(Float4 a, Float4 b, F f) noexcept {
+    return Float4(f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3]));
+  }
+
+  friend inline Float4 operator+(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return x + y; }); }
+  friend inline Float4 operator-(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return x - y; }); }
+  friend inline Float4 operator*(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return x * y; }); }
+  friend inline Float4 operator/(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return x / y; }); }
+
+  friend inline Float4 min(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return std::min(x, y); }); }
+  friend inline Float4 max(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return std::max(x, y); }); }
+  friend inline Float4 sqrt(Float4 a) noexcept { return map(a, a, [](float x, float) { return std::sqrt(x); }); }
+
+  /* masks are 0 or 1 per lane in the scalar fallback */
+  friend inline Float4 select(Float4 a, Float4 b, Float4 mask) noexcept {
+    return Float4(mask.v[0] != 0.0f ? b.v[0] : a.v[0], mask.v[1] != 0.0f ? b.v[1] : a.v[1],
+                  mask.v[2] != 0.0f ? b.v[2] : a.v[2], mask.v[3] != 0.0f ? b.v[3] : a.v[3]);
+  }
+  friend inline Float4 greater(Float4 a, Float4 b) noexcept { return map(a, b, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); }
+#endif
+
+  inline float operator[](int i) const noexcept {
+    alignas(16) float lanes[4];
+    store(lanes);
+    return lanes[i];
+  }
+};
+
+/* Four 3D vectors in structure-of-arrays form */
+struct Vec3x4 {
+  Float4 x, y, z;
+
+  friend inline Vec3x4 operator+(const Vec3x4 &a, const Vec3x4 &b) noexcept { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+  friend inline Vec3x4 operator-(const Vec3x4 &a, const Vec3x4 &b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+  friend inline Vec3x4 operator*(const Vec3x4 &a, Float4 s) noexcept { return { a.x * s, a.y * s, a.z * s }; }
+
+  friend inline Float4 dot(const Vec3x4 &a, const Vec3x4 &b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+  friend inline Vec3x4 cross(const Vec3x4 &a, const Vec3x4 &b) noexcept {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+  }
+};
+
+} /* namespace SIMD */
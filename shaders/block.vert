@@ -17,12 +17,25 @@ layout(std140, set = 0, binding = 0) uniform CameraUBO {
   mat4 proj_view;
 };
 
+/* Mesh::InstanceData, indexed through the draw's first instance */
+struct InstanceData {
+  mat4 model;
+  uint material;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Instances {
+  InstanceData instances[];
+};
+
 void main() {
-  frag_world_pos       = in_position;
+  InstanceData instance = instances[gl_InstanceIndex];
+  vec4 world_position  = instance.model * vec4(in_position, 1.0);
+
+  frag_world_pos       = world_position.xyz;
   frag_color           = in_color;
   frag_texture_coord   = in_texture_coord;
-  frag_normal          = in_normal;
-  gl_Position          = proj_view * vec4(in_position, 1.0);
+  frag_normal          = mat3(instance.model) * in_normal;
+  gl_Position          = proj_view * world_position;
 
 #ifdef VULKAN
   gl_Position.y *= -1;
@@ -0,0 +1,211 @@
+#include <core/assets/asset_loader.hpp>
+#include <core/graphics/renderer.hpp>
+#include <core/platform/file_watcher.hpp>
+#include <core/assets/vfs.hpp>
+#include <core/logging.hpp>
+
+#include <array>
+#include <cmath>
+
+namespace Engine {
+
+/* unit cube drawn while the real mesh is loading */
+static Mesh makePlaceholderMesh() {
+  const glm::vec3 COLOR { 1.0f, 0.0f, 1.0f };
+  const std::array<glm::vec3, 6> NORMALS {{
+    { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+  }};
+
+  std::vector<Mesh::Vertex> vertices;
+  std::vector<Mesh::Index> indices;
+
+  for (glm::vec3 n : NORMALS) {
+    glm::vec3 u = std::abs(n.y) > 0.5f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+    glm::vec3 v = glm::cross(n, u);
+    Mesh::Index base = static_cast<Mesh::Index>(vertices.size());
+
+    for (glm::vec2 corner : { glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1) }) {
+      vertices.push_back(Mesh::Vertex{
+        .position = (n + u * corner.x + v * corner.y) * 0.5f,
+        .color = COLOR,
+        .uv = (corner + glm::vec2(1.0f)) * 0.5f,
+        .normal = n,
+        .tangent = glm::vec4(u, 1.0f),
+      });
+    }
+
+    indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+  }
+
+  return Mesh(std::move(vertices), std::move(indices));
+}
+
+AssetLoader::AssetLoader(Renderer &_renderer, uint32_t worker_threads, FileWatcher *_watcher) :
+  renderer(_renderer),
+  watcher(_watcher),
+  staging_allocator(_renderer.getStagingAllocator()),
+  workers(worker_threads),
+  io(workers) {
+  placeholder = renderer.addMesh(makePlaceholderMesh());
+
+  if (!io.init())
+    LOG_WARN("[AssetLoader]: Asynchronous reads are unavailable");
+
+  LOG_INFO("[AssetLoader]: Started with {} worker thread(s)", workers.getThreadCount());
+}
+
+AssetLoader::MeshHandle AssetLoader::loadMesh(File::Path path, MeshOptions options) {
+  std::string key = std::filesystem::absolute(path).lexically_normal().string();
+  key += options.generate_lods ? "|lod" : "";
+  key += options.build_meshlets ? "|meshlet" : "";
+
+  if (auto it = requests.find(key); it != requests.end())
+    return MeshHandle(it->second);
+
+  auto request = std::make_shared<Request>();
+  request->path = std::move(path);
+  request->options = options;
+  request->mesh = renderer.reserveMesh(placeholder);
+
+  /* reloads go through the same request, so the mesh handle never changes. Packed files never change */
+  if (watcher)
+    if (std::optional<File::VFS::Location> location = File::locate(request->path); location && !location->packed)
+      watcher->watch(location->file, [this, request](const File::Path &) { enqueue(request); });
+
+  enqueue(request);
+  requests.emplace(std::move(key), request);
+  return MeshHandle(request);
+}
+
+static bool isSourceFormat(const File::Path &path) {
+  const File::Path extension = path.extension();
+  return extension == ".obj" || extension == ".gltf" || extension == ".glb";
+}
+
+/*
+ * Staged meshes have fixed-size buffers: imports that still build LODs or meshlets decode
+ * on the heap and are staged once complete() is done with them. Cooked files carry both already.
+ */
+static const Mesh::StagingAllocator &pickAllocator(const AssetLoader::MeshOptions &options, const Mesh::StagingAllocator &staging) {
+  static const Mesh::StagingAllocator no_staging;
+  return (options.generate_lods || options.build_meshlets) ? no_staging : staging;
+}
+
+void AssetLoader::enqueue(std::shared_ptr<Request> request) {
+  /* reloads can finish out of order, only the latest one is handed over */
+  const uint32_t sequence = ++request->sequence;
+
+  if (!isSourceFormat(request->path)) {
+    read(std::move(request), sequence);
+    return;
+  }
+
+  workers.enqueue([this, request = std::move(request), sequence] { process(request, sequence); });
+}
+
+void AssetLoader::read(std::shared_ptr<Request> request, uint32_t sequence) {
+  std::optional<File::VFS::Location> location = File::locate(request->path);
+  if (!location) {
+    complete(std::move(request), sequence, std::nullopt);
+    return;
+  }
+
+  /* compressed pack entries decompress on a worker instead */
+  if (location->compressed) {
+    workers.enqueue([this, request = std::move(request), sequence] {
+      complete(request, sequence, Mesh::fromCooked(request->path, staging_allocator));
+    });
+    return;
+  }
+
+  /* the index holds sizes from mount time, a hot-reloaded loose file may have changed since */
+  if (!location->packed) {
+    std::error_code error;
+    location->size = std::filesystem::file_size(location->file, error);
+    if (error) {
+      complete(std::move(request), sequence, std::nullopt);
+      return;
+    }
+  }
+
+  /* the buffer lives until the callback has decoded it */
+  auto buffer = std::make_shared<File::Buffer>(static_cast<size_t>(location->size));
+
+  io.submit(AsyncIO::Read {
+    .path = std::move(location->file),
+    .offset = location->offset,
+    .size = buffer->size(),
+    .destination = buffer->data(),
+    .callback = [this, request = std::move(request), sequence, buffer](AsyncIO::Result result) {
+      std::optional<Mesh> mesh;
+      if (result.ok() && result.bytes == buffer->size())
+        mesh = Mesh::fromCooked(buffer->view(), request->path.string(), staging_allocator);
+      else
+        LOG_ERROR("[AssetLoader]: Reading `{}` failed, errno {}", request->path.string(), result.error);
+
+      complete(request, sequence, std::move(mesh));
+    },
+  });
+}
+
+void AssetLoader::process(std::shared_ptr<Request> request, uint32_t sequence) {
+  const Mesh::StagingAllocator &allocator = pickAllocator(request->options, staging_allocator);
+
+  std::optional<Mesh> mesh;
+  if (request->path.extension() == ".obj")
+    mesh = Mesh::fromOBJ(request->path, allocator, &workers);
+  else
+    mesh = Mesh::fromGLTF(request->path, allocator, &workers);
+
+  complete(std::move(request), sequence, std::move(mesh));
+}
+
+void AssetLoader::complete(std::shared_ptr<Request> request, uint32_t sequence, std::optional<Mesh> mesh) {
+  const MeshOptions &options = request->options;
+  /* staged cooked meshes keep whatever the cooker built, their buffers can't change anymore */
+  if (mesh && !mesh->isStaged()) {
+    if (options.generate_lods && mesh->getLODs().size() <= 1)
+      mesh->generateLODs(Mesh::LODSettings{});
+    if (options.build_meshlets && mesh->getMeshlets().empty())
+      mesh->buildMeshlets();
+
+    mesh->stage(staging_allocator);
+  }
+
+  std::scoped_lock lock(completed_mutex);
+  completed.push_back(Completion { .request = std::move(request), .sequence = sequence, .mesh = std::move(mesh) });
+}
+
+void AssetLoader::update() {
+  std::vector<Completion> finished;
+  {
+    std::scoped_lock lock(completed_mutex);
+    finished.swap(completed);
+  }
+
+  for (Completion &completion : finished) {
+    Request &request = *completion.request;
+
+    /* a newer reload of the same file is still on its way */
+    if (completion.sequence != request.sequence)
+      continue;
+
+    if (!completion.mesh) {
+      /* a broken reload keeps the version that is already loaded */
+      if (request.state.load(std::memory_order_relaxed) == State::Ready) {
+        LOG_WARN("[AssetLoader]: Unable to reload `{}`, keeping the previous version", request.path.string());
+        continue;
+      }
+
+      LOG_ERROR("[AssetLoader]: Unable to load `{}`", request.path.string());
+      request.state.store(State::Failed, std::memory_order_release);
+      continue;
+    }
+
+    /* the upload itself happens in Renderer::beginFrame, within its byte budget */
+    renderer.updateMesh(request.mesh, std::move(*completion.mesh));
+    request.state.store(State::Ready, std::memory_order_release);
+  }
+}
+
+} /* namespace Engine */
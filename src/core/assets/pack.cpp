@@ -0,0 +1,247 @@
+#include <core/assets/pack.hpp>
+#include <core/logging.hpp>
+#include <util/lz.hpp>
+
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+namespace Engine {
+
+static constexpr uint64_t ALIGNMENT = 16;
+
+static_assert(std::is_trivially_copyable_v<Pack::Header> && sizeof(Pack::Header) % ALIGNMENT == 0);
+static_assert(std::is_trivially_copyable_v<Pack::Entry> && sizeof(Pack::Entry) % 8 == 0);
+
+static inline bool hashLess(const Hash::Hash128 &a, const Hash::Hash128 &b) {
+  return a.high != b.high ? a.high < b.high : a.low < b.low;
+}
+
+std::string Pack::normalizePath(std::string_view path) {
+  std::string normalized = File::Path(path).lexically_normal().generic_string();
+
+  while (normalized.starts_with("./"))
+    normalized.erase(0, 2);
+  while (normalized.starts_with('/'))
+    normalized.erase(0, 1);
+
+  return normalized;
+}
+
+Hash::Hash128 Pack::hashPath(std::string_view normalized) {
+  return Hash::murmur3_128(normalized.data(), normalized.size());
+}
+
+bool Pack::open(const File::Path &_path) {
+  close();
+
+  /* lookups land all over the archive, entries are prefetched one at a time as they are read */
+  if (!mapping.open(_path, File::MappedFile::Access::Random)) {
+    LOG_ERROR("[Pack]: Failed to map `{}`", _path.string());
+    return false;
+  }
+
+  const char *data = mapping.data();
+  const uint64_t size = mapping.size();
+
+  Header header;
+  if (size < sizeof(header)) {
+    LOG_ERROR("[Pack]: `{}` is not an asset pack", _path.string());
+    close();
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+
+  if (header.magic != Header::MAGIC || header.version != Header::VERSION) {
+    LOG_ERROR("[Pack]: `{}` has an unsupported pack version", _path.string());
+    close();
+    return false;
+  }
+
+  const uint64_t toc_size = uint64_t(header.entry_count) * sizeof(Entry);
+  if (header.toc_offset % ALIGNMENT != 0 || header.toc_offset > size || toc_size > size - header.toc_offset ||
+      header.name_table_offset > size || header.name_table_size > size - header.name_table_offset) {
+    LOG_ERROR("[Pack]: `{}` is truncated", _path.string());
+    close();
+    return false;
+  }
+
+  /* the mapping is page aligned and the table of contents 16-byte aligned inside it */
+  entries = { reinterpret_cast<const Entry *>(data + header.toc_offset), header.entry_count };
+  names = { data + header.name_table_offset, header.name_table_size };
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry &entry = entries[i];
+    const bool in_bounds = entry.offset <= size && entry.stored_size <= size - entry.offset &&
+                           uint64_t(entry.name_offset) + entry.name_length <= names.size();
+    const bool sorted = i == 0 || !hashLess(entry.path_hash, entries[i - 1].path_hash);
+    /* bounds the sizes read() allocates: stored entries lie in the file, LZ ones can't expand further */
+    const bool known = entry.compression == Compression::None ? entry.stored_size == entry.size
+                                                              : entry.compression == Compression::LZ &&
+                                                                entry.size <= entry.stored_size * LZ::MAX_RATIO;
+    if (!in_bounds || !sorted || !known) {
+      LOG_ERROR("[Pack]: `{}` has a corrupt table of contents", _path.string());
+      close();
+      return false;
+    }
+  }
+
+  path = _path;
+  LOG_DEBUG("[Pack]: Mapped `{}` with {} entries", path.string(), entries.size());
+  return true;
+}
+
+void Pack::close() noexcept {
+  mapping.close();
+  entries = {};
+  names = {};
+  path.clear();
+}
+
+const Pack::Entry *Pack::find(std::string_view lookup) const {
+  const std::string normalized = normalizePath(lookup);
+  const Hash::Hash128 hash = hashPath(normalized);
+
+  auto it = std::lower_bound(entries.begin(), entries.end(), hash, [](const Entry &entry, const Hash::Hash128 &value) {
+    return hashLess(entry.path_hash, value);
+  });
+
+  /* names settle the (unlikely) hash collisions */
+  for (; it != entries.end() && it->path_hash == hash; ++it)
+    if (getName(*it) == normalized)
+      return &*it;
+
+  return nullptr;
+}
+
+std::span<const char> Pack::view(const Entry &entry) const {
+  if (entry.compression != Compression::None)
+    return {};
+
+  mapping.advise(File::MappedFile::Access::WillNeed, entry.offset, entry.stored_size);
+  return { mapping.data() + entry.offset, static_cast<size_t>(entry.stored_size) };
+}
+
+bool Pack::read(const Entry &entry, std::span<char> out) const {
+  if (out.size() != entry.size) {
+    LOG_ERROR("[Pack]: `{}` needs {} bytes, got {}", getName(entry), entry.size, out.size());
+    return false;
+  }
+
+  std::span<const char> stored { mapping.data() + entry.offset, static_cast<size_t>(entry.stored_size) };
+  mapping.advise(File::MappedFile::Access::WillNeed, entry.offset, entry.stored_size);
+
+  switch (entry.compression) {
+  case Compression::None:
+    std::copy(stored.begin(), stored.end(), out.begin());
+    return true;
+  case Compression::LZ:
+    if (LZ::decompress(stored, out))
+      return true;
+    LOG_ERROR("[Pack]: `{}` in `{}` is corrupt", getName(entry), path.string());
+    return false;
+  }
+
+  return false;
+}
+
+bool Pack::read(const Entry &entry, std::vector<char> &out) const {
+  out.resize(entry.size);
+  if (read(entry, std::span<char>(out)))
+    return true;
+
+  out.clear();
+  return false;
+}
+
+std::string_view Pack::getName(const Entry &entry) const {
+  return names.substr(entry.name_offset, entry.name_length);
+}
+
+bool Pack::Writer::open(const File::Path &_path) {
+  path = _path;
+  entries.clear();
+  names.clear();
+
+  ofs.open(path, std::ios::binary | std::ios::trunc);
+  if (!ofs) {
+    LOG_ERROR("[Pack]: Failed to open `{}` for writing", path.string());
+    return false;
+  }
+
+  /* rewritten by finish() */
+  Header header {};
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  offset = sizeof(header);
+  return static_cast<bool>(ofs);
+}
+
+bool Pack::Writer::pad() {
+  static constexpr char ZEROS[ALIGNMENT] {};
+  const uint64_t padding = (ALIGNMENT - offset % ALIGNMENT) % ALIGNMENT;
+  ofs.write(ZEROS, static_cast<std::streamsize>(padding));
+  offset += padding;
+  return static_cast<bool>(ofs);
+}
+
+bool Pack::Writer::add(std::string_view entry_path, std::span<const char> data, Compression compression) {
+  const std::string normalized = normalizePath(entry_path);
+
+  std::vector<char> compressed;
+  if (compression == Compression::LZ) {
+    compressed = LZ::compress(data);
+    if (compressed.size() >= data.size())
+      compression = Compression::None;
+  }
+
+  std::span<const char> stored = compression == Compression::None ? data : std::span<const char>{ compressed };
+
+  entries.push_back(Entry {
+    .path_hash   = hashPath(normalized),
+    .offset      = offset,
+    .stored_size = stored.size(),
+    .size        = data.size(),
+    .name_offset = static_cast<uint32_t>(names.size()),
+    .name_length = static_cast<uint32_t>(normalized.size()),
+    .compression = compression,
+  });
+  names += normalized;
+
+  ofs.write(stored.data(), static_cast<std::streamsize>(stored.size()));
+  offset += stored.size();
+  return pad();
+}
+
+bool Pack::Writer::finish() {
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return hashLess(a.path_hash, b.path_hash); });
+
+  for (size_t i = 1; i < entries.size(); ++i) {
+    if (entries[i].path_hash == entries[i - 1].path_hash &&
+        std::string_view(names).substr(entries[i].name_offset, entries[i].name_length) ==
+        std::string_view(names).substr(entries[i - 1].name_offset, entries[i - 1].name_length)) {
+      LOG_ERROR("[Pack]: `{}` was added twice", names.substr(entries[i].name_offset, entries[i].name_length));
+      return false;
+    }
+  }
+
+  Header header {
+    .entry_count = static_cast<uint32_t>(entries.size()),
+    .name_table_size = static_cast<uint32_t>(names.size()),
+    .toc_offset = offset,
+    .name_table_offset = offset + entries.size() * sizeof(Entry),
+  };
+
+  ofs.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+  ofs.write(names.data(), static_cast<std::streamsize>(names.size()));
+  ofs.seekp(0);
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  ofs.close();
+
+  if (!ofs) {
+    LOG_ERROR("[Pack]: Failed to write `{}`", path.string());
+    return false;
+  }
+  return true;
+}
+
+} /* namespace Engine */
@@ -0,0 +1,205 @@
+#include <core/assets/vfs.hpp>
+#include <core/logging.hpp>
+
+#include <filesystem>
+
+namespace File {
+
+static std::string joinPath(std::string_view mount_point, std::string_view relative) {
+  if (mount_point.empty())
+    return Engine::Pack::normalizePath(relative);
+
+  std::string joined { mount_point };
+  joined += '/';
+  joined += relative;
+  return Engine::Pack::normalizePath(joined);
+}
+
+bool Data::map(const Path &path, MappedFile::Access access) {
+  buffer.reset();
+  bytes = {};
+
+  if (!mapping.open(path, access))
+    return false;
+
+  bytes = mapping.view();
+  return true;
+}
+
+bool VFS::mountDirectory(const Path &directory, std::string_view mount_point, int priority) {
+  std::error_code error;
+  if (!std::filesystem::is_directory(directory, error)) {
+    LOG_ERROR("[VFS]: `{}` is not a directory", directory.string());
+    return false;
+  }
+
+  const uint32_t mount = static_cast<uint32_t>(mounts.size());
+  mounts.push_back(Mount {
+    .source = directory,
+    .point = Engine::Pack::normalizePath(mount_point),
+    .priority = priority,
+    .pack = nullptr,
+  });
+
+  /* the one directory walk this mount will ever do */
+  size_t count = 0;
+  auto options = std::filesystem::directory_options::skip_permission_denied;
+  for (auto it = std::filesystem::recursive_directory_iterator(directory, options, error);
+       !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+    if (!it->is_regular_file(error))
+      continue;
+
+    const std::string relative = it->path().lexically_relative(directory).generic_string();
+    insert(Node {
+      .path = joinPath(mounts[mount].point, relative),
+      .mount = mount,
+      .size = static_cast<uint64_t>(it->file_size(error)),
+    });
+    ++count;
+  }
+
+  if (error) {
+    LOG_ERROR("[VFS]: Failed to index `{}`: {}", directory.string(), error.message());
+    return false;
+  }
+
+  LOG_INFO("[VFS]: Mounted `{}` at `/{}` with {} files, priority {}", directory.string(), mounts[mount].point, count, priority);
+  return true;
+}
+
+bool VFS::mountPack(const Path &archive, std::string_view mount_point, int priority) {
+  auto pack = std::make_unique<Engine::Pack>();
+  if (!pack->open(archive))
+    return false;
+
+  const uint32_t mount = static_cast<uint32_t>(mounts.size());
+  mounts.push_back(Mount {
+    .source = archive,
+    .point = Engine::Pack::normalizePath(mount_point),
+    .priority = priority,
+    .pack = std::move(pack),
+  });
+
+  const Engine::Pack &mounted = *mounts[mount].pack;
+  for (const Engine::Pack::Entry &entry : mounted.getEntries()) {
+    insert(Node {
+      .path = joinPath(mounts[mount].point, mounted.getName(entry)),
+      .mount = mount,
+      .size = entry.size,
+      .entry = &entry,
+    });
+  }
+
+  LOG_INFO("[VFS]: Mounted `{}` at `/{}` with {} files, priority {}", archive.string(), mounts[mount].point, mounted.getEntries().size(), priority);
+  return true;
+}
+
+bool VFS::mount(const Path &source, std::string_view mount_point, int priority) {
+  std::error_code error;
+  return std::filesystem::is_directory(source, error) ? mountDirectory(source, mount_point, priority)
+                                                      : mountPack(source, mount_point, priority);
+}
+
+void VFS::insert(Node node) {
+  const Hash::Hash128 hash = Engine::Pack::hashPath(node.path);
+
+  auto [it, inserted] = index.try_emplace(hash, node);
+  if (inserted)
+    return;
+
+  if (it->second.path != node.path) {
+    LOG_ERROR("[VFS]: `{}` and `{}` share a path hash, `{}` stays hidden", it->second.path, node.path, node.path);
+    return;
+  }
+
+  if (mounts[node.mount].priority >= mounts[it->second.mount].priority)
+    it->second = std::move(node);
+}
+
+const VFS::Node *VFS::find(std::string_view path) const {
+  const std::string normalized = Engine::Pack::normalizePath(path);
+
+  auto it = index.find(Engine::Pack::hashPath(normalized));
+  if (it == index.end() || it->second.path != normalized)
+    return nullptr;
+
+  return &it->second;
+}
+
+Path VFS::realPath(const Node &node) const {
+  const Mount &mount = mounts[node.mount];
+  std::string_view relative = node.path;
+  if (!mount.point.empty())
+    relative.remove_prefix(mount.point.size() + 1);
+
+  return mount.source / Path(relative);
+}
+
+bool VFS::exists(std::string_view path) const {
+  return find(path) != nullptr;
+}
+
+std::optional<VFS::Location> VFS::locate(std::string_view path) const {
+  const Node *node = find(path);
+  if (!node)
+    return std::nullopt;
+
+  if (!node->entry)
+    return Location { .file = realPath(*node), .size = node->size };
+
+  return Location {
+    .file = mounts[node->mount].source,
+    .offset = node->entry->offset,
+    .size = node->entry->stored_size,
+    .packed = true,
+    .compressed = node->entry->compression != Engine::Pack::Compression::None,
+  };
+}
+
+bool VFS::open(std::string_view path, Data &data, MappedFile::Access access) const {
+  const Node *node = find(path);
+  if (!node)
+    return false;
+
+  if (!node->entry)
+    return data.map(realPath(*node), access);
+
+  const Engine::Pack &pack = *mounts[node->mount].pack;
+  data.mapping.close();
+  data.buffer.reset();
+
+  if (node->entry->compression == Engine::Pack::Compression::None) {
+    data.bytes = pack.view(*node->entry);
+    return true;
+  }
+
+  data.buffer = Buffer(node->entry->size);
+  data.bytes = data.buffer.view();
+  if (pack.read(*node->entry, data.buffer.span()))
+    return true;
+
+  data.buffer.reset();
+  data.bytes = {};
+  return false;
+}
+
+bool load(const Path &path, Data &data, MappedFile::Access access) {
+  if (const VFS *vfs = VFS::instance(); vfs && vfs->open(path.generic_string(), data, access))
+    return true;
+  return data.map(path, access);
+}
+
+std::optional<VFS::Location> locate(const Path &path) {
+  if (const VFS *vfs = VFS::instance())
+    if (std::optional<VFS::Location> location = vfs->locate(path.generic_string()))
+      return location;
+
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(path, error);
+  if (error)
+    return std::nullopt;
+
+  return VFS::Location { .file = path, .size = size };
+}
+
+} /* namespace File */
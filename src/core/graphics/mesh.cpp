@@ -1,16 +1,21 @@
 #include <core/graphics/mesh.hpp>
+#include <core/thread_pool.hpp>
 #include <core/logging.hpp>
+#include <core/assets/vfs.hpp>
 
 #include <fstream>
-#include <sstream>
 #include <string>
+#include <charconv>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <unordered_map>
 #include <glm/glm.hpp>
 #include <algorithm>
-
-#include <tiny_gltf.h>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <format>
 
 namespace Engine {
 
@@ -43,39 +48,105 @@ static int objIndexToZeroBased(int idx, std::size_t vec_size) noexcept {
   return -1;
 }
 
+// parse the integer at the front of `s`, 0 (absent in OBJ) if there is none
+static int parseIndex(std::string_view s) noexcept {
+  int value = 0;
+  std::from_chars(s.data(), s.data() + s.size(), value);
+  return value;
+}
+
 // parse face token like "v", "v/t", "v//n", "v/t/n"
 static void parseFaceToken(std::string_view token, int& vi_out, int& ti_out, int& ni_out) {
-  vi_out = ti_out = ni_out = -1;
+  vi_out = ti_out = ni_out = 0;
   size_t p1 = token.find('/');
-  if (p1 == std::string_view::npos) {
-    vi_out = std::stoi(std::string(token));
-    return;
+  vi_out = parseIndex(token.substr(0, p1));
+  if (p1 == std::string_view::npos) return;
+
+  size_t p2 = token.find('/', p1 + 1);
+  ti_out = parseIndex(token.substr(p1 + 1, p2 == std::string_view::npos ? p2 : p2 - (p1 + 1)));
+  if (p2 != std::string_view::npos) ni_out = parseIndex(token.substr(p2 + 1));
+}
+
+// read up to `count` whitespace separated floats off the front of `s`, returns how many were read
+static size_t parseFloats(std::string_view &s, float *out, size_t count) noexcept {
+  size_t n = 0;
+  for (; n < count; ++n) {
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) break;
+
+    auto [end, error] = std::from_chars(s.data() + begin, s.data() + s.size(), out[n]);
+    if (error != std::errc{}) break;
+    s.remove_prefix(static_cast<size_t>(end - s.data()));
   }
+  return n;
+}
 
-  if (p1 > 0) vi_out = std::stoi(std::string(token.substr(0, p1)));
+Mesh::Mesh(std::vector<Vertex> _vertices, std::vector<Index> _indices) noexcept :
+  vertices(std::move(_vertices)),
+  indices(std::move(_indices)) {
+  lods.push_back(LOD{
+    .range = { .first_index = 0, .index_count = static_cast<uint32_t>(indices.size()) },
+    .error = 0.0f,
+  });
+  updateBounds();
+}
 
-  size_t p2 = token.find('/', p1 + 1);
-  if (p2 == std::string_view::npos) {
-    std::string_view t = token.substr(p1 + 1);
-    if (!t.empty()) ti_out = std::stoi(std::string(t));
-    return;
+void Mesh::allocate(size_t vertex_count, size_t index_count, const StagingAllocator &allocator) {
+  staging = allocator ? allocator(vertex_count, index_count) : nullptr;
+
+  vertices.clear();
+  indices.clear();
+  if (!staging) {
+    vertices.resize(vertex_count);
+    indices.resize(index_count);
   }
+}
+
+void Mesh::stage(const StagingAllocator &allocator) {
+  if (!allocator || staging)
+    return;
 
-  if (p2 == p1 + 1) {
-    std::string_view n = token.substr(p2 + 1);
-    if (!n.empty()) ni_out = std::stoi(std::string(n));
+  staging = allocator(vertices.size(), indices.size());
+  if (!staging)
+    return;
+
+  std::ranges::copy(vertices, staging->getVertices().begin());
+  std::ranges::copy(indices, staging->getIndices().begin());
+  vertices = {};
+  indices = {};
+}
+
+size_t Mesh::optimizeVertexFetch() {
+  if (isStaged()) {
+    LOG_ERROR("[Mesh]: Vertex fetch has to be optimized before a mesh is staged");
+    return vertices.size();
   }
-  else {
-    std::string_view t = token.substr(p1 + 1, p2 - (p1 + 1));
-    std::string_view n = token.substr(p2 + 1);
-    if (!t.empty()) ti_out = std::stoi(std::string(t));
-    if (!n.empty()) ni_out = std::stoi(std::string(n));
+
+  constexpr Index NONE = std::numeric_limits<Index>::max();
+  std::vector<Index> remap(vertices.size(), NONE);
+  std::vector<Vertex> ordered;
+  ordered.reserve(vertices.size());
+
+  for (Index &index : indices) {
+    if (remap[index] == NONE) {
+      remap[index] = static_cast<Index>(ordered.size());
+      ordered.push_back(vertices[index]);
+    }
+    index = remap[index];
   }
+
+  const bool dropped = ordered.size() != vertices.size();
+  vertices = std::move(ordered);
+  if (dropped)
+    updateBounds();
+
+  return vertices.size();
 }
 
-std::optional<Mesh> Mesh::fromOBJ(File::Path path) {
-  std::ifstream ifs(path);
-  if (!ifs) return std::nullopt;
+std::optional<Mesh> Mesh::fromOBJ(File::Path path, const StagingAllocator &allocator, ThreadPool *pool) {
+  /* parsed in place from the loaded bytes, no per-line copies */
+  File::Data file;
+  if (!File::load(path, file, File::MappedFile::Access::Sequential)) return std::nullopt;
 
   struct Position {
     glm::vec3 pos;
@@ -86,45 +157,53 @@ std::optional<Mesh> Mesh::fromOBJ(File::Path path) {
   std::vector<glm::vec2> uvs;
   std::vector<glm::vec3> normals;
 
-  Mesh mesh;
-  mesh.vertices.clear();
-  mesh.indices.clear();
+  /* unique vertices are assembled once their count is known, directly in their final storage */
+  std::vector<Key> pending;
+  std::vector<Index> face_indices;
 
   std::unordered_map<Key, Index, KeyHash> unique;
   unique.reserve(1024);
 
-  std::string line;
-  while (std::getline(ifs, line)) {
-    if (line.empty()) continue;
+  std::vector<Key> face;
 
-    size_t pos = 0;
-    while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) ++pos;
-    if (pos >= line.size()) continue;
+  std::string_view text { file.data(), file.size() };
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
 
-    if (line.compare(pos, 2, "v ") == 0) {
-      std::istringstream ss(line.substr(pos + 2));
-      glm::vec3 p, c(1.0f);
-      ss >> p.x >> p.y >> p.z;
-      if (!(ss >> c.r >> c.g >> c.b)) {
+    size_t pos = line.find_first_not_of(" \t\r");
+    if (pos == std::string_view::npos) continue;
+    line.remove_prefix(pos);
+
+    if (line.starts_with("v ")) {
+      std::string_view rest = line.substr(2);
+      glm::vec3 p(0.0f), c(1.0f);
+      parseFloats(rest, &p.x, 3);
+      if (parseFloats(rest, &c.r, 3) != 3) {
         c = glm::vec3(1.0f); // default to white if no color
       }
       positions.push_back({p, c});
     }
-    else if (line.compare(pos, 3, "vt ") == 0) {
-      std::istringstream ss(line.substr(pos + 3));
-      glm::vec2 t; ss >> t.x >> t.y;
+    else if (line.starts_with("vt ")) {
+      std::string_view rest = line.substr(3);
+      glm::vec2 t(0.0f); parseFloats(rest, &t.x, 2);
       uvs.push_back(t);
     }
-    else if (line.compare(pos, 3, "vn ") == 0) {
-      std::istringstream ss(line.substr(pos + 3));
-      glm::vec3 n; ss >> n.x >> n.y >> n.z;
+    else if (line.starts_with("vn ")) {
+      std::string_view rest = line.substr(3);
+      glm::vec3 n(0.0f); parseFloats(rest, &n.x, 3);
       normals.push_back(n);
     }
-    else if (line.compare(pos, 2, "f ") == 0) {
-      std::istringstream ss(line.substr(pos + 2));
-      std::vector<Key> face;
-      std::string token;
-      while (ss >> token) {
+    else if (line.starts_with("f ")) {
+      std::string_view rest = line.substr(2);
+      face.clear();
+      for (size_t begin = rest.find_first_not_of(" \t\r"); begin != std::string_view::npos;
+           begin = rest.find_first_not_of(" \t\r", begin)) {
+        size_t token_end = std::min(rest.find_first_of(" \t\r", begin), rest.size());
+        std::string_view token = rest.substr(begin, token_end - begin);
+        begin = token_end;
+
         int vi=0, ti=0, ni=0;
         parseFaceToken(token, vi, ti, ni);
         int pvi = (vi != 0) ? objIndexToZeroBased(vi, positions.size()) : -1;
@@ -135,43 +214,365 @@ std::optional<Mesh> Mesh::fromOBJ(File::Path path) {
 
       if (face.size() < 3) continue;
 
-      glm::vec3 face_normal(0.0f);
-      bool need_face_normal = std::ranges::any_of(face, [](Key const& k){ return k.ni < 0; });
-      if (need_face_normal && face[0].vi >= 0 && face[1].vi >= 0 && face[2].vi >= 0) {
-        const glm::vec3& p0 = positions[face[0].vi].pos;
-        const glm::vec3& p1 = positions[face[1].vi].pos;
-        const glm::vec3& p2 = positions[face[2].vi].pos;
-        face_normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
-      }
-
       for (size_t i = 1; i + 1 < face.size(); ++i) {
         Key tri[3] = { face[0], face[i], face[i+1] };
         for (auto& key : tri) {
-          auto it = unique.find(key);
-          if (it == unique.end()) {
-            Mesh::Vertex v{};
-            if (key.vi >= 0 && static_cast<size_t>(key.vi) < positions.size()) {
-              v.position = positions[key.vi].pos;
-              v.color    = positions[key.vi].color;
-            }
-            v.uv = (key.ti >= 0 && static_cast<size_t>(key.ti) < uvs.size()) ? uvs[key.ti] : glm::vec2(0.0f);
-            if (key.ni >= 0 && static_cast<size_t>(key.ni) < normals.size())
-              v.normal = normals[key.ni];
-            else
-              v.normal = (face_normal != glm::vec3(0.0f)) ? face_normal : glm::vec3(0,0,1);
-
-            Index newIndex = static_cast<Index>(mesh.vertices.size());
-            mesh.vertices.push_back(v);
-            unique.emplace(key, newIndex);
-            mesh.indices.push_back(newIndex);
-          } else
-            mesh.indices.push_back(it->second);
+          auto [it, inserted] = unique.try_emplace(key, static_cast<Index>(pending.size()));
+          if (inserted)
+            pending.push_back(key);
+          face_indices.push_back(it->second);
         }
       }
     }
   }
 
+  const bool missing_normals = std::ranges::any_of(pending, [&normals](const Key &key) {
+    return key.ni < 0 || static_cast<size_t>(key.ni) >= normals.size();
+  });
+
+  /* generated normals can split vertices, such meshes are staged once the final count is known */
+  Mesh mesh;
+  mesh.allocate(pending.size(), face_indices.size(), missing_normals ? StagingAllocator{} : allocator);
+
+  std::span<Vertex> vertices = mesh.getVerticesView();
+  for (size_t i = 0; i < pending.size(); ++i) {
+    const Key &key = pending[i];
+    Mesh::Vertex v{};
+    if (key.vi >= 0 && static_cast<size_t>(key.vi) < positions.size()) {
+      v.position = positions[key.vi].pos;
+      v.color    = positions[key.vi].color;
+    }
+    v.uv = (key.ti >= 0 && static_cast<size_t>(key.ti) < uvs.size()) ? uvs[key.ti] : glm::vec2(0.0f);
+    if (key.ni >= 0 && static_cast<size_t>(key.ni) < normals.size())
+      v.normal = normals[key.ni];
+
+    vertices[i] = v;
+  }
+
+  std::ranges::copy(face_indices, mesh.getIndicesView().begin());
+
+  mesh.lods.push_back(LOD{
+    .range = { .first_index = 0, .index_count = static_cast<uint32_t>(face_indices.size()) },
+    .error = 0.0f,
+  });
+  mesh.updateBounds();
+
+  if (missing_normals) {
+    mesh.generateNormals(NormalSettings{ .pool = pool });
+    mesh.stage(allocator);
+  }
+  mesh.generateTangents(pool);
+
   return mesh;
 }
 
+void MeshManager::assignMeshData(MeshInfo &info, Mesh &&mesh) {
+  /* a mapping still being written reads the data replaced here, and would be stale anyway */
+  if (info.mapping.valid()) {
+    info.mapping.wait();
+    info.mapping = {};
+  }
+
+  info.vertex_count = mesh.vertices.size();
+  info.index_count = mesh.indices.size();
+
+  info.cpu_vertices = std::move(mesh.vertices);
+  info.cpu_indices = std::move(mesh.indices);
+  info.staging = std::move(mesh.staging);
+  info.lods = std::move(mesh.lods);
+  info.meshlets = std::move(mesh.meshlets);
+  info.bounds = mesh.bounds;
+  info.mapped_data.close();
+
+  if (info.staging) {
+    info.vertex_count = info.staging->getVertices().size();
+    info.index_count = info.staging->getIndices().size();
+  }
+}
+
+/* LOD and meshlet tables are hashed too, the same geometry may have been processed differently */
+static Hash::Hash128 hashMeshData(Mesh &mesh) {
+  return Hash::Murmur3_128()
+    .update(std::span<const Mesh::Vertex>{ mesh.getVerticesView() })
+    .update(std::span<const Mesh::Index>{ mesh.getIndicesView() })
+    .update(mesh.getLODs())
+    .update(mesh.getMeshlets())
+    .finish();
+}
+
+Mesh::Handle MeshManager::addMesh(Mesh &mesh) {
+  Hash::Hash128 hash = hashMeshData(mesh);
+  Mesh::Handle handle = acquireShared(hash);
+
+  /* only copied when it is not a duplicate */
+  return handle != Mesh::InvalidHandle ? handle : insertMesh(hash, Mesh(mesh));
+}
+
+Mesh::Handle MeshManager::addMesh(Mesh &&mesh) {
+  Hash::Hash128 hash = hashMeshData(mesh);
+  Mesh::Handle handle = acquireShared(hash);
+
+  return handle != Mesh::InvalidHandle ? handle : insertMesh(hash, std::move(mesh));
+}
+
+Mesh::Handle MeshManager::acquireShared(const Hash::Hash128 &hash) {
+  auto it = unique_meshes.find(hash);
+  if (it == unique_meshes.end())
+    return Mesh::InvalidHandle;
+
+  ++get(it->second).ref_count;
+  return it->second;
+}
+
+Mesh::Handle MeshManager::insertMesh(const Hash::Hash128 &hash, Mesh &&mesh) {
+  std::unique_ptr<MeshInfo> info = createInfo();
+  assignMeshData(*info, std::move(mesh));
+  info->content_hash = hash;
+  info->residency = default_residency;
+
+  Mesh::Handle handle = static_cast<Mesh::Handle>(meshes.size());
+  meshes.push_back(std::move(info));
+  unique_meshes.emplace(hash, handle);
+  return handle;
+}
+
+void MeshManager::release(Mesh::Handle handle) {
+  MeshInfo &info = get(handle);
+  assert(info.alive && info.ref_count > 0 && "releasing a mesh that is not alive");
+
+  if (--info.ref_count > 0)
+    return;
+
+  if (auto it = unique_meshes.find(info.content_hash); it != unique_meshes.end() && it->second == handle)
+    unique_meshes.erase(it);
+
+  releaseGPU(info);
+  assignMeshData(info, Mesh {});
+  info.alive = false;
+
+  if (info.alias != Mesh::InvalidHandle)
+    release(std::exchange(info.alias, Mesh::InvalidHandle));
+  if (info.replaces != Mesh::InvalidHandle)
+    release(std::exchange(info.replaces, Mesh::InvalidHandle));
+}
+
+MeshManager::MeshManager() noexcept = default;
+MeshManager::~MeshManager() noexcept = default;
+
+MeshManager::Stats MeshManager::getStats() const {
+  Stats stats;
+
+  /* reservations are counted through the reference they hold on their data */
+  for (const std::unique_ptr<MeshInfo> &info : meshes) {
+    if (!info->alive || info->reserved)
+      continue;
+
+    const size_t bytes = info->getSizeInBytes();
+    ++stats.mesh_count;
+    stats.reference_count += info->ref_count;
+    stats.resident_bytes += bytes;
+    stats.saved_bytes += bytes * (info->ref_count - 1);
+    stats.cpu_bytes += info->staging || !info->cpu_vertices.empty() ? bytes : 0;
+  }
+
+  return stats;
+}
+
+Mesh::Handle MeshManager::reserve(Mesh::Handle placeholder) {
+  std::unique_ptr<MeshInfo> info = createInfo();
+  info->fallback = placeholder;
+  info->residency = default_residency;
+  info->reserved = true;
+
+  Mesh::Handle handle = static_cast<Mesh::Handle>(meshes.size());
+  meshes.push_back(std::move(info));
+  return handle;
+}
+
+Mesh::Handle MeshManager::update(Mesh::Handle handle, Mesh &mesh) {
+  return update(handle, Mesh(mesh));
+}
+
+Mesh::Handle MeshManager::update(Mesh::Handle handle, Mesh &&mesh) {
+  MeshInfo &info = get(handle);
+  if (info.reserved)
+    return updateReserved(handle, std::move(mesh));
+
+  /* the other holders keep what they were given */
+  if (info.ref_count > 1) {
+    --info.ref_count;
+    return addMesh(std::move(mesh));
+  }
+
+  Hash::Hash128 hash = hashMeshData(mesh);
+  if (Mesh::Handle shared = acquireShared(hash); shared != Mesh::InvalidHandle) {
+    if (shared != handle) {
+      release(handle);
+      return shared;
+    }
+    --info.ref_count; /* same contents, uploaded again all the same */
+  }
+
+  /* new contents, other addMesh calls must not share the previous ones anymore */
+  if (auto it = unique_meshes.find(info.content_hash); it != unique_meshes.end() && it->second == handle)
+    unique_meshes.erase(it);
+
+  /* the previous GPU copy stays in use until uploadPending replaces it */
+  assignMeshData(info, std::move(mesh));
+  info.content_hash = hash;
+  info.gpu_uploaded = false;
+  ++info.revision;
+  unique_meshes.emplace(hash, handle);
+  return handle;
+}
+
+/* Reservations hand their handle out before the data exists, it stays and points at a shared mesh instead */
+Mesh::Handle MeshManager::updateReserved(Mesh::Handle handle, Mesh &&mesh) {
+  MeshInfo &info = get(handle);
+  Hash::Hash128 hash = hashMeshData(mesh);
+  Mesh::Handle shared = acquireShared(hash);
+
+  /* reloaded without changes */
+  if (shared != Mesh::InvalidHandle && shared == info.alias) {
+    --get(shared).ref_count;
+    return handle;
+  }
+
+  if (shared == Mesh::InvalidHandle) {
+    shared = insertMesh(hash, std::move(mesh));
+
+    /* whatever the reservation draws now stays until the new data is on the GPU */
+    MeshInfo &data = get(shared);
+    const Mesh::Handle drawn = resolve(handle);
+    data.fallback = drawn != handle ? drawn : Mesh::InvalidHandle;
+    data.replaces = std::exchange(info.alias, Mesh::InvalidHandle);
+    data.residency = info.residency;
+  }
+
+  if (info.alias != Mesh::InvalidHandle)
+    release(info.alias);
+
+  info.alias = shared;
+  return handle;
+}
+
+bool MeshManager::reupload(Mesh::Handle handle) {
+  MeshInfo &info = get(getDataHandle(handle));
+  if (!info.hasCPUData())
+    return false;
+
+  info.gpu_uploaded = false;
+  return true;
+}
+
+/* Writes vertices and indices to a temporary file and maps it back, the file itself is unlinked right away */
+static File::MappedFile mapToFile(std::span<const Mesh::Vertex> vertices, std::span<const Mesh::Index> indices,
+                                  uint64_t name) {
+  static std::atomic<uint64_t> counter = 0;
+
+  std::error_code error;
+  File::Path path = std::filesystem::temp_directory_path(error) /
+                    std::format("engine-mesh-{:016x}-{}.bin", name, counter++);
+  if (error)
+    return {};
+
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char *>(vertices.data()), vertices.size_bytes());
+    ofs.write(reinterpret_cast<const char *>(indices.data()), indices.size_bytes());
+    if (!ofs) {
+      std::filesystem::remove(path, error);
+      return {};
+    }
+  }
+
+  File::MappedFile mapping;
+  bool mapped = mapping.open(path);
+  std::filesystem::remove(path, error);
+
+  return mapped ? std::move(mapping) : File::MappedFile {};
+}
+
+/* The CPU copy stays in use until finishMappings swaps the mapping in, update and release wait for the write */
+void MeshManager::writeMapping(MeshInfo &info) {
+  if (!mapping_writer)
+    mapping_writer = std::make_unique<ThreadPool>(1);
+
+  auto promise = std::make_shared<std::promise<File::MappedFile>>();
+  info.mapping = promise->get_future();
+  mapping_writes.push_back(&info);
+
+  mapping_writer->enqueue([promise, vertices = info.getVertices(), indices = info.getIndices(),
+                           name = info.content_hash.low] {
+    promise->set_value(mapToFile(vertices, indices, name));
+  });
+}
+
+void MeshManager::finishMappings() {
+  std::erase_if(mapping_writes, [](MeshInfo *info) {
+    if (!info->mapping.valid())
+      return true;
+    if (info->mapping.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      return false;
+
+    File::MappedFile mapping = info->mapping.get();
+    if (!mapping.isOpen() || mapping.size() != info->getSizeInBytes()) {
+      LOG_WARN("[MeshManager]: Unable to map mesh data to a file, keeping it in memory");
+      return true;
+    }
+
+    info->mapped_data = std::move(mapping);
+    info->cpu_vertices = {};
+    info->cpu_indices = {};
+    info->staging.reset();
+    return true;
+  });
+}
+
+uint32_t MeshManager::selectLOD(Mesh::Handle handle, const glm::mat4 &model, const LODSelection &selection) {
+  MeshInfo &info = get(handle);
+  if (info.lods.size() < 2 || info.bounds.radius <= 0.0f)
+    return 0;
+
+  /* errors are in object space, they grow with the model's scale like the sphere does */
+  const glm::vec4 sphere = getWorldSphere(info.bounds, model);
+  const float scale = sphere.w / info.bounds.radius;
+
+  /* measured to the bounding sphere, so large meshes do not coarsen while the camera is close to their surface */
+  const float distance = std::max(glm::distance(selection.camera_position, glm::vec3(sphere)) - sphere.w, 0.0f);
+
+  return Mesh::selectLOD(info.lods, distance, selection.projection_scale * scale, selection.max_pixel_error);
+}
+
+glm::vec4 MeshManager::getWorldSphere(const Mesh::Bounds &bounds, const glm::mat4 &model) {
+  /* the largest axis scale keeps the sphere conservative under non-uniform scaling */
+  const float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                                 glm::length(glm::vec3(model[2])) });
+  return glm::vec4(glm::vec3(model * glm::vec4(bounds.center, 1.0f)), bounds.radius * scale);
+}
+
+void MeshManager::markUploaded(MeshInfo &info) {
+  info.gpu_uploaded = true;
+  info.fallback = Mesh::InvalidHandle;
+
+  /* the data it took over from is not drawn anymore */
+  if (info.replaces != Mesh::InvalidHandle)
+    release(std::exchange(info.replaces, Mesh::InvalidHandle));
+
+  switch (info.residency) {
+  case MeshInfo::Residency::Release:
+    info.cpu_vertices = {};
+    info.cpu_indices = {};
+    info.staging.reset();
+    info.mapped_data.close();
+    break;
+  case MeshInfo::Residency::Keep:
+    break;
+  case MeshInfo::Residency::Mapped:
+    if (!info.mapped_data.isOpen() && !info.mapping.valid())
+      writeMapping(info);
+    break;
+  }
+}
+
 } // namespace Engine
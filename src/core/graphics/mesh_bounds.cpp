@@ -0,0 +1,93 @@
+#include <core/graphics/mesh.hpp>
+#include <util/simd.hpp>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+/*
+ * Box first, one vertex per vector op (the fourth lane reads the next attribute and is ignored),
+ * then the radius around the box center four vertices at a time.
+ */
+template <typename Position>
+static Mesh::Bounds reduceBounds(size_t count, Position position) {
+  using SIMD::Float4;
+
+  if (count == 0)
+    return Mesh::Bounds {};
+
+  /* two accumulators so consecutive min/max do not wait on each other */
+  Float4 lo[2] = { Float4(std::numeric_limits<float>::max()), Float4(std::numeric_limits<float>::max()) };
+  Float4 hi[2] = { Float4(std::numeric_limits<float>::lowest()), Float4(std::numeric_limits<float>::lowest()) };
+
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    Float4 a = Float4::load(&position(i).x);
+    Float4 b = Float4::load(&position(i + 1).x);
+    lo[0] = min(lo[0], a);
+    hi[0] = max(hi[0], a);
+    lo[1] = min(lo[1], b);
+    hi[1] = max(hi[1], b);
+  }
+  if (i < count) {
+    Float4 a = Float4::load(&position(i).x);
+    lo[0] = min(lo[0], a);
+    hi[0] = max(hi[0], a);
+  }
+
+  Float4 box_min = min(lo[0], lo[1]);
+  Float4 box_max = max(hi[0], hi[1]);
+
+  Mesh::Bounds bounds;
+  bounds.min = glm::vec3(box_min[0], box_min[1], box_min[2]);
+  bounds.max = glm::vec3(box_max[0], box_max[1], box_max[2]);
+  bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+  const SIMD::Vec3x4 center { Float4(bounds.center.x), Float4(bounds.center.y), Float4(bounds.center.z) };
+  Float4 max_distance(0.0f);
+
+  for (i = 0; i < count; i += 4) {
+    /* the tail repeats the last vertex, which cannot change the maximum */
+    const glm::vec3 &p0 = position(i);
+    const glm::vec3 &p1 = position(std::min(i + 1, count - 1));
+    const glm::vec3 &p2 = position(std::min(i + 2, count - 1));
+    const glm::vec3 &p3 = position(std::min(i + 3, count - 1));
+
+    SIMD::Vec3x4 p {
+      Float4(p0.x, p1.x, p2.x, p3.x),
+      Float4(p0.y, p1.y, p2.y, p3.y),
+      Float4(p0.z, p1.z, p2.z, p3.z),
+    };
+    SIMD::Vec3x4 d = p - center;
+    max_distance = max(max_distance, dot(d, d));
+  }
+
+  bounds.radius = std::sqrt(std::max({ max_distance[0], max_distance[1], max_distance[2], max_distance[3] }));
+  return bounds;
+}
+
+Mesh::Bounds Mesh::computeBounds(std::span<const Vertex> vertices) {
+  return reduceBounds(vertices.size(), [vertices](size_t i) -> const glm::vec3 & {
+    return vertices[i].position;
+  });
+}
+
+Mesh::Bounds Mesh::computeBounds(std::span<const Vertex> vertices, std::span<const Index> indices) {
+  return reduceBounds(indices.size(), [vertices, indices](size_t i) -> const glm::vec3 & {
+    return vertices[indices[i]].position;
+  });
+}
+
+void Mesh::updateBounds() {
+  std::span<const Vertex> vertex_data = getVerticesView();
+  std::span<const Index> index_data = getIndicesView();
+
+  bounds = computeBounds(vertex_data);
+  for (LOD &lod : lods)
+    lod.bounds = computeBounds(vertex_data, index_data.subspan(lod.range.first_index, lod.range.index_count));
+}
+
+} /* namespace Engine */
@@ -0,0 +1,179 @@
+#include <core/graphics/mesh.hpp>
+#include <core/graphics/mesh_codec.hpp>
+#include <core/assets/vfs.hpp>
+#include <core/logging.hpp>
+
+#include <span>
+#include <vector>
+#include <cstring>
+#include <fstream>
+
+namespace Engine {
+
+/*
+ * Cooked mesh layout, little endian, no padding between sections:
+ *   CookedMeshHeader (including the mesh bounds)
+ *   vertex stream [vertex_stream_size]  MeshCodec::encodeVertices
+ *   index stream  [index_stream_size]   MeshCodec::encodeIndices
+ *   Mesh::LOD     [lod_count]
+ *   Mesh::Meshlet [meshlet_count]
+ */
+struct CookedMeshHeader {
+  static constexpr uint32_t MAGIC   = 0x48534D45; /* "EMSH" */
+  static constexpr uint32_t VERSION = Mesh::COOKED_VERSION;
+
+  uint32_t magic = MAGIC;
+  uint32_t version = VERSION;
+  uint32_t vertex_count = 0;
+  uint32_t index_count = 0;
+  uint32_t lod_count = 0;
+  uint32_t meshlet_count = 0;
+  uint32_t vertex_stream_size = 0;
+  uint32_t index_stream_size = 0;
+  Mesh::Bounds bounds {};
+};
+
+template <typename T>
+static void writeSection(std::ofstream &ofs, std::span<const T> data) {
+  ofs.write(reinterpret_cast<const char *>(data.data()), data.size_bytes());
+}
+
+/* copies a raw table out of the payload */
+template <typename T>
+static const uint8_t *readTable(const uint8_t *in, std::vector<T> &out, size_t count) {
+  out.resize(count);
+  std::memcpy(out.data(), in, count * sizeof(T));
+  return in + count * sizeof(T);
+}
+
+bool Mesh::writeCooked(File::Path path) const {
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  if (!ofs) {
+    LOG_ERROR("[Mesh]: Failed to open `{}` for writing", path.string());
+    return false;
+  }
+
+  std::span<const Vertex> vertex_data = staging ? staging->getVertices() : std::span<const Vertex>{ vertices };
+  std::span<const Index> index_data = staging ? staging->getIndices() : std::span<const Index>{ indices };
+
+  std::vector<uint8_t> vertex_stream = MeshCodec::encodeVertices(vertex_data.data(), vertex_data.size(), sizeof(Vertex));
+  std::vector<uint8_t> index_stream = MeshCodec::encodeIndices(index_data);
+  if (vertex_stream.empty() || index_stream.empty()) {
+    LOG_ERROR("[Mesh]: Failed to encode `{}`", path.string());
+    return false;
+  }
+
+  CookedMeshHeader header {
+    .vertex_count       = static_cast<uint32_t>(vertex_data.size()),
+    .index_count        = static_cast<uint32_t>(index_data.size()),
+    .lod_count          = static_cast<uint32_t>(lods.size()),
+    .meshlet_count      = static_cast<uint32_t>(meshlets.size()),
+    .vertex_stream_size = static_cast<uint32_t>(vertex_stream.size()),
+    .index_stream_size  = static_cast<uint32_t>(index_stream.size()),
+    .bounds             = bounds,
+  };
+
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  writeSection(ofs, std::span<const uint8_t>{ vertex_stream });
+  writeSection(ofs, std::span<const uint8_t>{ index_stream });
+  writeSection(ofs, std::span<const LOD>{ lods });
+  writeSection(ofs, std::span<const Meshlet>{ meshlets });
+
+  return static_cast<bool>(ofs);
+}
+
+std::optional<Mesh> Mesh::fromCooked(File::Path path, const StagingAllocator &allocator) {
+  /* decoded straight out of the page cache or the pack mapping, walked front to back once */
+  File::Data file;
+  if (!File::load(path, file, File::MappedFile::Access::Sequential))
+    return std::nullopt;
+
+  return fromCooked(file.view(), path.string(), allocator);
+}
+
+std::optional<Mesh> Mesh::fromCooked(std::span<const char> data, std::string_view name, const StagingAllocator &allocator) {
+  CookedMeshHeader header;
+  if (data.size() < sizeof(header)) {
+    LOG_ERROR("[Mesh]: `{}` is not a cooked mesh", name);
+    return std::nullopt;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  if (header.magic != CookedMeshHeader::MAGIC || header.version != CookedMeshHeader::VERSION) {
+    LOG_ERROR("[Mesh]: `{}` has an unsupported cooked mesh version", name);
+    return std::nullopt;
+  }
+
+  /* refuse sizes the file does not match before allocating for them */
+  const uintmax_t payload_size = uintmax_t(header.vertex_stream_size) +
+                                 uintmax_t(header.index_stream_size) +
+                                 uintmax_t(header.lod_count) * sizeof(LOD) +
+                                 uintmax_t(header.meshlet_count) * sizeof(Meshlet);
+  if (data.size() != sizeof(header) + payload_size) {
+    LOG_ERROR("[Mesh]: `{}` is truncated", name);
+    return std::nullopt;
+  }
+
+  /* nor counts the streams cannot hold */
+  if (header.vertex_count > MeshCodec::maxVertexCount(header.vertex_stream_size, sizeof(Vertex)) ||
+      header.index_count > MeshCodec::maxIndexCount(header.index_stream_size) || header.index_count % 3 != 0) {
+    LOG_ERROR("[Mesh]: `{}` declares more vertices or indices than its streams hold", name);
+    return std::nullopt;
+  }
+
+  const uint8_t *in = reinterpret_cast<const uint8_t *>(data.data()) + sizeof(header);
+  std::span<const uint8_t> vertex_stream { in, header.vertex_stream_size };
+  std::span<const uint8_t> index_stream { in + header.vertex_stream_size, header.index_stream_size };
+  in += header.vertex_stream_size + header.index_stream_size;
+
+  Mesh mesh;
+  in = readTable(in, mesh.lods, header.lod_count);
+  in = readTable(in, mesh.meshlets, header.meshlet_count);
+
+  /* levels and meshlets are drawn as index ranges straight from the tables */
+  auto inIndices = [&header](const IndexRange &range) {
+    return uint64_t(range.first_index) + range.index_count <= header.index_count;
+  };
+
+  for (const LOD &lod : mesh.lods) {
+    if (!inIndices(lod.range)) {
+      LOG_ERROR("[Mesh]: `{}` has a level outside of its {} indices", name, header.index_count);
+      return std::nullopt;
+    }
+  }
+
+  for (const Meshlet &meshlet : mesh.meshlets) {
+    if (!inIndices(meshlet.range) || meshlet.vertex_count > header.vertex_count) {
+      LOG_ERROR("[Mesh]: `{}` has a meshlet outside of its {} indices and {} vertices", name,
+                header.index_count, header.vertex_count);
+      return std::nullopt;
+    }
+  }
+
+  mesh.allocate(header.vertex_count, header.index_count, allocator);
+
+  std::span<Vertex> vertex_data = mesh.getVerticesView();
+  if (!MeshCodec::decodeVertices(vertex_data.data(), vertex_data.size(), sizeof(Vertex), vertex_stream) ||
+      !MeshCodec::decodeIndices(mesh.getIndicesView(), index_stream)) {
+    LOG_ERROR("[Mesh]: `{}` has corrupt vertex or index data", name);
+    return std::nullopt;
+  }
+
+  for (Index index : mesh.getIndicesView()) {
+    if (index >= header.vertex_count) {
+      LOG_ERROR("[Mesh]: `{}` references vertex {} out of {}", name, index, header.vertex_count);
+      return std::nullopt;
+    }
+  }
+
+  /* bounds are cooked, only files without a LOD table need them computed */
+  mesh.bounds = header.bounds;
+  if (mesh.lods.empty()) {
+    mesh.lods.push_back(LOD{ .range = { 0, header.index_count }, .error = 0.0f });
+    mesh.updateBounds();
+  }
+
+  return mesh;
+}
+
+} /* namespace Engine */
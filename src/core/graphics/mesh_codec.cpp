@@ -0,0 +1,510 @@
+#include <core/graphics/mesh_codec.hpp>
+#include <util/simd.hpp>
+
+#include <array>
+#include <cstring>
+#include <algorithm>
+
+namespace Engine::MeshCodec {
+
+static constexpr uint8_t VERTEX_HEADER = 0xA1;
+static constexpr uint8_t INDEX_HEADER  = 0xE1;
+
+static constexpr size_t BLOCK_VERTICES = 256;
+static constexpr size_t GROUP_SIZE     = 16;
+
+/* bytes of packed payload for a group, by its 2-bit width code: 0, 2, 4 or 8 bits per value */
+static constexpr size_t GROUP_BYTES[4] = { 0, 4, 8, 16 };
+
+static inline uint8_t zigzag8(uint8_t delta) {
+  return static_cast<uint8_t>((delta << 1) ^ static_cast<uint8_t>(static_cast<int8_t>(delta) >> 7));
+}
+
+static inline uint8_t unzigzag8(uint8_t value) {
+  return static_cast<uint8_t>((value >> 1) ^ -(value & 1));
+}
+
+/*
+ * Vertex stream, after the header byte, per block of up to BLOCK_VERTICES vertices and per byte of the vertex:
+ *   2-bit width codes of every group of 16 deltas, four per byte, lowest bits first
+ *   packed groups: 2-bit values four per byte / 4-bit values two per byte, first value in the high bits
+ * Deltas are taken from the same byte of the previous vertex, the first vertex is relative to zero.
+ */
+std::vector<uint8_t> encodeVertices(const void *vertices, size_t vertex_count, size_t vertex_size) {
+  if (vertex_size == 0 || vertex_size % 4 != 0 || vertex_size > MAX_VERTEX_SIZE)
+    return {};
+
+  const uint8_t *data = static_cast<const uint8_t *>(vertices);
+
+  std::vector<uint8_t> out;
+  out.reserve(1 + vertex_count * vertex_size / 2);
+  out.push_back(VERTEX_HEADER);
+
+  std::array<uint8_t, MAX_VERTEX_SIZE> last {};
+  std::array<uint8_t, BLOCK_VERTICES> deltas;
+
+  for (size_t begin = 0; begin < vertex_count; begin += BLOCK_VERTICES) {
+    const size_t count = std::min(BLOCK_VERTICES, vertex_count - begin);
+    const size_t groups = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+
+    for (size_t k = 0; k < vertex_size; ++k) {
+      uint8_t previous = last[k];
+      for (size_t i = 0; i < count; ++i) {
+        uint8_t byte = data[(begin + i) * vertex_size + k];
+        deltas[i] = zigzag8(static_cast<uint8_t>(byte - previous));
+        previous = byte;
+      }
+      std::fill(deltas.begin() + count, deltas.begin() + groups * GROUP_SIZE, uint8_t(0));
+      last[k] = previous;
+
+      const size_t header = out.size();
+      out.resize(out.size() + (groups + 3) / 4, 0);
+
+      for (size_t g = 0; g < groups; ++g) {
+        const uint8_t *values = &deltas[g * GROUP_SIZE];
+        const uint8_t largest = *std::max_element(values, values + GROUP_SIZE);
+        const uint8_t code = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2 : 3;
+        out[header + g / 4] |= static_cast<uint8_t>(code << ((g % 4) * 2));
+
+        switch (code) {
+        case 1:
+          for (size_t i = 0; i < GROUP_SIZE; i += 4)
+            out.push_back(static_cast<uint8_t>(values[i] << 6 | values[i + 1] << 4 | values[i + 2] << 2 | values[i + 3]));
+          break;
+        case 2:
+          for (size_t i = 0; i < GROUP_SIZE; i += 2)
+            out.push_back(static_cast<uint8_t>(values[i] << 4 | values[i + 1]));
+          break;
+        case 3:
+          out.insert(out.end(), values, values + GROUP_SIZE);
+          break;
+        }
+      }
+    }
+  }
+
+  return out;
+}
+
+/* Unpacks one group of 16 zigzagged deltas */
+static inline void unpackGroup(const uint8_t *in, uint8_t code, uint8_t *out) {
+#if SIMD_SSE2
+  __m128i values;
+  switch (code) {
+  case 0:
+    values = _mm_setzero_si128();
+    break;
+  case 1: {
+    int32_t packed;
+    std::memcpy(&packed, in, sizeof(packed));
+    const __m128i x = _mm_cvtsi32_si128(packed);
+    const __m128i mask = _mm_set1_epi8(3);
+    const __m128i a = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+    const __m128i b = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+    const __m128i c = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+    const __m128i d = _mm_and_si128(x, mask);
+    values = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a, b), _mm_unpacklo_epi8(c, d));
+    break;
+  }
+  case 2: {
+    const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in));
+    const __m128i mask = _mm_set1_epi8(15);
+    values = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(x, 4), mask), _mm_and_si128(x, mask));
+    break;
+  }
+  default:
+    values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    break;
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), values);
+#else
+  switch (code) {
+  case 0:
+    std::memset(out, 0, GROUP_SIZE);
+    break;
+  case 1:
+    for (size_t i = 0; i < GROUP_SIZE; ++i)
+      out[i] = (in[i / 4] >> (6 - (i % 4) * 2)) & 3;
+    break;
+  case 2:
+    for (size_t i = 0; i < GROUP_SIZE; ++i)
+      out[i] = (in[i / 2] >> (i % 2 ? 0 : 4)) & 15;
+    break;
+  default:
+    std::memcpy(out, in, GROUP_SIZE);
+    break;
+  }
+#endif
+}
+
+/* Zigzag decode and running sum over `groups` groups in place, starting from `previous` */
+static inline void integrate(uint8_t *values, size_t groups, uint8_t previous) {
+#if SIMD_SSE2
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i low_bits = _mm_set1_epi8(0x7f);
+  __m128i carry = _mm_set1_epi8(static_cast<char>(previous));
+
+  for (size_t g = 0; g < groups; ++g) {
+    __m128i *group = reinterpret_cast<__m128i *>(values + g * GROUP_SIZE);
+    __m128i z = _mm_loadu_si128(group);
+    __m128i x = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(z, 1), low_bits),
+                              _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(z, one)));
+
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi8(x, carry);
+    _mm_storeu_si128(group, x);
+
+    /* broadcast the last byte */
+    carry = _mm_unpackhi_epi8(x, x);
+    carry = _mm_unpackhi_epi16(carry, carry);
+    carry = _mm_shuffle_epi32(carry, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+#else
+  for (size_t i = 0; i < groups * GROUP_SIZE; ++i) {
+    previous = static_cast<uint8_t>(previous + unzigzag8(values[i]));
+    values[i] = previous;
+  }
+#endif
+}
+
+/* Interleaves byte lanes k..k+3 back into vertices, `lanes` rows are BLOCK_VERTICES long */
+static inline void transpose(const uint8_t *lanes, size_t k, size_t count, uint8_t *out, size_t vertex_size) {
+  const uint8_t *l0 = lanes + (k + 0) * BLOCK_VERTICES;
+  const uint8_t *l1 = lanes + (k + 1) * BLOCK_VERTICES;
+  const uint8_t *l2 = lanes + (k + 2) * BLOCK_VERTICES;
+  const uint8_t *l3 = lanes + (k + 3) * BLOCK_VERTICES;
+
+  size_t i = 0;
+#if SIMD_SSE2
+  for (; i + GROUP_SIZE <= count; i += GROUP_SIZE) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l0 + i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l1 + i));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l2 + i));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l3 + i));
+
+    const __m128i ab_lo = _mm_unpacklo_epi8(a, b);
+    const __m128i ab_hi = _mm_unpackhi_epi8(a, b);
+    const __m128i cd_lo = _mm_unpacklo_epi8(c, d);
+    const __m128i cd_hi = _mm_unpackhi_epi8(c, d);
+
+    __m128i words[4] = {
+      _mm_unpacklo_epi16(ab_lo, cd_lo),
+      _mm_unpackhi_epi16(ab_lo, cd_lo),
+      _mm_unpacklo_epi16(ab_hi, cd_hi),
+      _mm_unpackhi_epi16(ab_hi, cd_hi),
+    };
+
+    uint8_t *target = out + i * vertex_size + k;
+    for (__m128i &w : words) {
+      for (int j = 0; j < 4; ++j) {
+        const int32_t word = _mm_cvtsi128_si32(w);
+        std::memcpy(target, &word, sizeof(word));
+        target += vertex_size;
+        w = _mm_srli_si128(w, 4);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    uint8_t *target = out + i * vertex_size + k;
+    target[0] = l0[i];
+    target[1] = l1[i];
+    target[2] = l2[i];
+    target[3] = l3[i];
+  }
+}
+
+bool decodeVertices(void *vertices, size_t vertex_count, size_t vertex_size, std::span<const uint8_t> encoded) {
+  if (vertex_size == 0 || vertex_size % 4 != 0 || vertex_size > MAX_VERTEX_SIZE)
+    return false;
+  if (encoded.empty() || encoded[0] != VERTEX_HEADER)
+    return false;
+
+  const uint8_t *in = encoded.data() + 1;
+  const uint8_t *end = encoded.data() + encoded.size();
+  uint8_t *out = static_cast<uint8_t *>(vertices);
+
+  std::array<uint8_t, MAX_VERTEX_SIZE> last {};
+  std::vector<uint8_t> lanes(vertex_size * BLOCK_VERTICES);
+
+  for (size_t begin = 0; begin < vertex_count; begin += BLOCK_VERTICES) {
+    const size_t count = std::min(BLOCK_VERTICES, vertex_count - begin);
+    const size_t groups = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+    const size_t header_size = (groups + 3) / 4;
+
+    for (size_t k = 0; k < vertex_size; ++k) {
+      if (static_cast<size_t>(end - in) < header_size)
+        return false;
+
+      const uint8_t *header = in;
+      in += header_size;
+
+      uint8_t *lane = &lanes[k * BLOCK_VERTICES];
+      for (size_t g = 0; g < groups; ++g) {
+        const uint8_t code = (header[g / 4] >> ((g % 4) * 2)) & 3;
+        if (static_cast<size_t>(end - in) < GROUP_BYTES[code])
+          return false;
+
+        unpackGroup(in, code, lane + g * GROUP_SIZE);
+        in += GROUP_BYTES[code];
+      }
+
+      integrate(lane, groups, last[k]);
+      last[k] = lane[count - 1];
+    }
+
+    for (size_t k = 0; k < vertex_size; k += 4)
+      transpose(lanes.data(), k, count, out + begin * vertex_size, vertex_size);
+  }
+
+  return in == end;
+}
+
+/*
+ * Index stream, after the header byte, per triangle:
+ *   edge hit:  [edge << 4 | third]                             triangle continues edge `edge` of the FIFO
+ *   otherwise: [0xF0 | first] [second << 4 | third]
+ * Vertex codes: 0 = next unseen vertex, 1..14 = vertex FIFO entry, 15 = zigzag LEB128 delta to the last explicit vertex.
+ * Explicit deltas follow the code bytes in vertex order.
+ */
+static constexpr uint32_t INVALID = ~0u;
+static constexpr uint8_t EDGE_MISS = 15;
+static constexpr uint8_t VERTEX_EXPLICIT = 15;
+
+struct EdgeFIFO {
+  std::array<uint32_t, 16> a, b;
+  size_t offset = 0;
+
+  EdgeFIFO() { a.fill(INVALID); b.fill(INVALID); }
+
+  inline void push(uint32_t x, uint32_t y) {
+    a[offset] = x;
+    b[offset] = y;
+    offset = (offset + 1) & 15;
+  }
+
+  /* 0 is the most recent edge */
+  inline int find(uint32_t x, uint32_t y) const {
+    for (int i = 0; i < EDGE_MISS; ++i) {
+      size_t slot = (offset - 1 - i) & 15;
+      if (a[slot] == x && b[slot] == y)
+        return i;
+    }
+    return -1;
+  }
+
+  inline void get(int i, uint32_t &x, uint32_t &y) const {
+    size_t slot = (offset - 1 - i) & 15;
+    x = a[slot];
+    y = b[slot];
+  }
+};
+
+struct VertexFIFO {
+  std::array<uint32_t, 16> entries;
+  size_t offset = 0;
+
+  VertexFIFO() { entries.fill(INVALID); }
+
+  inline void push(uint32_t v) {
+    entries[offset] = v;
+    offset = (offset + 1) & 15;
+  }
+
+  inline int find(uint32_t v) const {
+    for (int i = 0; i < VERTEX_EXPLICIT - 1; ++i)
+      if (entries[(offset - 1 - i) & 15] == v)
+        return i;
+    return -1;
+  }
+
+  inline uint32_t get(int i) const { return entries[(offset - 1 - i) & 15]; }
+};
+
+/* Coder state shared by both directions, so they update it identically */
+struct IndexState {
+  EdgeFIFO edges;
+  VertexFIFO vertices;
+  uint32_t next = 0;
+  uint32_t last = 0;
+};
+
+static void writeVarint(std::vector<uint8_t> &out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool readVarint(const uint8_t *&in, const uint8_t *end, uint32_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (in == end)
+      return false;
+    uint8_t byte = *in++;
+    value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/* Picks the code for `v` and advances the state, explicit deltas are collected in order */
+static uint8_t encodeVertex(IndexState &state, uint32_t v, std::array<uint32_t, 3> &explicit_values, size_t &explicit_count) {
+  if (v == state.next) {
+    ++state.next;
+    state.vertices.push(v);
+    return 0;
+  }
+
+  if (int hit = state.vertices.find(v); hit >= 0)
+    return static_cast<uint8_t>(hit + 1);
+
+  const int32_t delta = static_cast<int32_t>(v - state.last);
+  explicit_values[explicit_count++] = static_cast<uint32_t>((delta << 1) ^ (delta >> 31));
+  state.last = v;
+  state.vertices.push(v);
+  return VERTEX_EXPLICIT;
+}
+
+static bool decodeVertex(IndexState &state, uint8_t code, const uint8_t *&in, const uint8_t *end, uint32_t &v) {
+  if (code == 0) {
+    v = state.next++;
+    state.vertices.push(v);
+    return true;
+  }
+
+  if (code != VERTEX_EXPLICIT) {
+    v = state.vertices.get(code - 1);
+    return v != INVALID;
+  }
+
+  uint32_t zigzag;
+  if (!readVarint(in, end, zigzag))
+    return false;
+
+  v = state.last + ((zigzag >> 1) ^ -(zigzag & 1));
+  state.last = v;
+  state.vertices.push(v);
+  return true;
+}
+
+std::vector<uint8_t> encodeIndices(std::span<const uint32_t> indices) {
+  if (indices.size() % 3 != 0)
+    return {};
+
+  std::vector<uint8_t> out;
+  out.reserve(1 + indices.size());
+  out.push_back(INDEX_HEADER);
+
+  IndexState state;
+  std::array<uint32_t, 3> explicit_values;
+
+  for (size_t t = 0; t < indices.size(); t += 3) {
+    const uint32_t tri[3] = { indices[t], indices[t + 1], indices[t + 2] };
+    size_t explicit_count = 0;
+
+    /* a rotation whose first edge was shared by a recent triangle */
+    int edge = -1;
+    int rotation = 0;
+    for (; rotation < 3; ++rotation)
+      if ((edge = state.edges.find(tri[rotation], tri[(rotation + 1) % 3])) >= 0)
+        break;
+
+    if (edge >= 0) {
+      const uint32_t a = tri[rotation], b = tri[(rotation + 1) % 3], c = tri[(rotation + 2) % 3];
+      const uint8_t code = encodeVertex(state, c, explicit_values, explicit_count);
+      out.push_back(static_cast<uint8_t>(edge << 4 | code));
+
+      state.edges.push(c, b);
+      state.edges.push(a, c);
+    }
+    else {
+      const uint8_t code_a = encodeVertex(state, tri[0], explicit_values, explicit_count);
+      const uint8_t code_b = encodeVertex(state, tri[1], explicit_values, explicit_count);
+      const uint8_t code_c = encodeVertex(state, tri[2], explicit_values, explicit_count);
+      out.push_back(static_cast<uint8_t>(EDGE_MISS << 4 | code_a));
+      out.push_back(static_cast<uint8_t>(code_b << 4 | code_c));
+
+      state.edges.push(tri[1], tri[0]);
+      state.edges.push(tri[2], tri[1]);
+      state.edges.push(tri[0], tri[2]);
+    }
+
+    for (size_t i = 0; i < explicit_count; ++i)
+      writeVarint(out, explicit_values[i]);
+  }
+
+  return out;
+}
+
+bool decodeIndices(std::span<uint32_t> indices, std::span<const uint8_t> encoded) {
+  if (indices.size() % 3 != 0 || encoded.empty() || encoded[0] != INDEX_HEADER)
+    return false;
+
+  const uint8_t *in = encoded.data() + 1;
+  const uint8_t *end = encoded.data() + encoded.size();
+
+  IndexState state;
+  std::array<uint8_t, 3> codes;
+
+  for (size_t t = 0; t < indices.size(); t += 3) {
+    if (in == end)
+      return false;
+
+    const uint8_t code = *in++;
+    const uint8_t edge = code >> 4;
+    uint32_t a, b, c;
+
+    if (edge != EDGE_MISS) {
+      state.edges.get(edge, a, b);
+      if (a == INVALID || !decodeVertex(state, code & 15, in, end, c))
+        return false;
+
+      state.edges.push(c, b);
+      state.edges.push(a, c);
+    }
+    else {
+      if (in == end)
+        return false;
+
+      codes = { static_cast<uint8_t>(code & 15), static_cast<uint8_t>(*in >> 4), static_cast<uint8_t>(*in & 15) };
+      ++in;
+
+      /* explicit deltas follow all code bytes, so the codes are resolved in order after reading them */
+      if (!decodeVertex(state, codes[0], in, end, a) ||
+          !decodeVertex(state, codes[1], in, end, b) ||
+          !decodeVertex(state, codes[2], in, end, c))
+        return false;
+
+      state.edges.push(b, a);
+      state.edges.push(c, b);
+      state.edges.push(a, c);
+    }
+
+    indices[t] = a;
+    indices[t + 1] = b;
+    indices[t + 2] = c;
+  }
+
+  return in == end;
+}
+
+size_t maxVertexCount(size_t encoded_size, size_t vertex_size) {
+  if (encoded_size == 0 || vertex_size == 0)
+    return 0;
+
+  /* every block takes at least one byte of width codes per byte of the vertex, groups of zero deltas take nothing */
+  return (encoded_size - 1) / vertex_size * BLOCK_VERTICES;
+}
+
+size_t maxIndexCount(size_t encoded_size) {
+  /* every triangle takes at least its code byte */
+  return encoded_size == 0 ? 0 : (encoded_size - 1) * 3;
+}
+
+} /* namespace Engine::MeshCodec */
@@ -0,0 +1,208 @@
+#include <core/graphics/mesh.hpp>
+#include <core/logging.hpp>
+#include <core/assets/vfs.hpp>
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <glm/glm.hpp>
+
+#include <tiny_gltf.h>
+
+namespace Engine {
+
+/* Bounds-checked view of an accessor's elements, nullptr for sparse or malformed accessors */
+static const unsigned char *accessorData(const tinygltf::Model &model, const tinygltf::Accessor &accessor, size_t &stride) {
+  if (accessor.bufferView < 0 || accessor.sparse.isSparse || static_cast<size_t>(accessor.bufferView) >= model.bufferViews.size())
+    return nullptr;
+
+  const tinygltf::BufferView &view = model.bufferViews[accessor.bufferView];
+  if (view.buffer < 0 || static_cast<size_t>(view.buffer) >= model.buffers.size())
+    return nullptr;
+
+  const int byte_stride = accessor.ByteStride(view);
+  if (byte_stride <= 0)
+    return nullptr;
+  stride = static_cast<size_t>(byte_stride);
+
+  const std::vector<unsigned char> &data = model.buffers[view.buffer].data;
+  const size_t offset = view.byteOffset + accessor.byteOffset;
+  const size_t element_size = static_cast<size_t>(tinygltf::GetComponentSizeInBytes(accessor.componentType)) *
+                              static_cast<size_t>(tinygltf::GetNumComponentsInType(accessor.type));
+
+  if (accessor.count > 0 && offset + stride * (accessor.count - 1) + element_size > data.size())
+    return nullptr;
+
+  return data.data() + offset;
+}
+
+/* Floats and normalized unsigned integers, which is what the spec allows for the attributes read here */
+static float readComponent(const unsigned char *p, int component_type) {
+  switch (component_type) {
+  case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+    float value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+    return p[0] / 255.0f;
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+    uint16_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value / 65535.0f;
+  }
+  }
+  return 0.0f;
+}
+
+/* Calls `fn(i, components)` for every element of the named attribute, false if it is missing or malformed */
+template <typename F>
+static bool forEachElement(const tinygltf::Model &model, const tinygltf::Primitive &primitive, const char *name, size_t count, F fn) {
+  auto it = primitive.attributes.find(name);
+  if (it == primitive.attributes.end() || it->second < 0 || static_cast<size_t>(it->second) >= model.accessors.size())
+    return false;
+
+  const tinygltf::Accessor &accessor = model.accessors[it->second];
+  size_t stride = 0;
+  const unsigned char *data = accessorData(model, accessor, stride);
+  if (!data || accessor.count != count)
+    return false;
+
+  const int components = tinygltf::GetNumComponentsInType(accessor.type);
+  const int component_size = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+  if (components <= 0 || component_size <= 0)
+    return false;
+
+  float values[4] {};
+  for (size_t i = 0; i < count; ++i) {
+    for (int c = 0; c < components && c < 4; ++c)
+      values[c] = readComponent(data + i * stride + c * component_size, accessor.componentType);
+    fn(i, values);
+  }
+  return true;
+}
+
+static bool readIndices(const tinygltf::Model &model, const tinygltf::Primitive &primitive, size_t vertex_count,
+                        Mesh::Index base, std::vector<Mesh::Index> &indices) {
+  if (primitive.indices < 0) {
+    for (size_t i = 0; i < vertex_count; ++i)
+      indices.push_back(base + static_cast<Mesh::Index>(i));
+    return true;
+  }
+
+  if (static_cast<size_t>(primitive.indices) >= model.accessors.size())
+    return false;
+
+  const tinygltf::Accessor &accessor = model.accessors[primitive.indices];
+  size_t stride = 0;
+  const unsigned char *data = accessorData(model, accessor, stride);
+  if (!data)
+    return false;
+
+  for (size_t i = 0; i < accessor.count; ++i) {
+    const unsigned char *p = data + i * stride;
+    uint32_t index = 0;
+
+    switch (accessor.componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      index = p[0];
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+      uint16_t value;
+      std::memcpy(&value, p, sizeof(value));
+      index = value;
+      break;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      std::memcpy(&index, p, sizeof(index));
+      break;
+    default:
+      return false;
+    }
+
+    if (index >= vertex_count)
+      return false;
+    indices.push_back(base + index);
+  }
+
+  return true;
+}
+
+std::optional<Mesh> Mesh::fromGLTF(File::Path path, const StagingAllocator &allocator, ThreadPool *pool) {
+  File::Data file;
+  std::optional<File::VFS::Location> location = File::locate(path);
+  if (!location || !File::load(path, file, File::MappedFile::Access::Sequential)) {
+    LOG_ERROR("[Mesh]: Failed to read `{}`", path.string());
+    return std::nullopt;
+  }
+
+  /* external buffers and images resolve next to loose files only, packed models have to be self-contained */
+  const std::string base_dir = location->packed ? std::string() : location->file.parent_path().string();
+
+  tinygltf::TinyGLTF loader;
+  tinygltf::Model model;
+  std::string error, warning;
+
+  const bool loaded = path.extension() == ".glb"
+    ? loader.LoadBinaryFromMemory(&model, &error, &warning, reinterpret_cast<const unsigned char *>(file.data()),
+                                  static_cast<unsigned int>(file.size()), base_dir)
+    : loader.LoadASCIIFromString(&model, &error, &warning, file.data(), static_cast<unsigned int>(file.size()), base_dir);
+
+  if (!loaded) {
+    LOG_ERROR("[Mesh]: Failed to load `{}`: {}", path.string(), error);
+    return std::nullopt;
+  }
+  if (!warning.empty())
+    LOG_WARN("[Mesh]: `{}`: {}", path.string(), warning);
+
+  std::vector<Vertex> vertices;
+  std::vector<Index> indices;
+  bool missing_normals = false;
+
+  for (const tinygltf::Mesh &gltf_mesh : model.meshes) {
+    for (const tinygltf::Primitive &primitive : gltf_mesh.primitives) {
+      /* -1 is an absent mode, which the spec defaults to triangles */
+      if (primitive.mode != TINYGLTF_MODE_TRIANGLES && primitive.mode != -1)
+        continue;
+
+      auto position = primitive.attributes.find("POSITION");
+      if (position == primitive.attributes.end() || position->second < 0 ||
+          static_cast<size_t>(position->second) >= model.accessors.size())
+        continue;
+
+      const size_t count = model.accessors[position->second].count;
+      const size_t base = vertices.size();
+      vertices.resize(base + count, Vertex{ .color = glm::vec3(1.0f) });
+
+      auto element = [&](size_t i) -> Vertex & { return vertices[base + i]; };
+
+      const bool valid =
+        forEachElement(model, primitive, "POSITION", count, [&](size_t i, const float *v) { element(i).position = { v[0], v[1], v[2] }; }) &&
+        readIndices(model, primitive, count, static_cast<Index>(base), indices);
+
+      if (!valid) {
+        LOG_ERROR("[Mesh]: `{}` has a malformed primitive in mesh `{}`", path.string(), gltf_mesh.name);
+        return std::nullopt;
+      }
+
+      missing_normals |= !forEachElement(model, primitive, "NORMAL", count, [&](size_t i, const float *v) { element(i).normal = { v[0], v[1], v[2] }; });
+      forEachElement(model, primitive, "TEXCOORD_0", count, [&](size_t i, const float *v) { element(i).uv = { v[0], v[1] }; });
+      forEachElement(model, primitive, "COLOR_0", count, [&](size_t i, const float *v) { element(i).color = { v[0], v[1], v[2] }; });
+    }
+  }
+
+  if (indices.size() % 3 != 0) {
+    LOG_ERROR("[Mesh]: `{}` has an incomplete triangle list", path.string());
+    return std::nullopt;
+  }
+
+  Mesh mesh(std::move(vertices), std::move(indices));
+  if (missing_normals)
+    mesh.generateNormals(NormalSettings{ .pool = pool });
+  mesh.generateTangents(pool);
+  mesh.stage(allocator);
+
+  return mesh;
+}
+
+} /* namespace Engine */
@@ -0,0 +1,385 @@
+#include <core/graphics/mesh.hpp>
+#include <core/logging.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+/*
+ * Quadric error metric (Garland & Heckbert) stored as the upper triangle
+ * of the symmetric 4x4 matrix, plus the accumulated weight so the error
+ * can be reported as a distance instead of area * distance^2.
+ */
+struct Quadric {
+  double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+  double          a11 = 0, a12 = 0, a13 = 0;
+  double                   a22 = 0, a23 = 0;
+  double                            a33 = 0;
+  double weight = 0;
+
+  static Quadric fromPlane(glm::vec3 n, float d, double w) noexcept {
+    Quadric q;
+    q.a00 = w * n.x * n.x; q.a01 = w * n.x * n.y; q.a02 = w * n.x * n.z; q.a03 = w * n.x * d;
+    q.a11 = w * n.y * n.y; q.a12 = w * n.y * n.z; q.a13 = w * n.y * d;
+    q.a22 = w * n.z * n.z; q.a23 = w * n.z * d;
+    q.a33 = w * d * d;
+    q.weight = w;
+    return q;
+  }
+
+  Quadric &operator+=(const Quadric &o) noexcept {
+    a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+    a11 += o.a11; a12 += o.a12; a13 += o.a13;
+    a22 += o.a22; a23 += o.a23;
+    a33 += o.a33;
+    weight += o.weight;
+    return *this;
+  }
+
+  friend Quadric operator+(Quadric a, const Quadric &b) noexcept { return a += b; }
+
+  /* squared distance of `p` to the accumulated planes, normalized by weight */
+  double error(glm::vec3 p) const noexcept {
+    const double x = p.x, y = p.y, z = p.z;
+    double e = a00 * x * x + a11 * y * y + a22 * z * z
+             + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+             + 2.0 * (a03 * x + a13 * y + a23 * z)
+             + a33;
+    return weight > 0.0 ? std::fabs(e) / weight : std::fabs(e);
+  }
+};
+
+struct Collapse {
+  Mesh::Index from;
+  Mesh::Index to;
+  double error;
+};
+
+static inline uint64_t edgeKey(Mesh::Index a, Mesh::Index b) noexcept {
+  return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+/* maps every vertex to the first vertex sharing its exact position, so attribute seams collapse together */
+static std::vector<Mesh::Index> buildPositionRemap(std::span<const Mesh::Vertex> vertices) {
+  struct PositionHash {
+    std::size_t operator()(const glm::vec3 &p) const noexcept {
+      uint32_t h[3];
+      std::memcpy(h, &p, sizeof(h));
+      return (h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u);
+    }
+  };
+
+  std::vector<Mesh::Index> remap(vertices.size());
+  std::unordered_map<glm::vec3, Mesh::Index, PositionHash> unique;
+  unique.reserve(vertices.size());
+
+  for (size_t i = 0; i < vertices.size(); ++i)
+    remap[i] = unique.try_emplace(vertices[i].position, static_cast<Mesh::Index>(i)).first->second;
+
+  return remap;
+}
+
+/*
+ * Simplifies `indices` (triangle list) down to `target_index_count` with half-edge collapses,
+ * so no new vertices are created and the result indexes the original vertex buffer.
+ * Collapses whose error exceeds `max_error` (object space) are rejected.
+ * Returns the simplified indices; `result_error` receives the largest accepted error.
+ */
+static std::vector<Mesh::Index> simplify(
+  std::span<const Mesh::Vertex> vertices,
+  std::span<const Mesh::Index> source,
+  size_t target_index_count,
+  float max_error,
+  float &result_error
+) {
+  constexpr double BORDER_WEIGHT = 10.0;
+
+  std::vector<Mesh::Index> indices(source.begin(), source.end());
+  std::vector<Mesh::Index> remap = buildPositionRemap(vertices);
+  std::vector<Quadric> quadrics(vertices.size());
+  std::vector<bool> border(vertices.size(), false);
+
+  result_error = 0.0f;
+
+  /* directed edges (in position space) tell borders apart: a border edge has no twin */
+  std::unordered_set<uint64_t> directed_edges;
+  auto collectDirectedEdges = [&] {
+    directed_edges.clear();
+    directed_edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3)
+      for (int e = 0; e < 3; ++e)
+        directed_edges.insert(edgeKey(remap[indices[i + e]], remap[indices[i + (e + 1) % 3]]));
+  };
+  collectDirectedEdges();
+
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    Mesh::Index v[3] = { remap[indices[i]], remap[indices[i + 1]], remap[indices[i + 2]] };
+    glm::vec3 p0 = vertices[v[0]].position;
+    glm::vec3 p1 = vertices[v[1]].position;
+    glm::vec3 p2 = vertices[v[2]].position;
+
+    glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+    float area2 = glm::length(n);
+    if (area2 == 0.0f)
+      continue;
+
+    n = n / area2;
+    Quadric q = Quadric::fromPlane(n, -glm::dot(n, p0), 0.5 * area2);
+    for (Mesh::Index k : v)
+      quadrics[k] += q;
+
+    /* border edges get a perpendicular constraint plane so open boundaries keep their shape */
+    for (int e = 0; e < 3; ++e) {
+      Mesh::Index a = v[e], b = v[(e + 1) % 3];
+      if (directed_edges.contains(edgeKey(b, a)))
+        continue;
+
+      glm::vec3 edge = vertices[b].position - vertices[a].position;
+      float length = glm::length(edge);
+      if (length == 0.0f)
+        continue;
+
+      glm::vec3 en = glm::normalize(glm::cross(edge, n));
+      Quadric bq = Quadric::fromPlane(en, -glm::dot(en, vertices[a].position), BORDER_WEIGHT * length * length);
+      quadrics[a] += bq;
+      quadrics[b] += bq;
+      border[a] = border[b] = true;
+    }
+  }
+
+  const double max_error_sq = static_cast<double>(max_error) * max_error;
+
+  std::vector<Collapse> collapses;
+  std::vector<uint64_t> edges;
+  std::vector<uint32_t> adjacency_offsets(vertices.size() + 1);
+  std::vector<uint32_t> adjacency;
+  std::vector<bool> locked(vertices.size());
+  std::vector<Mesh::Index> collapse_target(vertices.size());
+  std::vector<Mesh::Index> vertex_target(vertices.size());
+
+  while (indices.size() > target_index_count) {
+    const size_t triangle_count = indices.size() / 3;
+    collectDirectedEdges();
+
+    /* vertex -> triangle adjacency (position space) for the flip test */
+    std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0u);
+    for (Mesh::Index i : indices)
+      ++adjacency_offsets[remap[i] + 1];
+    for (size_t i = 1; i < adjacency_offsets.size(); ++i)
+      adjacency_offsets[i] += adjacency_offsets[i - 1];
+
+    adjacency.resize(indices.size());
+    {
+      std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+      for (size_t i = 0; i < indices.size(); ++i)
+        adjacency[fill[remap[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    /* unique undirected edges */
+    edges.clear();
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      for (int e = 0; e < 3; ++e) {
+        Mesh::Index a = remap[indices[i + e]], b = remap[indices[i + (e + 1) % 3]];
+        if (a != b)
+          edges.push_back(edgeKey(std::min(a, b), std::max(a, b)));
+      }
+    }
+    std::ranges::sort(edges);
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    auto flips = [&](Mesh::Index from, Mesh::Index to) {
+      glm::vec3 target = vertices[to].position;
+      for (uint32_t k = adjacency_offsets[from]; k < adjacency_offsets[from + 1]; ++k) {
+        const Mesh::Index *tri = &indices[adjacency[k] * 3];
+        Mesh::Index v[3] = { remap[tri[0]], remap[tri[1]], remap[tri[2]] };
+        if (v[0] == to || v[1] == to || v[2] == to)
+          continue; /* this triangle disappears */
+
+        glm::vec3 before[3], after[3];
+        for (int c = 0; c < 3; ++c) {
+          before[c] = vertices[v[c]].position;
+          after[c] = v[c] == from ? target : before[c];
+        }
+
+        glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(n0, n1) <= 0.0f)
+          return true;
+      }
+      return false;
+    };
+
+    collapses.clear();
+    for (uint64_t key : edges) {
+      Mesh::Index a = static_cast<Mesh::Index>(key >> 32);
+      Mesh::Index b = static_cast<Mesh::Index>(key & 0xffffffffu);
+      bool border_edge = !directed_edges.contains(edgeKey(a, b)) || !directed_edges.contains(edgeKey(b, a));
+
+      /* a border vertex may only slide along the border */
+      bool a_to_b = !border[a] || border_edge;
+      bool b_to_a = !border[b] || border_edge;
+      if (!a_to_b && !b_to_a)
+        continue;
+
+      Quadric q = quadrics[a] + quadrics[b];
+      double ea = a_to_b ? q.error(vertices[b].position) : std::numeric_limits<double>::max();
+      double eb = b_to_a ? q.error(vertices[a].position) : std::numeric_limits<double>::max();
+
+      Collapse c = ea <= eb ? Collapse{ a, b, ea } : Collapse{ b, a, eb };
+      if (c.error <= max_error_sq)
+        collapses.push_back(c);
+    }
+
+    if (collapses.empty())
+      break;
+
+    std::ranges::sort(collapses, {}, &Collapse::error);
+
+    /* each interior collapse removes two triangles */
+    const size_t target_triangles = target_index_count / 3;
+    const size_t budget = (triangle_count - target_triangles + 1) / 2;
+
+    std::fill(locked.begin(), locked.end(), false);
+    for (size_t i = 0; i < collapse_target.size(); ++i)
+      collapse_target[i] = static_cast<Mesh::Index>(i);
+
+    size_t applied = 0;
+    double pass_error = 0.0;
+    for (const Collapse &c : collapses) {
+      if (applied >= budget)
+        break;
+      if (locked[c.from] || locked[c.to] || flips(c.from, c.to))
+        continue;
+
+      collapse_target[c.from] = c.to;
+      quadrics[c.to] += quadrics[c.from];
+      pass_error = std::max(pass_error, c.error);
+
+      /* lock the one-ring of `from`, its triangles now reference `to` */
+      for (uint32_t k = adjacency_offsets[c.from]; k < adjacency_offsets[c.from + 1]; ++k) {
+        const Mesh::Index *tri = &indices[adjacency[k] * 3];
+        for (int v = 0; v < 3; ++v)
+          locked[remap[tri[v]]] = true;
+      }
+      locked[c.to] = true;
+      ++applied;
+    }
+
+    if (applied == 0)
+      break;
+
+    /* resolve seams: move each wedge onto the wedge of `to` it shares an edge with */
+    for (size_t i = 0; i < vertex_target.size(); ++i)
+      vertex_target[i] = static_cast<Mesh::Index>(i);
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      for (int e = 0; e < 3; ++e) {
+        for (int o = 1; o < 3; ++o) {
+          Mesh::Index w = indices[i + e];
+          Mesh::Index x = indices[i + (e + o) % 3];
+          if (collapse_target[remap[w]] == remap[x] && remap[w] != remap[x] && vertex_target[w] == w)
+            vertex_target[w] = x;
+        }
+      }
+    }
+
+    size_t write = 0;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      Mesh::Index tri[3];
+      for (int c = 0; c < 3; ++c) {
+        Mesh::Index v = indices[i + c];
+        Mesh::Index p = remap[v];
+        if (collapse_target[p] != p && vertex_target[v] == v)
+          vertex_target[v] = collapse_target[p];  /* no shared edge, fall back to the canonical wedge */
+        tri[c] = vertex_target[v];
+      }
+
+      if (remap[tri[0]] == remap[tri[1]] || remap[tri[1]] == remap[tri[2]] || remap[tri[0]] == remap[tri[2]])
+        continue;
+
+      indices[write++] = tri[0];
+      indices[write++] = tri[1];
+      indices[write++] = tri[2];
+    }
+    indices.resize(write);
+
+    result_error = std::max(result_error, static_cast<float>(std::sqrt(pass_error)));
+  }
+
+  return indices;
+}
+
+size_t Mesh::generateLODs(const LODSettings &settings) {
+  if (isStaged()) {
+    LOG_ERROR("[Mesh]: LODs have to be generated before a mesh is staged");
+    return lods.size();
+  }
+
+  if (indices.empty() || vertices.empty())
+    return lods.size();
+
+  if (lods.empty())
+    lods.push_back(LOD{ .range = { 0, static_cast<uint32_t>(indices.size()) }, .error = 0.0f, .bounds = computeBounds(vertices, indices) });
+
+  /* drop a previously generated chain, LOD 0 stays */
+  indices.resize(lods.front().range.index_count);
+  lods.resize(1);
+
+  const float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+  const float max_error = settings.max_error * radius;
+
+  const size_t base_index_count = lods.front().range.index_count;
+  std::vector<Index> previous(indices.begin(), indices.end());
+
+  for (float ratio : settings.ratios) {
+    size_t target = std::max<size_t>(3, static_cast<size_t>(base_index_count / 3 * ratio) * 3);
+    if (target >= previous.size())
+      continue;
+
+    float error = 0.0f;
+    std::vector<Index> simplified = simplify(vertices, previous, target, max_error, error);
+
+    /* not worth a level if simplification stalled */
+    if (simplified.empty() || simplified.size() * 20 > previous.size() * 19)
+      break;
+
+    error += lods.back().error;  /* levels are simplified from each other, errors accumulate */
+    lods.push_back(LOD{
+      .range = {
+        .first_index = static_cast<uint32_t>(indices.size()),
+        .index_count = static_cast<uint32_t>(simplified.size()),
+      },
+      .error = error,
+      .bounds = computeBounds(vertices, simplified),
+    });
+    indices.insert(indices.end(), simplified.begin(), simplified.end());
+    previous = std::move(simplified);
+  }
+
+  LOG_DEBUG("[Mesh]: Generated {} LOD levels ({} -> {} triangles)",
+            lods.size(), base_index_count / 3, lods.back().range.index_count / 3);
+  return lods.size();
+}
+
+uint32_t Mesh::selectLOD(std::span<const LOD> lods, float distance, float projection_scale, float max_pixel_error) {
+  if (lods.empty())
+    return 0;
+
+  distance = std::max(distance, std::numeric_limits<float>::epsilon());
+
+  uint32_t selected = 0;
+  for (uint32_t i = 1; i < lods.size(); ++i) {
+    if (lods[i].error * projection_scale / distance > max_pixel_error)
+      break;
+    selected = i;
+  }
+  return selected;
+}
+
+} /* namespace Engine */
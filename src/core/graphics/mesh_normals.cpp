@@ -0,0 +1,335 @@
+#include <core/graphics/mesh.hpp>
+#include <core/thread_pool.hpp>
+#include <core/logging.hpp>
+#include <util/simd.hpp>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+static constexpr size_t TRIANGLE_GRAIN = 4096;
+static constexpr size_t VERTEX_GRAIN = 4096;
+static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+static void parallelFor(ThreadPool *pool, size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+  if (pool)
+    pool->parallelFor(count, grain, fn);
+  else if (count > 0)
+    fn(0, count);
+}
+
+/* Fills the first `lanes` lanes from `f(lane)`, the rest stay zero */
+template <typename F>
+static SIMD::Float4 gather(size_t lanes, F f) {
+  float values[4] = {};
+  for (size_t lane = 0; lane < lanes; ++lane)
+    values[lane] = f(lane);
+  return SIMD::Float4(values[0], values[1], values[2], values[3]);
+}
+
+static SIMD::Vec3x4 gatherPositions(
+  std::span<const Mesh::Vertex> vertices,
+  std::span<const Mesh::Index> indices,
+  size_t first_triangle,
+  size_t corner,
+  size_t lanes
+) {
+  auto position = [&](size_t lane) -> const glm::vec3 & {
+    return vertices[indices[(first_triangle + lane) * 3 + corner]].position;
+  };
+  return {
+    gather(lanes, [&](size_t lane) { return position(lane).x; }),
+    gather(lanes, [&](size_t lane) { return position(lane).y; }),
+    gather(lanes, [&](size_t lane) { return position(lane).z; }),
+  };
+}
+
+static void scatter(const SIMD::Vec3x4 &v, size_t lanes, glm::vec3 *out) {
+  alignas(16) float x[4], y[4], z[4];
+  v.x.store(x);
+  v.y.store(y);
+  v.z.store(z);
+  for (size_t lane = 0; lane < lanes; ++lane)
+    out[lane] = glm::vec3(x[lane], y[lane], z[lane]);
+}
+
+/* Per triangle data shared by the normal and tangent passes */
+struct FaceData {
+  std::vector<glm::vec3> normals;    /* edge cross product, its length is twice the area */
+  std::vector<glm::vec3> units;      /* normalized, zero for degenerate triangles */
+  std::vector<float> corner_angles;  /* radians, three per triangle */
+};
+
+static FaceData computeFaces(std::span<const Mesh::Vertex> vertices, std::span<const Mesh::Index> indices, ThreadPool *pool) {
+  const size_t triangle_count = indices.size() / 3;
+
+  FaceData faces;
+  faces.normals.resize(triangle_count);
+  faces.units.resize(triangle_count);
+  faces.corner_angles.resize(triangle_count * 3);
+
+  parallelFor(pool, triangle_count, TRIANGLE_GRAIN, [&](size_t begin, size_t end) {
+    using SIMD::Float4;
+    const Float4 zero(0.0f);
+    const Float4 tiny(1e-30f);
+
+    for (size_t t = begin; t < end; t += 4) {
+      const size_t lanes = std::min<size_t>(4, end - t);
+
+      SIMD::Vec3x4 p0 = gatherPositions(vertices, indices, t, 0, lanes);
+      SIMD::Vec3x4 p1 = gatherPositions(vertices, indices, t, 1, lanes);
+      SIMD::Vec3x4 p2 = gatherPositions(vertices, indices, t, 2, lanes);
+
+      SIMD::Vec3x4 e01 = p1 - p0;
+      SIMD::Vec3x4 e02 = p2 - p0;
+      SIMD::Vec3x4 e12 = p2 - p1;
+
+      SIMD::Vec3x4 n = cross(e01, e02);
+      Float4 length = sqrt(dot(n, n));
+      Float4 inverse = select(zero, Float4(1.0f) / max(length, tiny), greater(length, zero));
+
+      Float4 l01 = dot(e01, e01);
+      Float4 l02 = dot(e02, e02);
+      Float4 l12 = dot(e12, e12);
+
+      alignas(16) float cosines[3][4];
+      (dot(e01, e02) / sqrt(max(l01 * l02, tiny))).store(cosines[0]);
+      (zero - dot(e01, e12) / sqrt(max(l01 * l12, tiny))).store(cosines[1]);
+      (dot(e02, e12) / sqrt(max(l02 * l12, tiny))).store(cosines[2]);
+
+      scatter(n, lanes, &faces.normals[t]);
+      scatter(n * inverse, lanes, &faces.units[t]);
+
+      for (size_t lane = 0; lane < lanes; ++lane)
+        for (size_t c = 0; c < 3; ++c)
+          faces.corner_angles[(t + lane) * 3 + c] = std::acos(std::clamp(cosines[c][lane], -1.0f, 1.0f));
+    }
+  });
+
+  return faces;
+}
+
+/* Exact position match, -0 and +0 weld together */
+struct PositionHash {
+  inline size_t operator()(const glm::vec3 &p) const noexcept {
+    return Hash::murmur3_128(&p, sizeof(p)).low;
+  }
+};
+
+size_t Mesh::generateNormals(const NormalSettings &settings) {
+  if (isStaged()) {
+    LOG_ERROR("[Mesh]: Normals have to be generated before a mesh is staged");
+    return vertices.size();
+  }
+
+  if (lods.size() > 1 || !meshlets.empty()) {
+    LOG_ERROR("[Mesh]: Normals have to be generated before LODs and meshlets");
+    return vertices.size();
+  }
+
+  const size_t triangle_count = indices.size() / 3;
+  if (triangle_count == 0)
+    return vertices.size();
+
+  const FaceData faces = computeFaces(vertices, indices, settings.pool);
+
+  /* weld: vertices at the same position share one group, whatever their other attributes */
+  std::vector<uint32_t> group(vertices.size());
+  uint32_t group_count = 0;
+  {
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> welded;
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      auto [it, inserted] = welded.try_emplace(vertices[i].position + glm::vec3(0.0f), group_count);
+      group_count += inserted;
+      group[i] = it->second;
+    }
+  }
+
+  /* group -> corners */
+  std::vector<uint32_t> offsets(group_count + 1, 0);
+  for (Index i : indices)
+    ++offsets[group[i] + 1];
+  for (size_t i = 1; i < offsets.size(); ++i)
+    offsets[i] += offsets[i - 1];
+
+  std::vector<uint32_t> corners(indices.size());
+  {
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t k = 0; k < indices.size(); ++k)
+      corners[fill[group[indices[k]]]++] = static_cast<uint32_t>(k);
+  }
+
+  /* every corner sums the weighted normals of the faces around it that are within the crease angle */
+  const float crease_cosine = std::cos(glm::radians(settings.crease_angle));
+  std::vector<glm::vec3> corner_normals(indices.size());
+
+  parallelFor(settings.pool, group_count, VERTEX_GRAIN, [&](size_t begin, size_t end) {
+    for (size_t g = begin; g < end; ++g) {
+      for (uint32_t a = offsets[g]; a < offsets[g + 1]; ++a) {
+        const uint32_t corner = corners[a];
+        const glm::vec3 unit = faces.units[corner / 3];
+        const bool degenerate = unit == glm::vec3(0.0f);
+
+        glm::vec3 sum(0.0f);
+        for (uint32_t b = offsets[g]; b < offsets[g + 1]; ++b) {
+          const uint32_t other = corners[b];
+          if (degenerate || other == corner || glm::dot(unit, faces.units[other / 3]) >= crease_cosine)
+            sum += faces.normals[other / 3] * faces.corner_angles[other];
+        }
+
+        const float length = glm::length(sum);
+        if (length > 0.0f)
+          corner_normals[corner] = sum / length;
+        else
+          corner_normals[corner] = degenerate ? glm::vec3(0.0f, 0.0f, 1.0f) : unit;
+      }
+    }
+  });
+
+  /*
+   * One vertex per distinct (vertex, normal) pair. Corners on the same side of every crease
+   * summed the same faces in the same order, so their normals compare exactly equal.
+   */
+  std::vector<Vertex> split;
+  split.reserve(vertices.size());
+  std::vector<uint32_t> first(vertices.size(), NONE);
+  std::vector<uint32_t> next;
+  next.reserve(vertices.size());
+
+  for (size_t k = 0; k < indices.size(); ++k) {
+    const Index v = indices[k];
+    const glm::vec3 &normal = corner_normals[k];
+
+    uint32_t s = first[v];
+    while (s != NONE && split[s].normal != normal)
+      s = next[s];
+
+    if (s == NONE) {
+      s = static_cast<uint32_t>(split.size());
+      split.push_back(vertices[v]);
+      split.back().normal = normal;
+      next.push_back(first[v]);
+      first[v] = s;
+    }
+
+    indices[k] = s;
+  }
+
+  LOG_DEBUG("[Mesh]: Generated normals, {} vertices ({} welded positions) -> {}", vertices.size(), group_count, split.size());
+
+  vertices = std::move(split);
+  return vertices.size();
+}
+
+/* Any unit vector orthogonal to `n` */
+static glm::vec3 orthogonal(glm::vec3 n) {
+  glm::vec3 axis = std::abs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+  return glm::normalize(axis - n * glm::dot(n, axis));
+}
+
+void Mesh::generateTangents(ThreadPool *pool) {
+  std::span<Vertex> vertex_data = getVerticesView();
+  std::span<const Index> index_data = getIndicesView();
+
+  /* coarser LODs reuse the LOD 0 vertices, so LOD 0 alone defines the tangent frames */
+  if (!lods.empty())
+    index_data = index_data.subspan(lods.front().range.first_index, lods.front().range.index_count);
+
+  const size_t triangle_count = index_data.size() / 3;
+  const FaceData faces = computeFaces(vertex_data, index_data, pool);
+
+  /* per face: normalized, orientation-signed directions of increasing u and v */
+  std::vector<glm::vec3> face_tangents(triangle_count);
+  std::vector<glm::vec3> face_bitangents(triangle_count);
+
+  parallelFor(pool, triangle_count, TRIANGLE_GRAIN, [&](size_t begin, size_t end) {
+    using SIMD::Float4;
+    const Float4 zero(0.0f);
+    const Float4 tiny(1e-30f);
+
+    for (size_t t = begin; t < end; t += 4) {
+      const size_t lanes = std::min<size_t>(4, end - t);
+
+      auto uv = [&](size_t corner, int axis) {
+        return gather(lanes, [&](size_t lane) { return vertex_data[index_data[(t + lane) * 3 + corner]].uv[axis]; });
+      };
+
+      SIMD::Vec3x4 p0 = gatherPositions(vertex_data, index_data, t, 0, lanes);
+      SIMD::Vec3x4 e1 = gatherPositions(vertex_data, index_data, t, 1, lanes) - p0;
+      SIMD::Vec3x4 e2 = gatherPositions(vertex_data, index_data, t, 2, lanes) - p0;
+
+      Float4 u0 = uv(0, 0), v0 = uv(0, 1);
+      Float4 s1 = uv(1, 0) - u0, t1 = uv(1, 1) - v0;
+      Float4 s2 = uv(2, 0) - u0, t2 = uv(2, 1) - v0;
+
+      Float4 orientation = select(Float4(-1.0f), Float4(1.0f), greater(s1 * t2 - s2 * t1, zero));
+
+      SIMD::Vec3x4 os = e1 * t2 - e2 * t1;
+      SIMD::Vec3x4 ot = e2 * s1 - e1 * s2;
+      Float4 os_length = sqrt(dot(os, os));
+      Float4 ot_length = sqrt(dot(ot, ot));
+
+      scatter(os * select(zero, orientation / max(os_length, tiny), greater(os_length, zero)), lanes, &face_tangents[t]);
+      scatter(ot * select(zero, orientation / max(ot_length, tiny), greater(ot_length, zero)), lanes, &face_bitangents[t]);
+    }
+  });
+
+  /* vertex -> corners */
+  std::vector<uint32_t> offsets(vertex_data.size() + 1, 0);
+  for (Index i : index_data)
+    ++offsets[i + 1];
+  for (size_t i = 1; i < offsets.size(); ++i)
+    offsets[i] += offsets[i - 1];
+
+  std::vector<uint32_t> corners(index_data.size());
+  {
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t k = 0; k < index_data.size(); ++k)
+      corners[fill[index_data[k]]++] = static_cast<uint32_t>(k);
+  }
+
+  parallelFor(pool, vertex_data.size(), VERTEX_GRAIN, [&](size_t begin, size_t end) {
+    for (size_t v = begin; v < end; ++v) {
+      Vertex &vertex = vertex_data[v];
+      const glm::vec3 n = vertex.normal;
+
+      /* face directions projected into the vertex tangent plane, weighted by the corner angle */
+      glm::vec3 tangent(0.0f);
+      glm::vec3 bitangent(0.0f);
+      for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+        const uint32_t corner = corners[k];
+        const float angle = faces.corner_angles[corner];
+        const glm::vec3 &t = face_tangents[corner / 3];
+        const glm::vec3 &b = face_bitangents[corner / 3];
+
+        glm::vec3 projected_t = t - n * glm::dot(n, t);
+        glm::vec3 projected_b = b - n * glm::dot(n, b);
+        float length_t = glm::length(projected_t);
+        float length_b = glm::length(projected_b);
+        if (length_t > 0.0f)
+          tangent += projected_t * (angle / length_t);
+        if (length_b > 0.0f)
+          bitangent += projected_b * (angle / length_b);
+      }
+
+      const float length = glm::length(tangent);
+      if (length > 0.0f)
+        tangent = tangent / length;
+      else if (glm::length(n) > 0.0f)
+        tangent = orthogonal(glm::normalize(n));
+      else
+        tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+
+      const float sign = glm::dot(glm::cross(n, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+      vertex.tangent = glm::vec4(tangent, sign);
+    }
+  });
+}
+
+} /* namespace Engine */
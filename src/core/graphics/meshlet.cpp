@@ -0,0 +1,228 @@
+#include <core/graphics/mesh.hpp>
+#include <core/logging.hpp>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+static void computeMeshletBounds(
+  Mesh::Meshlet &meshlet,
+  std::span<const Mesh::Vertex> vertices,
+  std::span<const Mesh::Index> triangles
+) {
+  glm::vec3 min(std::numeric_limits<float>::max());
+  glm::vec3 max(std::numeric_limits<float>::lowest());
+  for (Mesh::Index i : triangles) {
+    min = glm::min(min, vertices[i].position);
+    max = glm::max(max, vertices[i].position);
+  }
+
+  meshlet.center = (min + max) * 0.5f;
+  meshlet.radius = 0.0f;
+  for (Mesh::Index i : triangles)
+    meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, vertices[i].position));
+
+  /* normal cone: average face normal, opened up to the widest deviation */
+  glm::vec3 axis(0.0f);
+  std::vector<glm::vec3> normals;
+  normals.reserve(triangles.size() / 3);
+
+  for (size_t i = 0; i < triangles.size(); i += 3) {
+    glm::vec3 p0 = vertices[triangles[i]].position;
+    glm::vec3 p1 = vertices[triangles[i + 1]].position;
+    glm::vec3 p2 = vertices[triangles[i + 2]].position;
+    glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+    float length = glm::length(n);
+    if (length == 0.0f)
+      continue;
+
+    normals.push_back(n / length);
+    axis += normals.back();
+  }
+
+  meshlet.cone_axis = glm::vec3(0.0f);
+  meshlet.cone_cutoff = 1.0f;
+
+  float axis_length = glm::length(axis);
+  if (normals.empty() || axis_length == 0.0f)
+    return;
+
+  axis = axis / axis_length;
+  float min_dot = 1.0f;
+  for (glm::vec3 n : normals)
+    min_dot = std::min(min_dot, glm::dot(axis, n));
+
+  /* cone wider than a hemisphere can never be fully back-facing */
+  if (min_dot <= 0.1f)
+    return;
+
+  meshlet.cone_axis = axis;
+  meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+}
+
+size_t Mesh::buildMeshlets(size_t max_vertices, size_t max_triangles) {
+  if (isStaged()) {
+    LOG_ERROR("[Mesh]: Meshlets have to be built before a mesh is staged");
+    return meshlets.size();
+  }
+
+  meshlets.clear();
+
+  if (lods.empty())
+    lods.push_back(LOD{ .range = { 0, static_cast<uint32_t>(indices.size()) }, .error = 0.0f, .bounds = computeBounds(vertices, indices) });
+
+  const IndexRange base = lods.front().range;
+  const size_t triangle_count = base.index_count / 3;
+  if (triangle_count == 0)
+    return 0;
+
+  std::span<const Index> source { indices.data() + base.first_index, base.index_count };
+
+  /* vertex -> triangle adjacency */
+  std::vector<uint32_t> offsets(vertices.size() + 1, 0);
+  for (Index i : source)
+    ++offsets[i + 1];
+  for (size_t i = 1; i < offsets.size(); ++i)
+    offsets[i] += offsets[i - 1];
+
+  std::vector<uint32_t> adjacency(source.size());
+  {
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < source.size(); ++i)
+      adjacency[fill[source[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+  std::vector<bool> emitted(triangle_count, false);
+  std::vector<uint32_t> vertex_owner(vertices.size(), NONE); /* meshlet a vertex was last added to */
+
+  std::vector<Index> reordered;
+  reordered.reserve(source.size());
+
+  std::vector<Index> meshlet_vertices;
+  meshlet_vertices.reserve(max_vertices);
+
+  size_t seed_cursor = 0;
+  size_t remaining = triangle_count;
+
+  while (remaining > 0) {
+    const uint32_t id = static_cast<uint32_t>(meshlets.size());
+    Meshlet meshlet { .range = { .first_index = static_cast<uint32_t>(base.first_index + reordered.size()), .index_count = 0 } };
+    meshlet_vertices.clear();
+
+    auto newVertices = [&](uint32_t triangle) {
+      uint32_t count = 0;
+      for (int c = 0; c < 3; ++c)
+        count += vertex_owner[source[triangle * 3 + c]] != id;
+      return count;
+    };
+
+    auto append = [&](uint32_t triangle) {
+      for (int c = 0; c < 3; ++c) {
+        Index v = source[triangle * 3 + c];
+        if (vertex_owner[v] != id) {
+          vertex_owner[v] = id;
+          meshlet_vertices.push_back(v);
+        }
+        reordered.push_back(v);
+      }
+      emitted[triangle] = true;
+      meshlet.range.index_count += 3;
+      --remaining;
+    };
+
+    while (seed_cursor < triangle_count && emitted[seed_cursor])
+      ++seed_cursor;
+    append(static_cast<uint32_t>(seed_cursor));
+
+    /* grow along shared vertices, preferring triangles that add the fewest new vertices */
+    while (meshlet.range.index_count / 3 < max_triangles && remaining > 0) {
+      uint32_t best = NONE;
+      uint32_t best_cost = 3;
+
+      for (Index v : meshlet_vertices) {
+        for (uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+          uint32_t triangle = adjacency[k];
+          if (emitted[triangle])
+            continue;
+
+          uint32_t cost = newVertices(triangle);
+          if (cost < best_cost || best == NONE) {
+            best = triangle;
+            best_cost = cost;
+          }
+        }
+        if (best_cost == 0)
+          break;
+      }
+
+      if (best == NONE || meshlet_vertices.size() + best_cost > max_vertices)
+        break;
+
+      append(best);
+    }
+
+    computeMeshletBounds(meshlet, vertices, std::span<const Index>{ reordered }.subspan(meshlet.range.first_index - base.first_index, meshlet.range.index_count));
+    meshlet.vertex_count = static_cast<uint32_t>(meshlet_vertices.size());
+    meshlets.push_back(meshlet);
+  }
+
+  std::ranges::copy(reordered, indices.begin() + base.first_index);
+
+  LOG_DEBUG("[Mesh]: Built {} meshlets from {} triangles", meshlets.size(), triangle_count);
+  return meshlets.size();
+}
+
+size_t Mesh::cullMeshlets(
+  std::span<const Meshlet> meshlets,
+  const Frustum &frustum,
+  glm::vec3 camera_position,
+  std::vector<IndexRange> &out
+) {
+  size_t triangles = 0;
+
+  for (const Meshlet &meshlet : meshlets) {
+    if (!frustum.intersectsSphere(meshlet.center, meshlet.radius))
+      continue;
+
+    glm::vec3 to_center = meshlet.center - camera_position;
+    if (glm::dot(to_center, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(to_center) + meshlet.radius)
+      continue;
+
+    triangles += meshlet.range.index_count / 3;
+
+    if (!out.empty() && out.back().first_index + out.back().index_count == meshlet.range.first_index)
+      out.back().index_count += meshlet.range.index_count;
+    else
+      out.push_back(meshlet.range);
+  }
+
+  return triangles;
+}
+
+size_t MeshManager::cullMeshlets(
+  Mesh::Handle handle,
+  const Frustum &frustum,
+  glm::vec3 camera_position,
+  std::vector<Mesh::IndexRange> &out
+) {
+  MeshInfo &info = get(handle);
+
+  /* whole mesh outside, no need to look at its meshlets */
+  if (!frustum.intersectsSphere(info.bounds.center, info.bounds.radius))
+    return 0;
+
+  if (info.meshlets.empty()) {
+    if (info.lods.empty())
+      return 0;
+    out.push_back(info.lods.front().range);
+    return info.lods.front().range.index_count / 3;
+  }
+
+  return Mesh::cullMeshlets(info.meshlets, frustum, camera_position, out);
+}
+
+} /* namespace Engine */
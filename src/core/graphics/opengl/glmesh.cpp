@@ -5,23 +5,23 @@
 
 namespace Engine {
 
-Mesh::Handle MeshManager::OpenGL::addMesh(Mesh &mesh) {
-  auto mesh_data = std::make_unique<MeshInfo::OpenGL>();
-  
-  auto vertices = mesh.getVerticesView();
-  auto indices = mesh.getIndicesView();
-
-  mesh_data->cpu_vertices.assign(vertices.begin(), vertices.end());
-  mesh_data->cpu_indices.assign(indices.begin(), indices.end());
-
-  Mesh::Handle handle = meshes.size();
-  meshes.push_back(std::move(mesh_data));
-  return handle;
-}
+size_t MeshManager::OpenGL::uploadPending(size_t byte_budget) {
+  size_t uploaded = 0;
 
-void MeshManager::OpenGL::uploadPending() {
   for (std::unique_ptr<MeshInfo> &mesh_data : meshes) {
     auto gl_mesh_data = static_cast<MeshInfo::OpenGL *>(mesh_data.get());
+
+    if (!mesh_data->alive || mesh_data->gpu_uploaded || !mesh_data->hasCPUData())
+      continue;
+
+    if (uploaded > 0 && uploaded + mesh_data->getSizeInBytes() > byte_budget)
+      break;
+
+    /* reloaded meshes keep drawing their old buffers up to this point */
+    releaseGPU(*mesh_data);
+
+    std::span<const Mesh::Vertex> vertices = mesh_data->getVertices();
+    std::span<const Mesh::Index> indices = mesh_data->getIndices();
     
     glGenVertexArrays(1, &gl_mesh_data->vao);
     glGenBuffers(1, &gl_mesh_data->vbo);
@@ -31,16 +31,16 @@ void MeshManager::OpenGL::uploadPending() {
     glBindBuffer(GL_ARRAY_BUFFER, gl_mesh_data->vbo);
     glBufferData(
       GL_ARRAY_BUFFER,
-      mesh_data->cpu_vertices.size() * sizeof(Mesh::Vertex),
-      mesh_data->cpu_vertices.data(),
+      vertices.size_bytes(),
+      vertices.data(),
       GL_STATIC_DRAW
     );
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_mesh_data->ibo);
     glBufferData(
       GL_ELEMENT_ARRAY_BUFFER,
-      mesh_data->cpu_indices.size() * sizeof(Mesh::Index),
-      mesh_data->cpu_indices.data(),
+      indices.size_bytes(),
+      indices.data(),
       GL_STATIC_DRAW
     );
 
@@ -82,7 +82,22 @@ void MeshManager::OpenGL::uploadPending() {
       sizeof(Mesh::Vertex),
       (void *)offsetof(Mesh::Vertex, uv)
     );
+
+    glEnableVertexAttribArray(4);           /* tangent */
+    glVertexAttribPointer(
+      4,
+      4,
+      GL_FLOAT,
+      GL_FALSE,
+      sizeof(Mesh::Vertex),
+      (void *)offsetof(Mesh::Vertex, tangent)
+    );
+
+    uploaded += mesh_data->getSizeInBytes();
+    markUploaded(*mesh_data);
   }
+
+  return uploaded;
 }
 
 } /* namespace Engine */
@@ -1,5 +1,8 @@
 #include <core/graphics/opengl/glshader.hpp>
 #include <core/logging.hpp>
+#include <core/assets/vfs.hpp>
+
+#include <utility>
 
 namespace Engine {
 
@@ -53,6 +56,22 @@ bool Pipeline::OpenGL::create(ShaderStages stages_in) {
   return true;
 }
 
+/* Relink from the stage files, keeping the current program on failure */
+bool Pipeline::OpenGL::reload() {
+  GLuint old_program = std::exchange(program, 0);
+
+  if (!create(stages)) {
+    if (program != 0)
+      glDeleteProgram(program);
+    program = old_program;
+    return false;
+  }
+
+  glDeleteProgram(old_program);
+  uniform_locations.clear();
+  return true;
+}
+
 /* Bind program for use */
 void Pipeline::OpenGL::bind(uint32_t slot) {
   (void)slot; // slot not used in OpenGL
@@ -63,14 +82,16 @@ void Pipeline::OpenGL::bind(uint32_t slot) {
 GLuint Pipeline::OpenGL::compileShader(GLenum type, File::Path path) {
   GLuint shader = glCreateShader(type);
 
-  std::string source;
-  if (!File::readContent(path, source)) {
+  /* the source is passed with its length, so the loaded bytes need no terminator */
+  File::Data source;
+  if (!File::load(path, source, File::MappedFile::Access::Sequential)) {
     LOG_ERROR("[Pipeline::OpenGL] Failed to read shader: {}", path.string());
     return 0;
   }
 
   const char *src = source.data();
-  glShaderSource(shader, 1, &src, nullptr);
+  const GLint length = static_cast<GLint>(source.size());
+  glShaderSource(shader, 1, &src, &length);
   glCompileShader(shader);
 
   GLint success = 0;
@@ -104,10 +104,24 @@ bool GraphicsAPI::OpenGL::endFrame(Window *window) {
   return true;
 };
 
+void GraphicsAPI::OpenGL::resize(uint32_t width, uint32_t height) {
+  glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+}
+
 bool GraphicsAPI::OpenGL::drawIndexed(DrawInfo &) {
   return true;
 };
 
+bool GraphicsAPI::OpenGL::flushDraws() {
+  return true;
+};
+
+std::span<Mesh::InstanceData> GraphicsAPI::OpenGL::mapInstances(uint32_t count) {
+  /* not read by any OpenGL shader yet */
+  instances.resize(count);
+  return instances;
+}
+
 bool GraphicsAPI::OpenGL::updateUBO(UniformBufferType, const void *, size_t, size_t) {
   return true;
 }
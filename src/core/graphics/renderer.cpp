@@ -1,12 +1,18 @@
+#include <core/timer.hpp>
 #include <core/logging.hpp>
+#include <core/platform/window.hpp>
 #include <core/graphics/renderer.hpp>
+#include <core/graphics/camera/camera.hpp>
 #include <core/graphics/opengl/glmesh.hpp>
 #include <core/graphics/vulkan/vkmesh.hpp>
 #include <core/graphics/opengl/glshader.hpp>
 #include <core/graphics/vulkan/vkshader.hpp>
 #include <core/graphics/vulkan/vkbuffer.hpp>
+#include <core/graphics/vulkan/vkculling.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
 #include <core/graphics/vulkan/descriptor_manager.hpp>
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 
@@ -25,46 +31,250 @@ bool Renderer::init(Config::Renderer &config) {
   if (!graphics_api->init(window))
     return false;
 
+  lod_selection.max_pixel_error = config.lod_pixel_error;
+  upload_budget = config.upload_budget;
+
   auto vulkan = static_cast<GraphicsAPI::Vulkan *>(graphics_api.get());
 
   mesh_manager = std::make_unique<MeshManager::Vulkan>(vulkan);
-  ub_manager = std::make_unique<UniformBufferManager::Vulkan>(vulkan);
+  mesh_manager->setResidency(config.mesh_residency);
+  /* the camera is set 0 of every pipeline, one buffer and set per frame in flight */
+  auto vk_ub_manager = std::make_unique<UniformBufferManager::Vulkan>(vulkan);
+  auto &descriptor_manager = vulkan->getDescriptorManager();
+
+  if (!vk_ub_manager->create(UniformBufferType::Camera, sizeof(glm::mat4)) ||
+      !descriptor_manager.createLayout(UniformBufferType::Camera, DescriptorSetLayoutInfo {
+        .binding = 0,
+        .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+      }) ||
+      !descriptor_manager.allocateSets(UniformBufferType::Camera)) {
+    LOG_ERROR("[Renderer] - Failed to create the camera uniform buffer");
+    return false;
+  }
+
+  for (uint32_t frame_index = 0; frame_index < GraphicsAPI::Vulkan::MAX_FRAMES_IN_FLIGHT; ++frame_index)
+    descriptor_manager.updateSet(UniformBufferType::Camera,
+                                 vk_ub_manager->getDescriptorBufferInfo(UniformBufferType::Camera, frame_index), frame_index);
+
+  ub_manager = std::move(vk_ub_manager);
+
+  auto &device_manager = vulkan->getDeviceManager();
+  if (!device_manager.createPipelineCache(config.pipeline_cache))
+    return false;
 
-  // auto &descriptor_manager = vulkan->getDescriptorManager();
+  /* timed to compare startups with a cold and a warm pipeline cache */
+  auto pipelines_start = Timer::now();
 
   /* TEST */
   if(!pipelines.emplace_back(std::make_unique<Pipeline::Vulkan>(vulkan))->create(config.shader_paths.at(0)))
     return false;
 
+  /* optional, instances are culled on the CPU without it */
+  if (!config.cull_shader.empty() && !vulkan->getGpuCulling().init(vulkan, config.cull_shader))
+    LOG_WARN("[Renderer] - GPU culling unavailable, instances are culled on the CPU");
+
+  LOG_INFO("[Renderer] - Pipelines created in {:.2f} ms ({} pipeline cache)",
+           std::chrono::duration<float, std::milli>(Timer::now() - pipelines_start).count(),
+           device_manager.isPipelineCacheWarm() ? "warm" : "cold");
+
   return true;
 }
 
 bool Renderer::beginFrame() {
-  graphics_api->beginFrame();
-  return false;
+  /* pending meshes go up at the frame boundary, spread over frames by the byte budget */
+  mesh_manager->finishMappings();
+  mesh_manager->uploadPending(upload_budget);
+
+  /* recorded by the backend ahead of the render pass, free unless instances or their meshes changed */
+  mesh_manager->cullInstances(frustum, lod_selection);
+
+  frame_active = graphics_api->beginFrame();
+  return frame_active;
 };
 
 bool Renderer::endFrame() {
+  if (!frame_active) {
+    for (std::vector<QueuedDraw> &pipeline_draws : draws)
+      pipeline_draws.clear();
+    return false;
+  }
+  frame_active = false;
+
+  draws.resize(pipelines.size());
+  instance_counts.resize(pipelines.size());
+
+  size_t queued = 0;
+  for (const std::vector<QueuedDraw> &pipeline_draws : draws)
+    queued += pipeline_draws.size();
+
+  /* written in full before the first pipeline bind, which binds the frame's records */
+  std::span<Mesh::InstanceData> instances = graphics_api->mapInstances(static_cast<uint32_t>(queued));
+  if (instances.size() != queued) {
+    LOG_ERROR("[Renderer] - Failed to map {} instance records, dropping the frame's draws", queued);
+    for (std::vector<QueuedDraw> &pipeline_draws : draws)
+      pipeline_draws.clear();
+  }
+
+  /* grouped by pipeline, so the CPU cost is one bind and one indirect batch per pipeline, not per draw */
+  uint32_t written = 0;
+  for (uint32_t pipeline = 0; pipeline < pipelines.size(); ++pipeline) {
+    if (draws[pipeline].empty() && instance_counts[pipeline] == 0)
+      continue;
+
+    pipelines[pipeline]->bind(graphics_api->getCurrentImageIndex());
+
+    /* copies of a mesh level become one instanced draw, their records laid out contiguously */
+    group_indices.clear();
+    groups.clear();
+
+    for (uint32_t index = 0; index < draws[pipeline].size(); ++index) {
+      const QueuedDraw &draw = draws[pipeline][index];
+      const uint64_t key = (uint64_t(draw.mesh) << 32) | draw.lod;
+      auto [it, inserted] = group_indices.try_emplace(key, static_cast<uint32_t>(groups.size()));
+      if (inserted)
+        groups.push_back(InstanceGroup { .mesh = draw.mesh, .lod = draw.lod, .draw = index, .first = 0, .count = 0 });
+      ++groups[it->second].count;
+    }
+
+    for (InstanceGroup &group : groups) {
+      group.first = written;
+      written += group.count;
+      group.count = 0; /* counts again as records are written */
+    }
+
+    for (const QueuedDraw &draw : draws[pipeline]) {
+      InstanceGroup &group = groups[group_indices.at((uint64_t(draw.mesh) << 32) | draw.lod)];
+      instances[group.first + group.count++] = draw.instance;
+    }
+
+    for (const InstanceGroup &group : groups) {
+      if (group.count > 1 || group.lod > 0) {
+        mesh_manager->queueDraw(group.mesh, group.lod, group.count, group.first);
+        continue;
+      }
+
+      /* a lone copy at full detail is culled per meshlet, in its own object space */
+      const glm::mat4 &model = draws[pipeline][group.draw].instance.model;
+      const glm::vec3 local_camera = glm::vec3(glm::inverse(model) * glm::vec4(camera_position, 1.0f));
+      mesh_manager->queueMeshletDraws(group.mesh, Frustum::fromMatrix(proj_view * model), local_camera, group.first);
+    }
+
+    graphics_api->flushDraws();
+    draws[pipeline].clear();
+
+    if (instance_counts[pipeline] > 0)
+      mesh_manager->drawInstances(pipeline);
+  }
+
   graphics_api->endFrame(window);
   return false;
 };
 
-bool Renderer::render(Mesh::Handle handle) {
+void Renderer::resize(uint32_t width, uint32_t height) {
+  graphics_api->resize(width, height);
+}
+
+bool Renderer::render(Mesh::Handle handle, uint32_t lod) {
+  return render(handle, glm::mat4(1.0f), lod);
+}
 
+bool Renderer::render(Mesh::Handle handle, const glm::mat4 &transform, uint32_t lod) {
   if (handle == Mesh::InvalidHandle) {
     LOG_ERROR("[Renderer] - Invalid mesh handle: {}", handle);
     return false;
   }
-  
-  // graphics_api->drawIndexed();
+
+  /* meshes still loading draw their placeholder, at its own full resolution */
+  Mesh::Handle resolved = mesh_manager->resolve(handle);
+  if (resolved != mesh_manager->getDataHandle(handle))
+    lod = 0;
+  else if (lod == AutoLOD)
+    lod = mesh_manager->selectLOD(resolved, transform, lod_selection);
+
+  if (draws.size() < pipelines.size())
+    draws.resize(pipelines.size());
+
+  draws[bound_pipeline].push_back(QueuedDraw {
+    .mesh = resolved,
+    .lod = lod,
+    .instance = Mesh::InstanceData { .model = transform, .material = bound_pipeline, .padding = {} },
+  });
   return true;
 }
 
+uint32_t Renderer::selectLOD(Mesh::Handle handle, const Camera &camera, glm::vec3 position) const {
+  float viewport_height = static_cast<float>(window->getFrameBufferSize().y);
+
+  glm::mat4 model(1.0f);
+  model[3] = glm::vec4(position, 1.0f);
+
+  return mesh_manager->selectLOD(mesh_manager->resolve(handle), model, MeshManager::LODSelection {
+    .camera_position = camera.getPosition(),
+    .projection_scale = camera.getProjectionScale(viewport_height),
+    .max_pixel_error = lod_selection.max_pixel_error,
+  });
+}
+
+size_t Renderer::reloadShader(const File::Path &path) {
+  size_t reloaded = 0;
+
+  for (std::unique_ptr<Pipeline> &pipeline : pipelines)
+    if (pipeline->usesShader(path) && pipeline->reload())
+      ++reloaded;
+
+  return reloaded;
+}
+
+MeshManager::InstanceHandle Renderer::addInstance(Mesh::Handle handle, uint32_t pipeline, const glm::mat4 &transform) {
+  if (handle == Mesh::InvalidHandle || pipeline >= pipelines.size()) {
+    LOG_ERROR("[Renderer] - Invalid instance of mesh {} with pipeline {}", handle, pipeline);
+    return MeshManager::InvalidInstance;
+  }
+
+  MeshManager::InstanceHandle instance = mesh_manager->addInstance(handle, pipeline, Mesh::InstanceData {
+    .model = transform,
+    .material = pipeline,
+    .padding = {},
+  });
+  if (instance == MeshManager::InvalidInstance)
+    return instance;
+
+  if (instance >= instance_pipelines.size())
+    instance_pipelines.resize(instance + 1, MeshManager::InvalidInstance);
+  instance_counts.resize(pipelines.size());
+
+  instance_pipelines[instance] = pipeline;
+  ++instance_counts[pipeline];
+  return instance;
+}
+
+void Renderer::removeInstance(MeshManager::InstanceHandle instance) {
+  if (instance >= instance_pipelines.size() || instance_pipelines[instance] == MeshManager::InvalidInstance)
+    return;
+
+  --instance_counts[instance_pipelines[instance]];
+  instance_pipelines[instance] = MeshManager::InvalidInstance;
+  mesh_manager->removeInstance(instance);
+}
+
+void Renderer::setCamera(const Camera &camera) {
+  proj_view = camera.getProjectionMatrix() * camera.getViewMatrix();
+  camera_position = camera.getPosition();
+  frustum = Frustum::fromMatrix(proj_view);
+
+  lod_selection.camera_position = camera_position;
+  lod_selection.projection_scale = camera.getProjectionScale(static_cast<float>(window->getFrameBufferSize().y));
+}
+
 bool Renderer::bindPipeline(uint32_t handle) {
-  std::unique_ptr<Pipeline> &pipeline = pipelines.at(handle);
-  uint32_t current_frame_index = graphics_api->getCurrentFrameIndex();
+  if (handle >= pipelines.size()) {
+    LOG_ERROR("[Renderer] - Invalid pipeline handle: {}", handle);
+    return false;
+  }
 
-  pipeline->bind(current_frame_index);
+  /* bound for real at endFrame, when the pipeline's draws are issued */
+  bound_pipeline = handle;
   return true;
 }
 
@@ -0,0 +1,565 @@
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/logging.hpp>
+
+#include <bit>
+#include <array>
+#include <limits>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+static inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline double toMiB(VkDeviceSize bytes) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+/*
+ * One VkDeviceMemory and its TLSF heap. Free regions are binned by size into
+ * FL_COUNT power-of-two classes, each split into SL_COUNT linear subclasses;
+ * two bitmaps find the first non-empty bin at least as large as a request
+ * without walking any list.
+ */
+struct Vulkan::MemoryAllocator::Block {
+  static constexpr uint32_t SL_LOG2 = 5;
+  static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+  static constexpr uint32_t SMALL_LOG2 = SL_LOG2 + 3; /* below 256 bytes the bins are linear, 8 bytes apart */
+  static constexpr VkDeviceSize SMALL_SIZE = 1ull << SMALL_LOG2;
+  static constexpr uint32_t FL_COUNT = 64 - SMALL_LOG2 + 1;
+
+  struct Region {
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t prev = NONE;      /* physical neighbours */
+    uint32_t next = NONE;
+    uint32_t prev_free = NONE; /* bin list, free regions only */
+    uint32_t next_free = NONE;
+    bool free = false;
+  };
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize size = 0;
+  void *mapped = nullptr;
+  uint32_t memory_type = 0;
+  bool linear = true;
+
+  VkDeviceSize used = 0;
+  uint32_t allocation_count = 0;
+
+  std::vector<Region> regions;
+  std::vector<uint32_t> unused_regions;
+
+  uint64_t fl_bitmap = 0;
+  std::array<uint32_t, FL_COUNT> sl_bitmaps {};
+  std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> bins;
+
+  Block(VkDeviceMemory _memory, VkDeviceSize _size, void *_mapped, uint32_t _memory_type, bool _linear) :
+    memory(_memory), size(_size), mapped(_mapped), memory_type(_memory_type), linear(_linear) {
+    for (std::array<uint32_t, SL_COUNT> &row : bins)
+      row.fill(NONE);
+
+    regions.push_back(Region { .offset = 0, .size = size });
+    insertFree(0);
+  }
+
+  static void mapping(VkDeviceSize bytes, uint32_t &fl, uint32_t &sl) {
+    if (bytes < SMALL_SIZE) {
+      fl = 0;
+      sl = static_cast<uint32_t>(bytes >> (SMALL_LOG2 - SL_LOG2));
+      return;
+    }
+
+    const uint32_t log2 = static_cast<uint32_t>(std::bit_width(bytes)) - 1;
+    fl = log2 - SMALL_LOG2 + 1;
+    sl = static_cast<uint32_t>(bytes >> (log2 - SL_LOG2)) ^ SL_COUNT;
+  }
+
+  void insertFree(uint32_t index) {
+    uint32_t fl, sl;
+    mapping(regions[index].size, fl, sl);
+
+    Region &region = regions[index];
+    region.free = true;
+    region.prev_free = NONE;
+    region.next_free = bins[fl][sl];
+    if (region.next_free != NONE)
+      regions[region.next_free].prev_free = index;
+
+    bins[fl][sl] = index;
+    sl_bitmaps[fl] |= 1u << sl;
+    fl_bitmap |= 1ull << fl;
+  }
+
+  void removeFree(uint32_t index) {
+    uint32_t fl, sl;
+    mapping(regions[index].size, fl, sl);
+
+    Region &region = regions[index];
+    if (region.prev_free != NONE)
+      regions[region.prev_free].next_free = region.next_free;
+    else
+      bins[fl][sl] = region.next_free;
+    if (region.next_free != NONE)
+      regions[region.next_free].prev_free = region.prev_free;
+
+    region.free = false;
+    region.prev_free = region.next_free = NONE;
+
+    if (bins[fl][sl] == NONE) {
+      sl_bitmaps[fl] &= ~(1u << sl);
+      if (sl_bitmaps[fl] == 0)
+        fl_bitmap &= ~(1ull << fl);
+    }
+  }
+
+  /* First free region of a bin that only holds regions of at least `bytes` */
+  uint32_t findFree(VkDeviceSize bytes) const {
+    bytes += bytes < SMALL_SIZE ? (1ull << (SMALL_LOG2 - SL_LOG2)) - 1
+                                : (1ull << (std::bit_width(bytes) - 1 - SL_LOG2)) - 1;
+
+    uint32_t fl, sl;
+    mapping(bytes, fl, sl);
+    if (fl >= FL_COUNT)
+      return NONE;
+
+    uint32_t sl_map = sl_bitmaps[fl] & (~0u << sl);
+    if (sl_map == 0) {
+      const uint64_t fl_map = fl + 1 < 64 ? fl_bitmap & (~0ull << (fl + 1)) : 0;
+      if (fl_map == 0)
+        return NONE;
+
+      fl = static_cast<uint32_t>(std::countr_zero(fl_map));
+      sl_map = sl_bitmaps[fl];
+    }
+
+    return bins[fl][std::countr_zero(sl_map)];
+  }
+
+  uint32_t newRegion() {
+    if (!unused_regions.empty()) {
+      uint32_t index = unused_regions.back();
+      unused_regions.pop_back();
+      regions[index] = Region {};
+      return index;
+    }
+
+    regions.emplace_back();
+    return static_cast<uint32_t>(regions.size() - 1);
+  }
+
+  /* Cuts `index` down to `bytes`, the remainder becomes a new region right after it */
+  uint32_t split(uint32_t index, VkDeviceSize bytes) {
+    const uint32_t rest = newRegion();
+    Region &region = regions[index];
+
+    regions[rest] = Region {
+      .offset = region.offset + bytes,
+      .size = region.size - bytes,
+      .prev = index,
+      .next = region.next,
+    };
+    if (region.next != NONE)
+      regions[region.next].prev = rest;
+
+    region.size = bytes;
+    region.next = rest;
+    return rest;
+  }
+
+  /* Folds `second` into its physical predecessor `first` */
+  void merge(uint32_t first, uint32_t second) {
+    regions[first].size += regions[second].size;
+    regions[first].next = regions[second].next;
+    if (regions[second].next != NONE)
+      regions[regions[second].next].prev = first;
+
+    unused_regions.push_back(second);
+  }
+
+  bool allocate(VkDeviceSize bytes, VkDeviceSize alignment, uint32_t &result, VkDeviceSize &offset) {
+    /* large enough for the worst-case padding, so the first candidate always fits */
+    uint32_t index = findFree(bytes + alignment - 1);
+    if (index == NONE)
+      return false;
+
+    removeFree(index);
+
+    const VkDeviceSize padding = alignUp(regions[index].offset, alignment) - regions[index].offset;
+    if (padding > 0) {
+      const uint32_t aligned = split(index, padding);
+      insertFree(index);
+      index = aligned;
+    }
+
+    if (regions[index].size > bytes)
+      insertFree(split(index, bytes));
+
+    used += bytes;
+    ++allocation_count;
+
+    result = index;
+    offset = regions[index].offset;
+    return true;
+  }
+
+  void release(uint32_t index) {
+    used -= regions[index].size;
+    --allocation_count;
+
+    const uint32_t next = regions[index].next;
+    if (next != NONE && regions[next].free) {
+      removeFree(next);
+      merge(index, next);
+    }
+
+    const uint32_t prev = regions[index].prev;
+    if (prev != NONE && regions[prev].free) {
+      removeFree(prev);
+      merge(prev, index);
+      index = prev;
+    }
+
+    insertFree(index);
+  }
+};
+
+Vulkan::MemoryAllocator::MemoryAllocator() noexcept = default;
+
+Vulkan::MemoryAllocator::~MemoryAllocator() noexcept {
+  uint32_t leaked = 0;
+  for (std::unique_ptr<Block> &block : blocks) {
+    if (!block)
+      continue;
+
+    leaked += block->allocation_count;
+    vkFreeMemory(device, block->memory, VK_NULL_HANDLE);
+  }
+
+  for (uint32_t count : dedicated_counts)
+    leaked += count;
+
+  if (leaked > 0)
+    LOG_WARN("[GraphicsAPI::Vulkan::MemoryAllocator]: {} allocations were never freed", leaked);
+}
+
+bool Vulkan::MemoryAllocator::init(DeviceManager *device_manager) {
+  device = device_manager->getDevice();
+
+  VkPhysicalDevice physical_device = device_manager->getPhysicalDevice();
+  vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+  VkPhysicalDeviceProperties properties {};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  max_allocations = properties.limits.maxMemoryAllocationCount;
+
+  dedicated_bytes.assign(memory_properties.memoryHeapCount, 0);
+  dedicated_counts.assign(memory_properties.memoryHeapCount, 0);
+
+  LOG_INFO("[GraphicsAPI::Vulkan::MemoryAllocator]: {} memory types over {} heaps, up to {} driver allocations",
+           memory_properties.memoryTypeCount, memory_properties.memoryHeapCount, max_allocations);
+  return true;
+}
+
+uint32_t Vulkan::MemoryAllocator::findMemoryType(uint32_t type_bits, VkMemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    if ((type_bits & (1u << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+      return i;
+
+  return NONE;
+}
+
+VkDeviceSize Vulkan::MemoryAllocator::getBlockSize(uint32_t memory_type) const {
+  const VkDeviceSize heap_size = memory_properties.memoryHeaps[memory_properties.memoryTypes[memory_type].heapIndex].size;
+
+  /* small heaps (BAR windows, integrated carve-outs) would be exhausted by a handful of full blocks */
+  if (heap_size <= 1024ull * 1024 * 1024)
+    return std::min(BLOCK_SIZE, heap_size / 8);
+  return BLOCK_SIZE;
+}
+
+bool Vulkan::MemoryAllocator::allocateMemory(uint32_t memory_type, VkDeviceSize size, const void *next,
+                                             VkDeviceMemory &memory, void *&mapped) {
+  if (driver_allocations >= max_allocations) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::MemoryAllocator]: Reached maxMemoryAllocationCount ({})", max_allocations);
+    return false;
+  }
+
+  VkMemoryAllocateInfo alloc_info {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .pNext = next,
+    .allocationSize = size,
+    .memoryTypeIndex = memory_type,
+  };
+
+  if (vkAllocateMemory(device, &alloc_info, VK_NULL_HANDLE, &memory) != VK_SUCCESS)
+    return false;
+
+  /* a VkDeviceMemory can only be mapped once, so every range of it shares one mapping */
+  mapped = nullptr;
+  if ((memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+      vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+    vkFreeMemory(device, memory, VK_NULL_HANDLE);
+    memory = VK_NULL_HANDLE;
+    return false;
+  }
+
+  ++driver_allocations;
+  return true;
+}
+
+bool Vulkan::MemoryAllocator::allocateFromBlocks(uint32_t memory_type, const VkMemoryRequirements &requirements,
+                                                 bool linear, Allocation &allocation) {
+  auto fill = [&](uint32_t slot, uint32_t region, VkDeviceSize offset) {
+    const Block &block = *blocks[slot];
+    allocation = Allocation {
+      .memory = block.memory,
+      .offset = offset,
+      .size = requirements.size,
+      .mapped = block.mapped ? static_cast<char *>(block.mapped) + offset : nullptr,
+      .memory_type = memory_type,
+      .block = slot,
+      .region = region,
+    };
+  };
+
+  uint32_t region = NONE;
+  VkDeviceSize offset = 0;
+  uint32_t free_slot = NONE;
+
+  for (uint32_t slot = 0; slot < blocks.size(); ++slot) {
+    Block *block = blocks[slot].get();
+    if (!block) {
+      free_slot = std::min(free_slot, slot);
+      continue;
+    }
+
+    if (block->memory_type == memory_type && block->linear == linear &&
+        block->allocate(requirements.size, requirements.alignment, region, offset)) {
+      fill(slot, region, offset);
+      return true;
+    }
+  }
+
+  const VkDeviceSize block_size = getBlockSize(memory_type);
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  void *mapped = nullptr;
+  if (!allocateMemory(memory_type, block_size, VK_NULL_HANDLE, memory, mapped))
+    return false;
+
+  if (free_slot == NONE) {
+    free_slot = static_cast<uint32_t>(blocks.size());
+    blocks.emplace_back();
+  }
+  blocks[free_slot] = std::make_unique<Block>(memory, block_size, mapped, memory_type, linear);
+
+  LOG_INFO("[GraphicsAPI::Vulkan::MemoryAllocator]: New {:.1f} MiB block for memory type {} on heap {}",
+           toMiB(block_size), memory_type, memory_properties.memoryTypes[memory_type].heapIndex);
+
+  if (!blocks[free_slot]->allocate(requirements.size, requirements.alignment, region, offset))
+    return false;
+
+  fill(free_slot, region, offset);
+  return true;
+}
+
+bool Vulkan::MemoryAllocator::allocateDedicated(uint32_t memory_type, const VkMemoryRequirements &requirements,
+                                                VkBuffer buffer, Allocation &allocation) {
+  VkMemoryDedicatedAllocateInfo dedicated_info {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .image = VK_NULL_HANDLE,
+    .buffer = buffer,
+  };
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  void *mapped = nullptr;
+  if (!allocateMemory(memory_type, requirements.size, buffer ? &dedicated_info : VK_NULL_HANDLE, memory, mapped))
+    return false;
+
+  const uint32_t heap = memory_properties.memoryTypes[memory_type].heapIndex;
+  dedicated_bytes[heap] += requirements.size;
+  ++dedicated_counts[heap];
+
+  allocation = Allocation {
+    .memory = memory,
+    .offset = 0,
+    .size = requirements.size,
+    .mapped = mapped,
+    .memory_type = memory_type,
+    .block = NONE,
+    .region = NONE,
+  };
+  return true;
+}
+
+bool Vulkan::MemoryAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags required,
+                                       VkMemoryPropertyFlags preferred, bool linear, bool dedicated,
+                                       Allocation &allocation) {
+  return allocate(requirements, required, preferred, linear, dedicated, VK_NULL_HANDLE, allocation);
+}
+
+bool Vulkan::MemoryAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags required,
+                                       VkMemoryPropertyFlags preferred, bool linear, bool dedicated, VkBuffer buffer,
+                                       Allocation &allocation) {
+  std::scoped_lock lock(mutex);
+
+  /* the preferred type first, any type with the required flags if that one is out of memory */
+  const std::array<uint32_t, 2> candidates {
+    findMemoryType(requirements.memoryTypeBits, required | preferred),
+    findMemoryType(requirements.memoryTypeBits, required),
+  };
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const uint32_t memory_type = candidates[i];
+    if (memory_type == NONE || (i > 0 && memory_type == candidates[0]))
+      continue;
+
+    const bool own = dedicated || requirements.size > getBlockSize(memory_type) / 2;
+    if (!own && allocateFromBlocks(memory_type, requirements, linear, allocation))
+      return true;
+    if (allocateDedicated(memory_type, requirements, buffer, allocation))
+      return true;
+  }
+
+  LOG_ERROR("[GraphicsAPI::Vulkan::MemoryAllocator]: Failed to allocate {} bytes of memory", requirements.size);
+  return false;
+}
+
+void Vulkan::MemoryAllocator::free(Allocation &allocation) {
+  if (!allocation)
+    return;
+
+  std::scoped_lock lock(mutex);
+
+  if (allocation.block == NONE) {
+    const uint32_t heap = memory_properties.memoryTypes[allocation.memory_type].heapIndex;
+    dedicated_bytes[heap] -= allocation.size;
+    --dedicated_counts[heap];
+
+    vkFreeMemory(device, allocation.memory, VK_NULL_HANDLE);
+    --driver_allocations;
+    allocation = {};
+    return;
+  }
+
+  std::unique_ptr<Block> &block = blocks[allocation.block];
+  block->release(allocation.region);
+
+  /* one empty block per pool stays around, so a load/unload cycle does not churn the driver */
+  if (block->allocation_count == 0) {
+    for (const std::unique_ptr<Block> &other : blocks) {
+      if (other && other != block && other->memory_type == block->memory_type && other->linear == block->linear) {
+        vkFreeMemory(device, block->memory, VK_NULL_HANDLE);
+        --driver_allocations;
+        block.reset();
+        break;
+      }
+    }
+  }
+
+  allocation = {};
+}
+
+bool Vulkan::MemoryAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required,
+                                           VkMemoryPropertyFlags preferred, VkBuffer &buffer, Allocation &allocation) {
+  VkBufferCreateInfo buffer_info {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .flags = 0,
+    .size = size,
+    .usage = usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = 0,
+    .pQueueFamilyIndices = VK_NULL_HANDLE,
+  };
+
+  if (vkCreateBuffer(device, &buffer_info, VK_NULL_HANDLE, &buffer) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::MemoryAllocator]: Failed to create buffer");
+    buffer = VK_NULL_HANDLE;
+    return false;
+  }
+
+  /* the driver can ask for a dedicated allocation, typically for resources it can place better on their own */
+  VkMemoryDedicatedRequirements dedicated {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+    .pNext = VK_NULL_HANDLE,
+    .prefersDedicatedAllocation = VK_FALSE,
+    .requiresDedicatedAllocation = VK_FALSE,
+  };
+  VkMemoryRequirements2 requirements {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+    .pNext = &dedicated,
+    .memoryRequirements = {},
+  };
+  VkBufferMemoryRequirementsInfo2 requirements_info {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+    .pNext = VK_NULL_HANDLE,
+    .buffer = buffer,
+  };
+  vkGetBufferMemoryRequirements2(device, &requirements_info, &requirements);
+
+  const bool wants_dedicated = dedicated.prefersDedicatedAllocation || dedicated.requiresDedicatedAllocation;
+  if (!allocate(requirements.memoryRequirements, required, preferred, true, wants_dedicated, buffer, allocation)) {
+    vkDestroyBuffer(device, buffer, VK_NULL_HANDLE);
+    buffer = VK_NULL_HANDLE;
+    return false;
+  }
+
+  if (vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::MemoryAllocator]: Failed to bind buffer memory");
+    destroyBuffer(buffer, allocation);
+    return false;
+  }
+
+  return true;
+}
+
+void Vulkan::MemoryAllocator::destroyBuffer(VkBuffer &buffer, Allocation &allocation) {
+  if (buffer)
+    vkDestroyBuffer(device, buffer, VK_NULL_HANDLE);
+  buffer = VK_NULL_HANDLE;
+  free(allocation);
+}
+
+std::vector<Vulkan::MemoryAllocator::Statistics> Vulkan::MemoryAllocator::getStatistics() const {
+  std::scoped_lock lock(mutex);
+
+  std::vector<Statistics> statistics(memory_properties.memoryHeapCount);
+  for (uint32_t heap = 0; heap < memory_properties.memoryHeapCount; ++heap) {
+    statistics[heap].heap_size = memory_properties.memoryHeaps[heap].size;
+    statistics[heap].reserved = statistics[heap].used = dedicated_bytes[heap];
+    statistics[heap].allocation_count = statistics[heap].dedicated_count = dedicated_counts[heap];
+  }
+
+  for (const std::unique_ptr<Block> &block : blocks) {
+    if (!block)
+      continue;
+
+    Statistics &heap = statistics[memory_properties.memoryTypes[block->memory_type].heapIndex];
+    heap.reserved += block->size;
+    heap.used += block->used;
+    heap.allocation_count += block->allocation_count;
+    ++heap.block_count;
+  }
+
+  return statistics;
+}
+
+void Vulkan::MemoryAllocator::logStatistics() const {
+  const std::vector<Statistics> statistics = getStatistics();
+  for (size_t heap = 0; heap < statistics.size(); ++heap) {
+    const Statistics &stats = statistics[heap];
+    LOG_INFO("[GraphicsAPI::Vulkan::MemoryAllocator]: Heap {}: {:.1f} MiB used, {:.1f} MiB reserved of {:.1f} MiB, "
+             "{} blocks, {} allocations ({} dedicated)",
+             heap, toMiB(stats.used), toMiB(stats.reserved), toMiB(stats.heap_size),
+             stats.block_count, stats.allocation_count, stats.dedicated_count);
+  }
+}
+
+} /* namespace Engine */
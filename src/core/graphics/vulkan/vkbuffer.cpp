@@ -5,15 +5,12 @@
 namespace Engine {
 
 UniformBufferManager::Vulkan::~Vulkan() noexcept {
-  GraphicsAPI::Vulkan::DeviceManager &device_manager = vulkan->getDeviceManager();
-  VkDevice device = device_manager.getDevice();
-  device_manager.waitIdle();
+  vulkan->getDeviceManager().waitIdle();
 
   for (auto &[_, ubo] : uniform_buffers) {          
     for (BufferFrame &bframe : ubo.frames) {
-      if (bframe.mapped) vkUnmapMemory(device, bframe.memory);
-      if (bframe.buffer) vkDestroyBuffer(device, bframe.buffer, nullptr);
-      if (bframe.memory) vkFreeMemory(device, bframe.memory, nullptr);
+      vulkan->destroyBuffer(bframe.buffer, bframe.allocation);
+      bframe.mapped = nullptr;
     }
     ubo.frames.clear();
   }
@@ -76,18 +73,18 @@ VkDescriptorBufferInfo UniformBufferManager::Vulkan::getDescriptorBufferInfo(Uni
 }
 
 bool UniformBufferManager::Vulkan::createBufferForFrame(BufferFrame &bframe, uint32_t size) const {
-  GraphicsAPI::Vulkan::DeviceManager &device_manager = vulkan->getDeviceManager();
   bframe.size = size;
 
+  /* every frame's buffer is a small range of one shared host-visible block, mapped once for all of them */
   if(!vulkan->createRawBuffer(bframe.size,
       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
       bframe.buffer,
-      bframe.memory))
+      bframe.allocation))
     return false;
 
-  VkResult result = vkMapMemory(device_manager.getDevice(), bframe.memory, 0, size, 0, &bframe.mapped);
-  if (result != VK_SUCCESS) {
+  bframe.mapped = bframe.allocation.mapped;
+  if (!bframe.mapped) {
     LOG_ERROR("[GraphicsAPI::Vulkan::UniformBufferManager]: Failed to map memory");
     return false;
   }
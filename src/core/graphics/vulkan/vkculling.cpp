@@ -0,0 +1,440 @@
+#include <core/graphics/vulkan/vkculling.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkstaging.hpp>
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/assets/vfs.hpp>
+#include <core/logging.hpp>
+
+#include <tuple>
+#include <numeric>
+#include <algorithm>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+static constexpr uint32_t STRIDE = sizeof(VkDrawIndexedIndirectCommand);
+static constexpr uint32_t BINDING_COUNT = 5; /* instances, batches, commands, counts, levels */
+
+Vulkan::GpuCulling::~GpuCulling() noexcept {
+  if (device == VK_NULL_HANDLE)
+    return;
+
+  if (pipeline != VK_NULL_HANDLE)
+    vkDestroyPipeline(device, pipeline, VK_NULL_HANDLE);
+  if (layout != VK_NULL_HANDLE)
+    vkDestroyPipelineLayout(device, layout, VK_NULL_HANDLE);
+  if (descriptor_pool != VK_NULL_HANDLE)
+    vkDestroyDescriptorPool(device, descriptor_pool, VK_NULL_HANDLE);
+  if (set_layout != VK_NULL_HANDLE)
+    vkDestroyDescriptorSetLayout(device, set_layout, VK_NULL_HANDLE);
+
+  for (Buffer *buffer : { &scene, &commands, &counts })
+    if (buffer->buffer != VK_NULL_HANDLE)
+      vulkan->getMemoryAllocator().destroyBuffer(buffer->buffer, buffer->allocation);
+}
+
+bool Vulkan::GpuCulling::init(Vulkan *_vulkan, const File::Path &shader) {
+  vulkan = _vulkan;
+  device = vulkan->getDeviceManager().getDevice();
+
+  VkPhysicalDevice physical_device = vulkan->getDeviceManager().getPhysicalDevice();
+
+  /* the device is created with every supported feature enabled */
+  VkPhysicalDeviceVulkan12Features features_12 {};
+  features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+
+  VkPhysicalDeviceFeatures2 features {};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &features_12;
+  vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+  VkPhysicalDeviceProperties properties {};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+  if (!features.features.drawIndirectFirstInstance) {
+    LOG_WARN("[GraphicsAPI::Vulkan::GpuCulling]: drawIndirectFirstInstance is not supported, GPU culling disabled");
+    return false;
+  }
+
+  count_draws = features_12.drawIndirectCount == VK_TRUE;
+  max_draw_count = features.features.multiDrawIndirect ? std::max(properties.limits.maxDrawIndirectCount, 1u) : 1u;
+  storage_alignment = std::max<VkDeviceSize>(properties.limits.minStorageBufferOffsetAlignment, 1);
+
+  /* --- Descriptors, one set per frame in flight, rewritten when the buffers change --- */
+  std::array<VkDescriptorSetLayoutBinding, BINDING_COUNT> bindings {};
+  for (uint32_t i = 0; i < BINDING_COUNT; ++i) {
+    bindings[i] = VkDescriptorSetLayoutBinding {
+      .binding            = i,
+      .descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+      .descriptorCount    = 1,
+      .stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT,
+      .pImmutableSamplers = VK_NULL_HANDLE,
+    };
+  }
+
+  VkDescriptorSetLayoutCreateInfo set_layout_info {
+    .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .pNext        = VK_NULL_HANDLE,
+    .flags        = 0,
+    .bindingCount = BINDING_COUNT,
+    .pBindings    = bindings.data(),
+  };
+
+  VkDescriptorPoolSize pool_size {
+    .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    .descriptorCount = BINDING_COUNT * MAX_FRAMES_IN_FLIGHT,
+  };
+
+  VkDescriptorPoolCreateInfo pool_info {
+    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .pNext         = VK_NULL_HANDLE,
+    .flags         = 0,
+    .maxSets       = MAX_FRAMES_IN_FLIGHT,
+    .poolSizeCount = 1,
+    .pPoolSizes    = &pool_size,
+  };
+
+  if (vkCreateDescriptorSetLayout(device, &set_layout_info, VK_NULL_HANDLE, &set_layout) != VK_SUCCESS ||
+      vkCreateDescriptorPool(device, &pool_info, VK_NULL_HANDLE, &descriptor_pool) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Failed to create descriptors");
+    return false;
+  }
+
+  std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> set_layouts;
+  set_layouts.fill(set_layout);
+
+  VkDescriptorSetAllocateInfo set_info {
+    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    .pNext              = VK_NULL_HANDLE,
+    .descriptorPool     = descriptor_pool,
+    .descriptorSetCount = MAX_FRAMES_IN_FLIGHT,
+    .pSetLayouts        = set_layouts.data(),
+  };
+
+  if (vkAllocateDescriptorSets(device, &set_info, sets.data()) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Failed to allocate descriptor sets");
+    return false;
+  }
+
+  if (!createPipeline(shader))
+    return false;
+
+  if (!count_draws)
+    LOG_WARN("[GraphicsAPI::Vulkan::GpuCulling]: drawIndirectCount is not supported, culled instances keep their draw slot");
+
+  LOG_INFO("[GraphicsAPI::Vulkan::GpuCulling]: GPU culling enabled");
+  return true;
+}
+
+bool Vulkan::GpuCulling::createPipeline(const File::Path &shader) {
+  File::Data code;
+  if (!File::load(shader, code, File::MappedFile::Access::Sequential)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Failed to read shader file: {}", shader.string());
+    return false;
+  }
+
+  if (code.size() == 0 || code.size() % sizeof(uint32_t) != 0) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: {} is not a SPIR-V module", shader.string());
+    return false;
+  }
+
+  VkShaderModuleCreateInfo module_info {
+    .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+    .pNext    = VK_NULL_HANDLE,
+    .flags    = 0,
+    .codeSize = code.size(),
+    .pCode    = reinterpret_cast<const uint32_t *>(code.data()),
+  };
+
+  VkShaderModule module = VK_NULL_HANDLE;
+  if (vkCreateShaderModule(device, &module_info, VK_NULL_HANDLE, &module) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Failed to create shader module: {}", shader.string());
+    return false;
+  }
+
+  VkPushConstantRange push_constants {
+    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+    .offset     = 0,
+    .size       = sizeof(PushConstants),
+  };
+
+  VkPipelineLayoutCreateInfo layout_info {
+    .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .pNext                  = VK_NULL_HANDLE,
+    .flags                  = 0,
+    .setLayoutCount         = 1,
+    .pSetLayouts            = &set_layout,
+    .pushConstantRangeCount = 1,
+    .pPushConstantRanges    = &push_constants,
+  };
+
+  VkComputePipelineCreateInfo pipeline_info {
+    .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .flags = 0,
+    .stage = VkPipelineShaderStageCreateInfo {
+      .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext               = VK_NULL_HANDLE,
+      .flags               = 0,
+      .stage               = VK_SHADER_STAGE_COMPUTE_BIT,
+      .module              = module,
+      .pName               = "main",
+      .pSpecializationInfo = VK_NULL_HANDLE,
+    },
+    .layout             = VK_NULL_HANDLE,
+    .basePipelineHandle = VK_NULL_HANDLE,
+    .basePipelineIndex  = -1,
+  };
+
+  bool created = vkCreatePipelineLayout(device, &layout_info, VK_NULL_HANDLE, &layout) == VK_SUCCESS;
+  if (created) {
+    pipeline_info.layout = layout;
+    created = vkCreateComputePipelines(device, vulkan->getDeviceManager().getPipelineCache(), 1, &pipeline_info,
+                                       VK_NULL_HANDLE, &pipeline) == VK_SUCCESS;
+  }
+
+  /* the pipeline keeps what it needs of the module */
+  vkDestroyShaderModule(device, module, VK_NULL_HANDLE);
+
+  if (!created) {
+    pipeline = VK_NULL_HANDLE;
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Failed to create the culling pipeline");
+    return false;
+  }
+
+  return true;
+}
+
+bool Vulkan::GpuCulling::reserve(Buffer &buffer, VkDeviceSize size, VkBufferUsageFlags usage) {
+  if (size <= buffer.size)
+    return true;
+
+  const VkDeviceSize grown = std::max(size, buffer.size * 2);
+  retire(buffer);
+
+  if (!vulkan->createRawBuffer(grown, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer.buffer, buffer.allocation)) {
+    buffer.size = 0;
+    return false;
+  }
+
+  buffer.size = grown;
+  return true;
+}
+
+void Vulkan::GpuCulling::retire(Buffer &buffer) {
+  if (buffer.buffer != VK_NULL_HANDLE) {
+    /* frames in flight may still cull or draw out of it */
+    vulkan->deferDestroy([vulkan = vulkan, retired = buffer]() mutable {
+      vulkan->getMemoryAllocator().destroyBuffer(retired.buffer, retired.allocation);
+    });
+  }
+
+  buffer.buffer = VK_NULL_HANDLE;
+  buffer.allocation = Allocation {};
+}
+
+bool Vulkan::GpuCulling::setInstances(std::span<const Instance> instances, std::span<const LOD> lods) {
+  if (!isEnabled())
+    return false;
+
+  static_assert(sizeof(GpuInstance) == 48 && sizeof(LOD) == 16);
+
+  ++version;
+  batches.clear();
+  instance_count = 0;
+  lod_count = 0;
+
+  if (instances.empty())
+    return true;
+
+  /* the shader reads levels unchecked */
+  for (const Instance &instance : instances) {
+    if (instance.lod_count == 0 || instance.first_lod + instance.lod_count > lods.size()) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Instance {} references levels outside the {} given", instance.id,
+                lods.size());
+      return false;
+    }
+  }
+
+  /* sorted so that every batch is a run of consecutive command slots */
+  std::vector<uint32_t> order(instances.size());
+  std::iota(order.begin(), order.end(), 0u);
+  std::ranges::sort(order, [instances](uint32_t a, uint32_t b) {
+    return std::tie(instances[a].group, instances[a].vertex_buffer, instances[a].index_buffer) <
+           std::tie(instances[b].group, instances[b].vertex_buffer, instances[b].index_buffer);
+  });
+
+  std::vector<GpuInstance> records;
+  std::vector<uint32_t> batch_firsts;
+  records.reserve(instances.size());
+
+  for (uint32_t index : order) {
+    const Instance &instance = instances[index];
+
+    /* a count buffer cannot be split across calls, batches never exceed what one call can draw */
+    if (batches.empty() || batches.back().group != instance.group ||
+        batches.back().vertex_buffer != instance.vertex_buffer || batches.back().index_buffer != instance.index_buffer ||
+        batches.back().count == max_draw_count) {
+      batch_firsts.push_back(static_cast<uint32_t>(records.size()));
+      batches.push_back(Batch {
+        .group = instance.group,
+        .vertex_buffer = instance.vertex_buffer,
+        .index_buffer = instance.index_buffer,
+        .first = static_cast<uint32_t>(records.size()),
+        .count = 0,
+      });
+    }
+
+    ++batches.back().count;
+    records.push_back(GpuInstance {
+      .sphere = instance.sphere,
+      .first_lod = instance.first_lod,
+      .lod_count = instance.lod_count,
+      .vertex_offset = instance.vertex_offset,
+      .batch = static_cast<uint32_t>(batches.size() - 1),
+      .id = instance.id,
+      .lod_scale = instance.lod_scale,
+      .padding = {},
+    });
+  }
+
+  const VkDeviceSize instance_bytes = records.size() * sizeof(GpuInstance);
+  const VkDeviceSize batch_bytes = batch_firsts.size() * sizeof(uint32_t);
+  const VkDeviceSize lod_bytes = lods.size_bytes();
+  batches_offset = (instance_bytes + storage_alignment - 1) / storage_alignment * storage_alignment;
+  lods_offset = (batches_offset + batch_bytes + storage_alignment - 1) / storage_alignment * storage_alignment;
+
+  /* a fresh buffer every time, frames in flight still cull the previous set */
+  retire(scene);
+  scene.size = 0;
+
+  StagingRing &ring = vulkan->getStagingRing();
+  bool uploaded =
+    reserve(scene, lods_offset + lod_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT) &&
+    reserve(commands, records.size() * STRIDE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) &&
+    reserve(counts, batch_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT) &&
+    ring.upload(records.data(), instance_bytes, scene.buffer, 0) &&
+    ring.upload(batch_firsts.data(), batch_bytes, scene.buffer, batches_offset) &&
+    ring.upload(lods.data(), lod_bytes, scene.buffer, lods_offset);
+
+  if (!uploaded) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GpuCulling]: Failed to upload {} instances", records.size());
+    batches.clear();
+    return false;
+  }
+
+  /* nothing would be drawn without it, the next frame waits for the copy */
+  vulkan->requireUpload(ring.getRecordingValue());
+  instance_count = static_cast<uint32_t>(records.size());
+  lod_count = static_cast<uint32_t>(lods.size());
+  return true;
+}
+
+void Vulkan::GpuCulling::record(VkCommandBuffer command_buffer, uint32_t frame_index) {
+  if (!isEnabled() || instance_count == 0)
+    return;
+
+  const VkDeviceSize count_bytes = batches.size() * sizeof(uint32_t);
+
+  /* the frame's fence was waited on, its set is free to rewrite */
+  VkDescriptorSet set = sets[frame_index];
+  if (set_versions[frame_index] != version) {
+    const std::array<VkDescriptorBufferInfo, BINDING_COUNT> buffer_infos {{
+      { scene.buffer, 0, instance_count * sizeof(GpuInstance) },
+      { scene.buffer, batches_offset, count_bytes },
+      { commands.buffer, 0, VkDeviceSize(instance_count) * STRIDE },
+      { counts.buffer, 0, count_bytes },
+      { scene.buffer, lods_offset, VkDeviceSize(lod_count) * sizeof(LOD) },
+    }};
+
+    std::array<VkWriteDescriptorSet, BINDING_COUNT> writes {};
+    for (uint32_t i = 0; i < BINDING_COUNT; ++i) {
+      writes[i] = VkWriteDescriptorSet {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = VK_NULL_HANDLE,
+        .dstSet           = set,
+        .dstBinding       = i,
+        .dstArrayElement  = 0,
+        .descriptorCount  = 1,
+        .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pImageInfo       = VK_NULL_HANDLE,
+        .pBufferInfo      = &buffer_infos[i],
+        .pTexelBufferView = VK_NULL_HANDLE,
+      };
+    }
+
+    vkUpdateDescriptorSets(device, BINDING_COUNT, writes.data(), 0, VK_NULL_HANDLE);
+    set_versions[frame_index] = version;
+  }
+
+  /* earlier frames may still be reading the commands and counts rewritten below */
+  VkMemoryBarrier reuse {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .pNext         = VK_NULL_HANDLE,
+    .srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                       1, &reuse, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+
+  if (count_draws) {
+    vkCmdFillBuffer(command_buffer, counts.buffer, 0, count_bytes, 0);
+
+    VkMemoryBarrier cleared {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext         = VK_NULL_HANDLE,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &cleared, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+  }
+
+  static_assert(sizeof(PushConstants) == 128);
+  PushConstants constants {
+    .planes = frustum.planes,
+    .instance_count = instance_count,
+    .compact = count_draws ? 1u : 0u,
+    .padding = {},
+    .camera = camera,
+  };
+
+  vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+  vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, VK_NULL_HANDLE);
+  vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &constants);
+  vkCmdDispatch(command_buffer, (instance_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+  VkMemoryBarrier written {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .pNext         = VK_NULL_HANDLE,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+  };
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+                       1, &written, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+}
+
+void Vulkan::GpuCulling::draw(VkCommandBuffer command_buffer, uint32_t group) {
+  if (!isEnabled() || instance_count == 0)
+    return;
+
+  for (uint32_t index = 0; index < batches.size(); ++index) {
+    const Batch &batch = batches[index];
+    if (batch.group != group)
+      continue;
+
+    vulkan->bindGeometry(command_buffer, batch.vertex_buffer, batch.index_buffer);
+
+    const VkDeviceSize offset = VkDeviceSize(batch.first) * STRIDE;
+    if (count_draws)
+      vkCmdDrawIndexedIndirectCount(command_buffer, commands.buffer, offset, counts.buffer,
+                                    VkDeviceSize(index) * sizeof(uint32_t), batch.count, STRIDE);
+    else
+      vkCmdDrawIndexedIndirect(command_buffer, commands.buffer, offset, batch.count, STRIDE);
+  }
+}
+
+} /* namespace Engine */
@@ -4,6 +4,8 @@
 #include <core/logging.hpp>
 
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <set>
 #include <span>
 
@@ -11,7 +13,22 @@ namespace Engine {
 
 using Vulkan = GraphicsAPI::Vulkan;
 
+/* VkPipelineCacheHeaderVersionOne, spelled out for headers predating it */
+struct PipelineCacheHeader {
+  uint32_t size;
+  uint32_t version;
+  uint32_t vendor_id;
+  uint32_t device_id;
+  uint8_t uuid[VK_UUID_SIZE];
+};
+
 Vulkan::DeviceManager::~DeviceManager() noexcept {
+  if (pipeline_cache != VK_NULL_HANDLE) {
+    savePipelineCache();
+    vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+    pipeline_cache = VK_NULL_HANDLE;
+  }
+
   if (device != VK_NULL_HANDLE) {
     vkDestroyDevice(device, nullptr);
     device = VK_NULL_HANDLE;
@@ -97,8 +114,13 @@ bool Vulkan::DeviceManager::findQueueFamilies(VkPhysicalDevice device) {
   std::vector<VkQueueFamilyProperties> families(count);
   vkGetPhysicalDeviceQueueFamilyProperties(device, &count, families.data());
 
+  /* set per candidate, a rejected device must not leave its families behind */
+  graphics_queue_family.reset();
+  present_queue_family.reset();
+  transfer_queue_family.reset();
+
   for (uint32_t i = 0; i < count; ++i) {
-    if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+    if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT && !graphics_queue_family.has_value()) {
       graphics_queue_family = i;
     }
 
@@ -110,16 +132,34 @@ bool Vulkan::DeviceManager::findQueueFamilies(VkPhysicalDevice device) {
       return false;
     }
 
-    if (present_support) {
+    if (present_support && !present_queue_family.has_value()) {
       present_queue_family = i;
     }
+  }
 
-    if (graphics_queue_family.has_value() &&present_queue_family.has_value())
-      return true;
+  if (!graphics_queue_family.has_value() || !present_queue_family.has_value()) {
+    LOG_WARN("[GraphicsAPI::Vulkan::DeviceManager]: Failed to find both graphics and present queue families");
+    return false;
   }
 
-  LOG_WARN("[GraphicsAPI::Vulkan::DeviceManager]: Failed to find both graphics and present queue families");
-  return false;
+  /* graphics and compute families support transfers implicitly, the fewer other capabilities the better */
+  auto transferRank = [](VkQueueFlags flags) {
+    if (flags & VK_QUEUE_GRAPHICS_BIT)
+      return 2;
+    return flags & VK_QUEUE_COMPUTE_BIT ? 1 : 0;
+  };
+
+  transfer_queue_family = graphics_queue_family;
+  for (uint32_t i = 0; i < count; ++i) {
+    constexpr VkQueueFlags TRANSFER_CAPABLE = VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_GRAPHICS_BIT;
+    if (families[i].queueCount == 0 || !(families[i].queueFlags & TRANSFER_CAPABLE))
+      continue;
+
+    if (transferRank(families[i].queueFlags) < transferRank(families[transfer_queue_family.value()].queueFlags))
+      transfer_queue_family = i;
+  }
+
+  return true;
 }
 
 bool Vulkan::DeviceManager::createLogicalDevice() {
@@ -130,7 +170,8 @@ bool Vulkan::DeviceManager::createLogicalDevice() {
 
   std::set<uint32_t> unique_families = {
     graphics_queue_family.value(),
-    present_queue_family.value()
+    present_queue_family.value(),
+    transfer_queue_family.value()
   };
 
   float priority = 1.0f;
@@ -151,6 +192,25 @@ bool Vulkan::DeviceManager::createLogicalDevice() {
   VkPhysicalDeviceFeatures features{};
   vkGetPhysicalDeviceFeatures(physical_device, &features);
 
+  /* uploads on the transfer queue are tracked with timeline semaphores, core since 1.2 */
+  VkPhysicalDeviceVulkan12Features supported_12{};
+  supported_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+
+  VkPhysicalDeviceFeatures2 supported{};
+  supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  supported.pNext = &supported_12;
+  vkGetPhysicalDeviceFeatures2(physical_device, &supported);
+
+  if (!supported_12.timelineSemaphore) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::DeviceManager]: Timeline semaphores are not supported");
+    return false;
+  }
+
+  VkPhysicalDeviceVulkan12Features features_12{};
+  features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+  features_12.timelineSemaphore = VK_TRUE;
+  features_12.drawIndirectCount = supported_12.drawIndirectCount; /* GPU culling compacts its draws with it */
+
   std::vector<const char*> required_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
   if (!checkDeviceExtensionSupport(physical_device, required_extensions)) {
@@ -160,7 +220,7 @@ bool Vulkan::DeviceManager::createLogicalDevice() {
 
   VkDeviceCreateInfo device_info{
     .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-    .pNext = nullptr,
+    .pNext = &features_12,
     .flags = 0,
     .queueCreateInfoCount = static_cast<uint32_t>(queue_infos.size()),
     .pQueueCreateInfos = queue_infos.data(),
@@ -179,8 +239,10 @@ bool Vulkan::DeviceManager::createLogicalDevice() {
 
   vkGetDeviceQueue(device, graphics_queue_family.value(), 0, &graphics_queue);
   vkGetDeviceQueue(device, present_queue_family.value(), 0, &present_queue);
+  vkGetDeviceQueue(device, transfer_queue_family.value(), 0, &transfer_queue);
 
-  LOG_INFO("[GraphicsAPI::Vulkan::DeviceManager]: Logical device created successfully");
+  LOG_INFO("[GraphicsAPI::Vulkan::DeviceManager]: Logical device created successfully, uploads on queue family {}{}",
+           transfer_queue_family.value(), hasDedicatedTransferQueue() ? " (dedicated)" : "");
 
   return true;
 }
@@ -213,6 +275,137 @@ bool Vulkan::DeviceManager::checkDeviceExtensionSupport(
   return true;
 }
 
+bool Vulkan::DeviceManager::isPipelineCacheCompatible(std::span<const char> data) const {
+  PipelineCacheHeader header;
+  if (data.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  VkPhysicalDeviceProperties props{};
+  vkGetPhysicalDeviceProperties(physical_device, &props);
+
+  return header.size >= sizeof(header) &&
+         header.size <= data.size() &&
+         header.version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendor_id == props.vendorID &&
+         header.device_id == props.deviceID &&
+         std::memcmp(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool Vulkan::DeviceManager::createPipelineCache(const File::Path &path) {
+  pipeline_cache_path = path;
+  pipeline_cache_warm = false;
+
+  File::Buffer data;
+  std::error_code error;
+  if (!path.empty() && std::filesystem::exists(path, error)) {
+    pipeline_cache_time = std::filesystem::last_write_time(path, error);
+
+    if (!File::readAll(path, data))
+      LOG_WARN("[GraphicsAPI::Vulkan::DeviceManager]: Failed to read pipeline cache `{}`", path.string());
+    else if (!isPipelineCacheCompatible(data.view())) {
+      /* another GPU or driver version, its pipelines would have to be recompiled anyway */
+      LOG_WARN("[GraphicsAPI::Vulkan::DeviceManager]: Pipeline cache `{}` was written by another device or driver, starting cold",
+               path.string());
+      data.reset();
+    }
+  }
+
+  VkPipelineCacheCreateInfo cache_info{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .initialDataSize = data.size(),
+    .pInitialData = data.data()
+  };
+
+  if (vkCreatePipelineCache(device, &cache_info, nullptr, &pipeline_cache) == VK_SUCCESS) {
+    pipeline_cache_warm = !data.empty();
+  } else {
+    /* the driver may still reject data that passed the header check, retry empty */
+    cache_info.initialDataSize = 0;
+    cache_info.pInitialData = nullptr;
+    if (data.empty() || vkCreatePipelineCache(device, &cache_info, nullptr, &pipeline_cache) != VK_SUCCESS) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::DeviceManager]: Failed to create pipeline cache");
+      return false;
+    }
+  }
+
+  if (pipeline_cache_warm)
+    LOG_INFO("[GraphicsAPI::Vulkan::DeviceManager]: Pipeline cache loaded from `{}` ({} bytes)", path.string(), data.size());
+  else
+    LOG_INFO("[GraphicsAPI::Vulkan::DeviceManager]: Pipeline cache created empty");
+  return true;
+}
+
+bool Vulkan::DeviceManager::savePipelineCache() {
+  if (pipeline_cache == VK_NULL_HANDLE || pipeline_cache_path.empty())
+    return true;
+
+  /* another run wrote the file meanwhile, keep its pipelines as well */
+  std::error_code error;
+  std::filesystem::file_time_type time = std::filesystem::last_write_time(pipeline_cache_path, error);
+  if (!error && time != pipeline_cache_time) {
+    File::Buffer data;
+    VkPipelineCache other = VK_NULL_HANDLE;
+
+    if (File::readAll(pipeline_cache_path, data) && isPipelineCacheCompatible(data.view())) {
+      VkPipelineCacheCreateInfo cache_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = data.size(),
+        .pInitialData = data.data()
+      };
+
+      if (vkCreatePipelineCache(device, &cache_info, nullptr, &other) == VK_SUCCESS) {
+        if (vkMergePipelineCaches(device, pipeline_cache, 1, &other) != VK_SUCCESS)
+          LOG_WARN("[GraphicsAPI::Vulkan::DeviceManager]: Failed to merge pipeline cache `{}`", pipeline_cache_path.string());
+        vkDestroyPipelineCache(device, other, nullptr);
+      }
+    }
+  }
+
+  size_t size = 0;
+  if (vkGetPipelineCacheData(device, pipeline_cache, &size, nullptr) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::DeviceManager]: Failed to query pipeline cache size");
+    return false;
+  }
+
+  File::Buffer data(size);
+  if (vkGetPipelineCacheData(device, pipeline_cache, &size, data.data()) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::DeviceManager]: Failed to get pipeline cache data");
+    return false;
+  }
+
+  /* written next to the file and renamed over it, a crash mid-write leaves the old cache intact */
+  File::Path temporary = pipeline_cache_path;
+  temporary += ".tmp";
+
+  {
+    std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+    ofs.write(data.data(), static_cast<std::streamsize>(size));
+    if (!ofs) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::DeviceManager]: Failed to write pipeline cache `{}`", temporary.string());
+      ofs.close();
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporary, pipeline_cache_path, error);
+  if (error) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::DeviceManager]: Failed to replace pipeline cache `{}`: {}",
+              pipeline_cache_path.string(), error.message());
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+
+  pipeline_cache_time = std::filesystem::last_write_time(pipeline_cache_path, error);
+  LOG_INFO("[GraphicsAPI::Vulkan::DeviceManager]: Pipeline cache saved to `{}` ({} bytes)", pipeline_cache_path.string(), size);
+  return true;
+}
+
 std::string_view Vulkan::DeviceManager::deviceTypeToString(VkPhysicalDeviceType type) {
   switch (type) {
     case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: 
@@ -0,0 +1,167 @@
+#include <core/graphics/vulkan/vkgeometry.hpp>
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/logging.hpp>
+
+#include <algorithm>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+Vulkan::GeometryArena::~GeometryArena() noexcept {
+  for (PagePool &pool : pools)
+    for (Page &page : pool.pages)
+      if (page.buffer != VK_NULL_HANDLE)
+        allocator->destroyBuffer(page.buffer, page.allocation);
+}
+
+bool Vulkan::GeometryArena::init(Vulkan *_vulkan) {
+  vulkan = _vulkan;
+  allocator = &vulkan->getMemoryAllocator();
+
+  pools[static_cast<size_t>(Pool::Vertex)] = PagePool {
+    .pages = {},
+    .page_size = VERTEX_PAGE,
+    .stride = getStride(Pool::Vertex),
+    .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  };
+  pools[static_cast<size_t>(Pool::Index)] = PagePool {
+    .pages = {},
+    .page_size = INDEX_PAGE,
+    .stride = getStride(Pool::Index),
+    .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  };
+
+  /* the first page of each pool up front, most scenes never need a second one */
+  uint32_t index = 0;
+  for (PagePool &pool : pools) {
+    if (!addPage(pool, pool.page_size, index)) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::GeometryArena]: Failed to create the initial pages");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Vulkan::GeometryArena::addPage(PagePool &pool, uint32_t capacity, uint32_t &index) {
+  auto slot = std::ranges::find(pool.pages, VkBuffer(VK_NULL_HANDLE), &Page::buffer);
+  index = static_cast<uint32_t>(slot - pool.pages.begin());
+  if (slot == pool.pages.end())
+    pool.pages.emplace_back();
+
+  Page &page = pool.pages[index];
+  if (!allocator->createBuffer(capacity * pool.stride, pool.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+                               page.buffer, page.allocation)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::GeometryArena]: Failed to create a page of {} elements", capacity);
+    return false;
+  }
+
+  page.capacity = capacity;
+  page.used = 0;
+  page.free_ranges = { { 0u, capacity } };
+  return true;
+}
+
+bool Vulkan::GeometryArena::allocateFrom(Page &page, uint32_t count, uint32_t &first) {
+  if (page.buffer == VK_NULL_HANDLE || page.capacity - page.used < count)
+    return false;
+
+  auto it = std::ranges::find_if(page.free_ranges, [count](const auto &range) { return range.second >= count; });
+  if (it == page.free_ranges.end())
+    return false;
+
+  first = it->first;
+  const uint32_t rest = it->second - count;
+  page.free_ranges.erase(it);
+  if (rest > 0)
+    page.free_ranges.emplace(first + count, rest);
+
+  page.used += count;
+  return true;
+}
+
+bool Vulkan::GeometryArena::allocate(Pool pool_id, uint32_t count, Range &range) {
+  range = Range {};
+  if (count == 0)
+    return true;
+
+  PagePool &pool = pools[static_cast<size_t>(pool_id)];
+
+  for (uint32_t i = 0; i < pool.pages.size(); ++i) {
+    if (allocateFrom(pool.pages[i], count, range.first)) {
+      range.page = i;
+      range.count = count;
+      return true;
+    }
+  }
+
+  uint32_t index = 0;
+  if (!addPage(pool, std::max(count, pool.page_size), index) || !allocateFrom(pool.pages[index], count, range.first))
+    return false;
+
+  range.page = index;
+  range.count = count;
+  return true;
+}
+
+void Vulkan::GeometryArena::free(Pool pool_id, Range &range) {
+  if (!range)
+    return;
+
+  PagePool &pool = pools[static_cast<size_t>(pool_id)];
+  Page &page = pool.pages[range.page];
+
+  const uint32_t range_page = range.page;
+  uint32_t first = range.first;
+  uint32_t count = range.count;
+  range = Range {};
+
+  page.used -= count;
+
+  /*
+   * Empty pages go back to the allocator, except the first one every pool starts with.
+   * Frames in flight may still bind the buffer for other draws, the slot is reusable right away.
+   */
+  if (page.used == 0 && range_page > 0) {
+    vulkan->deferDestroy([allocator = allocator, retired = page.buffer, allocation = page.allocation]() mutable {
+      allocator->destroyBuffer(retired, allocation);
+    });
+    page = Page {};
+    return;
+  }
+
+  auto next = page.free_ranges.lower_bound(first);
+  if (next != page.free_ranges.end() && next->first == first + count) {
+    count += next->second;
+    next = page.free_ranges.erase(next);
+  }
+
+  if (next != page.free_ranges.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == first) {
+      prev->second += count;
+      return;
+    }
+  }
+
+  page.free_ranges.emplace_hint(next, first, count);
+}
+
+Vulkan::GeometryArena::Statistics Vulkan::GeometryArena::getStatistics(Pool pool_id) const {
+  const PagePool &pool = pools[static_cast<size_t>(pool_id)];
+  Statistics stats {};
+
+  for (const Page &page : pool.pages) {
+    if (page.buffer == VK_NULL_HANDLE)
+      continue;
+
+    ++stats.page_count;
+    stats.reserved += page.capacity * getStride(pool_id);
+    stats.used += page.used * getStride(pool_id);
+  }
+
+  return stats;
+}
+
+} /* namespace Engine */
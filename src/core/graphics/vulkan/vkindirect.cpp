@@ -0,0 +1,158 @@
+#include <core/graphics/vulkan/vkindirect.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/logging.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+static constexpr VkMemoryPropertyFlags HOST_MEMORY = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+static constexpr uint32_t STRIDE = sizeof(VkDrawIndexedIndirectCommand);
+
+Vulkan::IndirectDraws::~IndirectDraws() noexcept {
+  if (vulkan == nullptr)
+    return;
+
+  for (FrameBuffer &frame_buffer : frames)
+    vulkan->getMemoryAllocator().destroyBuffer(frame_buffer.buffer, frame_buffer.allocation);
+}
+
+bool Vulkan::IndirectDraws::init(Vulkan *_vulkan) {
+  vulkan = _vulkan;
+
+  VkPhysicalDevice physical_device = vulkan->getDeviceManager().getPhysicalDevice();
+
+  /* the device is created with every supported feature enabled */
+  VkPhysicalDeviceFeatures features {};
+  vkGetPhysicalDeviceFeatures(physical_device, &features);
+  VkPhysicalDeviceProperties properties {};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+  multi_draw = features.multiDrawIndirect == VK_TRUE;
+  first_instance = features.drawIndirectFirstInstance == VK_TRUE;
+  max_draw_count = multi_draw ? std::max(properties.limits.maxDrawIndirectCount, 1u) : 1u;
+
+  for (FrameBuffer &frame_buffer : frames) {
+    if (!reserve(frame_buffer, INITIAL_CAPACITY)) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::IndirectDraws]: Failed to create indirect buffers");
+      return false;
+    }
+  }
+
+  if (!multi_draw)
+    LOG_WARN("[GraphicsAPI::Vulkan::IndirectDraws]: multiDrawIndirect is not supported, issuing one indirect call per draw");
+  if (!first_instance)
+    LOG_WARN("[GraphicsAPI::Vulkan::IndirectDraws]: drawIndirectFirstInstance is not supported, issuing direct draws");
+
+  return true;
+}
+
+bool Vulkan::IndirectDraws::reserve(FrameBuffer &frame_buffer, uint32_t draw_count) {
+  if (draw_count <= frame_buffer.capacity)
+    return true;
+
+  const uint32_t capacity = std::max(draw_count, frame_buffer.capacity * 2);
+
+  /* device-local when the host can write it directly, the GPU reads every record once per frame */
+  FrameBuffer grown { .capacity = capacity };
+  if (!vulkan->getMemoryAllocator().createBuffer(VkDeviceSize(capacity) * STRIDE, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                                 HOST_MEMORY, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 grown.buffer, grown.allocation)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::IndirectDraws]: Failed to create an indirect buffer of {} draws", capacity);
+    return false;
+  }
+
+  if (frame_buffer.buffer != VK_NULL_HANDLE) {
+    /* earlier flushes of this frame read the old buffer, it goes once the frame is done */
+    std::memcpy(grown.allocation.mapped, frame_buffer.allocation.mapped, VkDeviceSize(written) * STRIDE);
+    vulkan->deferDestroy([vulkan = vulkan, retired = frame_buffer]() mutable {
+      vulkan->getMemoryAllocator().destroyBuffer(retired.buffer, retired.allocation);
+    });
+  }
+
+  frame_buffer = grown;
+  return true;
+}
+
+void Vulkan::IndirectDraws::begin(uint32_t frame_index) {
+  frame = frame_index;
+  written = 0;
+  queued = 0;
+  for (Batch &batch : batches)
+    batch.commands.clear();
+}
+
+void Vulkan::IndirectDraws::queue(const DrawInfo::Vulkan &draw) {
+  if (draw.index_count == 0 || draw.instance_count == 0)
+    return;
+
+  /* a handful of arena pages at most, a linear search beats hashing */
+  auto batch = std::ranges::find_if(batches, [&draw](const Batch &candidate) {
+    return candidate.vertex_buffer == draw.vertex_buffer && candidate.index_buffer == draw.index_buffer;
+  });
+
+  if (batch == batches.end()) {
+    auto unused = std::ranges::find_if(batches, [](const Batch &candidate) { return candidate.commands.empty(); });
+    batch = unused != batches.end() ? unused : batches.insert(batches.end(), Batch {});
+    batch->vertex_buffer = draw.vertex_buffer;
+    batch->index_buffer = draw.index_buffer;
+  }
+
+  batch->commands.push_back(VkDrawIndexedIndirectCommand {
+    .indexCount = draw.index_count,
+    .instanceCount = draw.instance_count,
+    .firstIndex = draw.first_index,
+    .vertexOffset = draw.vertex_offset,
+    .firstInstance = draw.first_instance,
+  });
+  ++queued;
+}
+
+bool Vulkan::IndirectDraws::flush(VkCommandBuffer command_buffer) {
+  if (queued == 0)
+    return true;
+
+  FrameBuffer &frame_buffer = frames[frame];
+  bool reserved = reserve(frame_buffer, written + queued);
+  queued = 0;
+
+  for (Batch &batch : batches) {
+    if (batch.commands.empty() || !reserved) {
+      batch.commands.clear();
+      continue;
+    }
+
+    vulkan->bindGeometry(command_buffer, batch.vertex_buffer, batch.index_buffer);
+
+    /* indirect records would need firstInstance 0, instanced draws address their records through it */
+    if (!first_instance) {
+      for (const VkDrawIndexedIndirectCommand &command : batch.commands)
+        vkCmdDrawIndexed(command_buffer, command.indexCount, command.instanceCount, command.firstIndex,
+                         command.vertexOffset, command.firstInstance);
+      batch.commands.clear();
+      continue;
+    }
+
+    const uint32_t count = static_cast<uint32_t>(batch.commands.size());
+    std::memcpy(static_cast<VkDrawIndexedIndirectCommand *>(frame_buffer.allocation.mapped) + written,
+                batch.commands.data(), VkDeviceSize(count) * STRIDE);
+
+    for (uint32_t issued = 0; issued < count;) {
+      const uint32_t draw_count = std::min(count - issued, max_draw_count);
+      vkCmdDrawIndexedIndirect(command_buffer, frame_buffer.buffer, VkDeviceSize(written + issued) * STRIDE,
+                               draw_count, STRIDE);
+      issued += draw_count;
+    }
+
+    written += count;
+    batch.commands.clear();
+  }
+
+  return reserved;
+}
+
+} /* namespace Engine */
@@ -0,0 +1,212 @@
+#include <core/graphics/vulkan/vkinstances.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkstaging.hpp>
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/logging.hpp>
+
+#include <algorithm>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+static constexpr VkMemoryPropertyFlags HOST_MEMORY = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+static constexpr VkDeviceSize RECORD_SIZE = sizeof(Mesh::InstanceData);
+
+Vulkan::InstanceBuffer::~InstanceBuffer() noexcept {
+  if (device == VK_NULL_HANDLE)
+    return;
+
+  for (Buffer &frame : frames)
+    if (frame.buffer != VK_NULL_HANDLE)
+      vulkan->getMemoryAllocator().destroyBuffer(frame.buffer, frame.allocation);
+
+  if (persistent.buffer != VK_NULL_HANDLE)
+    vulkan->getMemoryAllocator().destroyBuffer(persistent.buffer, persistent.allocation);
+
+  if (descriptor_pool != VK_NULL_HANDLE)
+    vkDestroyDescriptorPool(device, descriptor_pool, VK_NULL_HANDLE);
+  if (set_layout != VK_NULL_HANDLE)
+    vkDestroyDescriptorSetLayout(device, set_layout, VK_NULL_HANDLE);
+}
+
+bool Vulkan::InstanceBuffer::init(Vulkan *_vulkan) {
+  vulkan = _vulkan;
+  device = vulkan->getDeviceManager().getDevice();
+
+  VkDescriptorSetLayoutBinding binding {
+    .binding            = 0,
+    .descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    .descriptorCount    = 1,
+    .stageFlags         = VK_SHADER_STAGE_VERTEX_BIT,
+    .pImmutableSamplers = VK_NULL_HANDLE,
+  };
+
+  VkDescriptorSetLayoutCreateInfo set_layout_info {
+    .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .pNext        = VK_NULL_HANDLE,
+    .flags        = 0,
+    .bindingCount = 1,
+    .pBindings    = &binding,
+  };
+
+  /* the frame's set and the persistent one, for every frame in flight */
+  VkDescriptorPoolSize pool_size {
+    .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    .descriptorCount = 2 * MAX_FRAMES_IN_FLIGHT,
+  };
+
+  VkDescriptorPoolCreateInfo pool_info {
+    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .pNext         = VK_NULL_HANDLE,
+    .flags         = 0,
+    .maxSets       = 2 * MAX_FRAMES_IN_FLIGHT,
+    .poolSizeCount = 1,
+    .pPoolSizes    = &pool_size,
+  };
+
+  if (vkCreateDescriptorSetLayout(device, &set_layout_info, VK_NULL_HANDLE, &set_layout) != VK_SUCCESS ||
+      vkCreateDescriptorPool(device, &pool_info, VK_NULL_HANDLE, &descriptor_pool) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::InstanceBuffer]: Failed to create descriptors");
+    return false;
+  }
+
+  std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> set_layouts;
+  set_layouts.fill(set_layout);
+
+  VkDescriptorSetAllocateInfo set_info {
+    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    .pNext              = VK_NULL_HANDLE,
+    .descriptorPool     = descriptor_pool,
+    .descriptorSetCount = MAX_FRAMES_IN_FLIGHT,
+    .pSetLayouts        = set_layouts.data(),
+  };
+
+  if (vkAllocateDescriptorSets(device, &set_info, frame_sets.data()) != VK_SUCCESS ||
+      vkAllocateDescriptorSets(device, &set_info, persistent_sets.data()) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::InstanceBuffer]: Failed to allocate descriptor sets");
+    return false;
+  }
+
+  for (uint32_t frame_index = 0; frame_index < MAX_FRAMES_IN_FLIGHT; ++frame_index) {
+    if (!createFrameBuffer(frame_index, INITIAL_CAPACITY)) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::InstanceBuffer]: Failed to create instance buffers");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Vulkan::InstanceBuffer::writeSet(VkDescriptorSet set, VkBuffer buffer, uint32_t capacity) {
+  VkDescriptorBufferInfo buffer_info {
+    .buffer = buffer,
+    .offset = 0,
+    .range  = capacity * RECORD_SIZE,
+  };
+
+  VkWriteDescriptorSet write {
+    .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+    .pNext            = VK_NULL_HANDLE,
+    .dstSet           = set,
+    .dstBinding       = 0,
+    .dstArrayElement  = 0,
+    .descriptorCount  = 1,
+    .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    .pImageInfo       = VK_NULL_HANDLE,
+    .pBufferInfo      = &buffer_info,
+    .pTexelBufferView = VK_NULL_HANDLE,
+  };
+
+  vkUpdateDescriptorSets(device, 1, &write, 0, VK_NULL_HANDLE);
+}
+
+bool Vulkan::InstanceBuffer::createFrameBuffer(uint32_t frame_index, uint32_t capacity) {
+  Buffer &frame = frames[frame_index];
+
+  /* only called once the frame's fence was waited on, nothing reads the old buffer anymore */
+  if (frame.buffer != VK_NULL_HANDLE)
+    vulkan->getMemoryAllocator().destroyBuffer(frame.buffer, frame.allocation);
+  frame.capacity = 0;
+
+  /* device-local when the host can write it directly, every record is read once per frame */
+  if (!vulkan->getMemoryAllocator().createBuffer(capacity * RECORD_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                 HOST_MEMORY, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 frame.buffer, frame.allocation)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::InstanceBuffer]: Failed to create an instance buffer of {} records", capacity);
+    return false;
+  }
+
+  frame.capacity = capacity;
+  writeSet(frame_sets[frame_index], frame.buffer, capacity);
+  return true;
+}
+
+std::span<Mesh::InstanceData> Vulkan::InstanceBuffer::map(uint32_t frame_index, uint32_t count) {
+  Buffer &frame = frames[frame_index];
+
+  if (count > frame.capacity && !createFrameBuffer(frame_index, std::max(count, frame.capacity * 2)))
+    return {};
+
+  return { static_cast<Mesh::InstanceData *>(frame.allocation.mapped), count };
+}
+
+void Vulkan::InstanceBuffer::bind(VkCommandBuffer command_buffer, VkPipelineLayout layout, uint32_t frame_index) {
+  vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, SET, 1, &frame_sets[frame_index],
+                          0, VK_NULL_HANDLE);
+  bound_layout = layout;
+  bound_frame = frame_index;
+}
+
+bool Vulkan::InstanceBuffer::setPersistent(std::span<const Mesh::InstanceData> records) {
+  ++persistent_version;
+
+  if (persistent.buffer != VK_NULL_HANDLE) {
+    /* frames in flight may still draw out of it */
+    vulkan->deferDestroy([vulkan = vulkan, retired = persistent]() mutable {
+      vulkan->getMemoryAllocator().destroyBuffer(retired.buffer, retired.allocation);
+    });
+    persistent = Buffer {};
+  }
+
+  if (records.empty())
+    return true;
+
+  const uint32_t capacity = static_cast<uint32_t>(records.size());
+  if (!vulkan->createRawBuffer(capacity * RECORD_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, persistent.buffer, persistent.allocation))
+    return false;
+
+  StagingRing &ring = vulkan->getStagingRing();
+  if (!ring.upload(records.data(), records.size_bytes(), persistent.buffer)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::InstanceBuffer]: Failed to upload {} persistent records", capacity);
+    ring.onComplete([vulkan = vulkan, retired = persistent](bool) mutable {
+      vulkan->getMemoryAllocator().destroyBuffer(retired.buffer, retired.allocation);
+    });
+    persistent = Buffer {};
+    return false;
+  }
+
+  /* instances cannot be drawn without their records, the next frame waits for the copy */
+  vulkan->requireUpload(ring.getRecordingValue());
+  persistent.capacity = capacity;
+  return true;
+}
+
+bool Vulkan::InstanceBuffer::bindPersistent(VkCommandBuffer command_buffer) {
+  if (persistent.buffer == VK_NULL_HANDLE || bound_layout == VK_NULL_HANDLE)
+    return false;
+
+  /* the set is not bound in this frame yet, setPersistent only runs between frames */
+  VkDescriptorSet set = persistent_sets[bound_frame];
+  if (persistent_set_versions[bound_frame] != persistent_version) {
+    writeSet(set, persistent.buffer, persistent.capacity);
+    persistent_set_versions[bound_frame] = persistent_version;
+  }
+
+  vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bound_layout, SET, 1, &set,
+                          0, VK_NULL_HANDLE);
+  return true;
+}
+
+} /* namespace Engine */
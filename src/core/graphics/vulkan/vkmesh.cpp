@@ -1,68 +1,415 @@
 #include <core/graphics/vulkan/vkmesh.hpp>
 #include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkstaging.hpp>
+#include <core/graphics/vulkan/vkindirect.hpp>
+#include <core/graphics/vulkan/vkculling.hpp>
+#include <core/graphics/vulkan/vkinstances.hpp>
+#include <core/logging.hpp>
 #include <memory>
+#include <algorithm>
+#include <unordered_map>
 
 namespace Engine {
 
 MeshManager::Vulkan::~Vulkan() noexcept {
-  auto &device_manager = vulkan->getDeviceManager();
-  VkDevice device = device_manager.getDevice();
-  device_manager.waitIdle();
-  
+  /* let pending uploads land so their ranges are owned by a mesh again */
+  GraphicsAPI::Vulkan::StagingRing &ring = vulkan->getStagingRing();
+  ring.submit();
+  vulkan->getDeviceManager().waitIdle();
+  ring.reclaim();
+
   for (std::unique_ptr<MeshInfo> &mesh_data : meshes) {
-    auto vk_mesh_data = static_cast<MeshInfo::Vulkan *>(mesh_data.get());
+    auto &vk_mesh_data = static_cast<MeshInfo::Vulkan &>(*mesh_data);
+    freeRanges(vulkan, vk_mesh_data.vertices, vk_mesh_data.indices);
+  }
+}
+
+std::unique_ptr<MeshInfo> MeshManager::Vulkan::createInfo() const {
+  return std::make_unique<MeshInfo::Vulkan>();
+}
+
+void MeshManager::Vulkan::releaseGPU(MeshInfo &mesh_data) {
+  auto &vk_mesh_data = static_cast<MeshInfo::Vulkan &>(mesh_data);
+  if (!vk_mesh_data.vertices && !vk_mesh_data.indices)
+    return;
+
+  /* frames in flight may still read the ranges, hand them off instead of waiting */
+  retireRanges(vk_mesh_data.vertices, vk_mesh_data.indices);
+
+  vk_mesh_data.vertices = {};
+  vk_mesh_data.indices = {};
+  ++geometry_version;
+}
+
+void MeshManager::Vulkan::retireRanges(const MeshInfo::Vulkan::Range &vertices, const MeshInfo::Vulkan::Range &indices) {
+  if (!vertices && !indices)
+    return;
+
+  vulkan->deferDestroy([vulkan = vulkan, vertices = vertices, indices = indices]() mutable {
+    freeRanges(vulkan, vertices, indices);
+  });
+}
 
-    if (vk_mesh_data->vertex_buffer)
-      vkDestroyBuffer(device, vk_mesh_data->vertex_buffer, VK_NULL_HANDLE);
-    if (vk_mesh_data->index_buffer)
-      vkDestroyBuffer(device, vk_mesh_data->index_buffer, VK_NULL_HANDLE);
+void MeshManager::Vulkan::freeRanges(GraphicsAPI::Vulkan *vulkan, MeshInfo::Vulkan::Range &vertices,
+                                     MeshInfo::Vulkan::Range &indices) {
+  GraphicsAPI::Vulkan::GeometryArena &arena = vulkan->getGeometryArena();
+  arena.free(GraphicsAPI::Vulkan::GeometryArena::Pool::Vertex, vertices);
+  arena.free(GraphicsAPI::Vulkan::GeometryArena::Pool::Index, indices);
+}
+
+Mesh::StagingAllocator MeshManager::Vulkan::getStagingAllocator() {
+  return [vulkan = vulkan](size_t vertex_count, size_t index_count) -> std::shared_ptr<Mesh::Staging> {
+    if (vertex_count == 0 || index_count == 0)
+      return nullptr;
+
+    auto staging = std::make_shared<Staging>(vulkan, vertex_count, index_count);
+    size_t size = staging->getVertexBytes() + staging->getIndexBytes();
+
+    if (!vulkan->createStagingBuffer(size, staging->buffer, staging->allocation))
+      return nullptr;
+
+    return staging;
+  };
+}
+
+bool MeshManager::Vulkan::allocateRanges(MeshInfo::Vulkan::Upload &upload, size_t vertex_count, size_t index_count) {
+  using Pool = GraphicsAPI::Vulkan::GeometryArena::Pool;
+  GraphicsAPI::Vulkan::GeometryArena &arena = vulkan->getGeometryArena();
+  if (!arena.allocate(Pool::Vertex, static_cast<uint32_t>(vertex_count), upload.vertices))
+    return false;
 
-    if (vk_mesh_data->vertex_memory)
-      vkFreeMemory(device, vk_mesh_data->vertex_memory, VK_NULL_HANDLE);
-    if (vk_mesh_data->index_memory)
-      vkFreeMemory(device, vk_mesh_data->index_memory, VK_NULL_HANDLE);
+  /* nothing has been recorded against the vertex range yet, it can go back right away */
+  if (!arena.allocate(Pool::Index, static_cast<uint32_t>(index_count), upload.indices)) {
+    arena.free(Pool::Vertex, upload.vertices);
+    return false;
   }
+  return true;
 }
 
-Mesh::Handle MeshManager::Vulkan::addMesh(Mesh &mesh) {
-  auto data = std::make_unique<MeshInfo::Vulkan>();
-  auto vertices = mesh.getVerticesView();
-  auto indices = mesh.getIndicesView();
+/* Queues the contents of an arena range, copied out of `source`, or out of `data` when there is no source buffer */
+static bool uploadRange(GraphicsAPI::Vulkan *vulkan, GraphicsAPI::Vulkan::GeometryArena::Pool pool,
+                        const MeshInfo::Vulkan::Range &range, VkBuffer source, VkDeviceSize source_offset,
+                        const void *data) {
+  if (!range)
+    return true;
+
+  GraphicsAPI::Vulkan::GeometryArena &arena = vulkan->getGeometryArena();
+  GraphicsAPI::Vulkan::StagingRing &ring = vulkan->getStagingRing();
+  const VkDeviceSize bytes = range.count * GraphicsAPI::Vulkan::GeometryArena::getStride(pool);
+
+  if (source != VK_NULL_HANDLE)
+    return ring.copy(source, source_offset, arena.getBuffer(pool, range), arena.getOffset(pool, range), bytes);
+  return ring.upload(data, bytes, arena.getBuffer(pool, range), arena.getOffset(pool, range));
+}
+
+bool MeshManager::Vulkan::uploadStaged(const std::shared_ptr<Staging> &staging, MeshInfo::Vulkan::Upload &upload) {
+  if (!allocateRanges(upload, staging->vertex_count, staging->index_count))
+    return false;
+
+  /* the importer already wrote the final layout, the staging buffer is copied as is */
+  using Pool = GraphicsAPI::Vulkan::GeometryArena::Pool;
+  return uploadRange(vulkan, Pool::Vertex, upload.vertices, staging->buffer, 0, nullptr) &&
+         uploadRange(vulkan, Pool::Index, upload.indices, staging->buffer, staging->getVertexBytes(), nullptr);
+}
 
-  data->cpu_vertices.assign(vertices.begin(), vertices.end());
-  data->cpu_indices.assign(indices.begin(), indices.end());
+bool MeshManager::Vulkan::uploadHost(const MeshInfo &mesh_data, MeshInfo::Vulkan::Upload &upload) {
+  std::span<const Mesh::Vertex> vertices = mesh_data.getVertices();
+  std::span<const Mesh::Index> indices = mesh_data.getIndices();
 
-  data->gpu_uploaded = false;
-  data->alive = true;
+  if (!allocateRanges(upload, vertices.size(), indices.size()))
+    return false;
 
-  Mesh::Handle handle = meshes.size();
-  meshes.push_back(std::move(data));
-  return handle;
+  /* copied into the ring right away, the CPU copy may go before the batch completes */
+  using Pool = GraphicsAPI::Vulkan::GeometryArena::Pool;
+  return uploadRange(vulkan, Pool::Vertex, upload.vertices, VK_NULL_HANDLE, 0, vertices.data()) &&
+         uploadRange(vulkan, Pool::Index, upload.indices, VK_NULL_HANDLE, 0, indices.data());
 }
 
-void MeshManager::Vulkan::uploadPending() {
+void MeshManager::Vulkan::completeUpload(MeshInfo::Vulkan &vk_mesh_data, bool completed) {
+  std::unique_ptr<MeshInfo::Vulkan::Upload> upload = std::move(vk_mesh_data.upload);
+
+  /* the batch never reached the GPU, the ranges hold nothing and the mesh keeps what it draws */
+  if (!completed) {
+    LOG_ERROR("[MeshManager::Vulkan]: Mesh upload failed, it is retried once the mesh is updated");
+    vk_mesh_data.failed_revision = upload->revision;
+    retireRanges(upload->vertices, upload->indices);
+    return;
+  }
+
+  /*
+   * Runs from StagingRing::reclaim(), before the next frame records the acquire barriers
+   * of the batch: the ranges and their pages have to outlive that frame.
+   */
+  if (!vk_mesh_data.alive) {
+    retireRanges(upload->vertices, upload->indices);
+    return;
+  }
+
+  /* reloaded meshes keep drawing their old ranges up to this point */
+  releaseGPU(vk_mesh_data);
+
+  vk_mesh_data.vertices = upload->vertices;
+  vk_mesh_data.indices = upload->indices;
+  ++geometry_version;
+
+  /* updated while in flight, the newer data still has to go up */
+  if (upload->revision == vk_mesh_data.revision)
+    markUploaded(vk_mesh_data);
+}
+
+bool MeshManager::Vulkan::getDraw(const MeshInfo::Vulkan &vk_mesh_data, uint32_t lod, DrawInfo::Vulkan &draw) const {
+  if (!vk_mesh_data.vertices || !vk_mesh_data.indices)
+    return false;
+
+  /* while an update is in flight the levels describe the new data, the old ranges are drawn whole */
+  Mesh::IndexRange range { .first_index = 0, .index_count = vk_mesh_data.indices.count };
+  if (vk_mesh_data.gpu_uploaded && lod < vk_mesh_data.lods.size())
+    range = vk_mesh_data.lods[lod].range;
+
+  using Pool = GraphicsAPI::Vulkan::GeometryArena::Pool;
+  GraphicsAPI::Vulkan::GeometryArena &arena = vulkan->getGeometryArena();
+
+  draw.index_count = range.index_count;
+  draw.vertex_buffer = arena.getBuffer(Pool::Vertex, vk_mesh_data.vertices);
+  draw.index_buffer = arena.getBuffer(Pool::Index, vk_mesh_data.indices);
+  draw.vertex_offset = vk_mesh_data.getVertexOffset();
+  draw.first_index = vk_mesh_data.getFirstIndex() + range.first_index;
+  return true;
+}
+
+bool MeshManager::Vulkan::queueDraw(Mesh::Handle handle, uint32_t lod, uint32_t instance_count, uint32_t first_instance) {
+  DrawInfo::Vulkan draw {};
+  if (!getDraw(static_cast<MeshInfo::Vulkan &>(get(handle)), lod, draw))
+    return false;
+
+  draw.instance_count = instance_count;
+  draw.first_instance = first_instance;
+
+  vulkan->getIndirectDraws().queue(draw);
+  return true;
+}
+
+bool MeshManager::Vulkan::queueMeshletDraws(Mesh::Handle handle, const Frustum &local_frustum, glm::vec3 camera_position,
+                                            uint32_t first_instance) {
+  auto &vk_mesh_data = static_cast<MeshInfo::Vulkan &>(get(handle));
+
+  /* the meshlets describe the uploaded data, an update in flight is drawn whole */
+  if (!vk_mesh_data.gpu_uploaded || vk_mesh_data.meshlets.empty())
+    return queueDraw(handle, 0, 1, first_instance);
+
+  DrawInfo::Vulkan draw {};
+  if (!getDraw(vk_mesh_data, 0, draw))
+    return false;
+
+  meshlet_ranges.clear();
+  cullMeshlets(handle, local_frustum, camera_position, meshlet_ranges);
+
+  /* one command per run of surviving meshlets, they share the instance and the pages */
+  draw.instance_count = 1;
+  draw.first_instance = first_instance;
+  for (const Mesh::IndexRange &range : meshlet_ranges) {
+    draw.index_count = range.index_count;
+    draw.first_index = vk_mesh_data.getFirstIndex() + range.first_index;
+    vulkan->getIndirectDraws().queue(draw);
+  }
+
+  return true;
+}
+
+MeshManager::InstanceHandle MeshManager::Vulkan::addInstance(Mesh::Handle handle, uint32_t group,
+                                                             const Mesh::InstanceData &data) {
+  InstanceHandle instance = static_cast<InstanceHandle>(instances.size());
+  if (!free_instances.empty()) {
+    instance = free_instances.back();
+    free_instances.pop_back();
+  } else {
+    instances.emplace_back();
+  }
+
+  instances[instance] = InstanceSlot { .mesh = handle, .group = group, .data = data };
+  instances_changed = true;
+  return instance;
+}
+
+void MeshManager::Vulkan::removeInstance(InstanceHandle instance) {
+  if (instance >= instances.size() || instances[instance].mesh == Mesh::InvalidHandle)
+    return;
+
+  instances[instance] = InstanceSlot {};
+  free_instances.push_back(instance);
+  instances_changed = true;
+}
+
+void MeshManager::Vulkan::cullInstances(const Frustum &_frustum, const LODSelection &selection) {
+  GraphicsAPI::Vulkan::GpuCulling &culling = vulkan->getGpuCulling();
+  frustum = _frustum;
+
+  /* records are indexed by instance handle, removed instances leave a record nothing draws */
+  if (instances_changed) {
+    std::vector<Mesh::InstanceData> records(instances.size());
+    for (InstanceHandle instance = 0; instance < instances.size(); ++instance)
+      records[instance] = instances[instance].data;
+
+    if (!vulkan->getInstanceBuffer().setPersistent(records))
+      return;
+  }
+
+  /* without the culling pass, levels are picked here for drawInstances */
+  if (!culling.isEnabled()) {
+    instances_changed = false;
+    for (InstanceSlot &slot : instances) {
+      if (slot.mesh == Mesh::InvalidHandle || !get(slot.mesh).alive)
+        continue;
+
+      /* meshes still loading draw their placeholder at full resolution */
+      Mesh::Handle resolved = resolve(slot.mesh);
+      slot.lod = resolved == getDataHandle(slot.mesh) ? selectLOD(resolved, slot.data.model, selection) : 0;
+    }
+    return;
+  }
+
+  /* the pass picks the levels itself, the camera is all it needs every frame */
+  culling.setFrustum(frustum);
+  culling.setLODSelection(selection.camera_position, selection.projection_scale, selection.max_pixel_error);
+
+  /* static scenes stop here, the set on the GPU is still current */
+  if (!instances_changed && culled_version == geometry_version)
+    return;
+
+  using GpuCulling = GraphicsAPI::Vulkan::GpuCulling;
+  std::vector<GpuCulling::Instance> records;
+  std::vector<GpuCulling::LOD> lods;
+  std::unordered_map<Mesh::Handle, uint32_t> first_lods; /* instances of a mesh share its levels */
+  records.reserve(instances.size());
+
+  for (InstanceHandle instance = 0; instance < instances.size(); ++instance) {
+    const InstanceSlot &slot = instances[instance];
+    if (slot.mesh == Mesh::InvalidHandle || !get(slot.mesh).alive)
+      continue;
+
+    /* meshes still loading are drawn as their placeholder, picked up again once their upload lands */
+    Mesh::Handle resolved = resolve(slot.mesh);
+    auto &vk_mesh_data = static_cast<MeshInfo::Vulkan &>(get(resolved));
+    DrawInfo::Vulkan draw {};
+    if (!getDraw(vk_mesh_data, 0, draw))
+      continue;
+
+    /* while an update is in flight only the old ranges are drawable, see getDraw */
+    const uint32_t level_count =
+      vk_mesh_data.gpu_uploaded ? std::max(static_cast<uint32_t>(vk_mesh_data.lods.size()), 1u) : 1u;
+
+    auto [level, inserted] = first_lods.try_emplace(resolved, static_cast<uint32_t>(lods.size()));
+    if (inserted) {
+      for (uint32_t lod = 0; lod < level_count; ++lod) {
+        DrawInfo::Vulkan level_draw {};
+        getDraw(vk_mesh_data, lod, level_draw);
+        lods.push_back(GpuCulling::LOD {
+          .first_index = level_draw.first_index,
+          .index_count = level_draw.index_count,
+          .error = lod < vk_mesh_data.lods.size() ? vk_mesh_data.lods[lod].error : 0.0f,
+        });
+      }
+    }
+
+    /* same rules as selectLOD: placeholders and meshes without bounds stay at full resolution */
+    const Mesh::Bounds &bounds = vk_mesh_data.getBounds();
+    const glm::vec4 sphere = getWorldSphere(bounds, slot.data.model);
+    const bool selectable = resolved == getDataHandle(slot.mesh) && bounds.radius > 0.0f;
+
+    records.push_back(GpuCulling::Instance {
+      .sphere = sphere,
+      .id = instance,
+      .group = slot.group,
+      .vertex_buffer = draw.vertex_buffer,
+      .index_buffer = draw.index_buffer,
+      .vertex_offset = draw.vertex_offset,
+      .first_lod = level->second,
+      .lod_count = selectable ? level_count : 1u,
+      .lod_scale = selectable ? sphere.w / bounds.radius : 1.0f,
+    });
+  }
+
+  if (culling.setInstances(records, lods)) {
+    instances_changed = false;
+    culled_version = geometry_version;
+  }
+}
+
+bool MeshManager::Vulkan::drawInstances(uint32_t group) {
+  GraphicsAPI::Vulkan::GpuCulling &culling = vulkan->getGpuCulling();
+  VkCommandBuffer command_buffer = vulkan->getCommandBuffer(vulkan->getCurrentImageIndex());
+
+  /* the next pipeline bind goes back to the frame's records */
+  if (!vulkan->getInstanceBuffer().bindPersistent(command_buffer))
+    return false;
+
+  if (culling.isEnabled()) {
+    culling.draw(command_buffer, group);
+    return culling.getInstanceCount() > 0;
+  }
+
+  /* no culling pass, the instances are culled here and go through the frame's indirect draws */
+  bool queued = false;
+  for (InstanceHandle instance = 0; instance < instances.size(); ++instance) {
+    const InstanceSlot &slot = instances[instance];
+    if (slot.mesh == Mesh::InvalidHandle || slot.group != group || !get(slot.mesh).alive)
+      continue;
+
+    Mesh::Handle resolved = resolve(slot.mesh);
+    const glm::vec4 sphere = getWorldSphere(get(resolved).getBounds(), slot.data.model);
+    if (frustum.intersectsSphere(glm::vec3(sphere), sphere.w))
+      queued |= queueDraw(resolved, slot.lod, 1, instance);
+  }
+
+  return queued && vulkan->flushDraws();
+}
+
+size_t MeshManager::Vulkan::uploadPending(size_t byte_budget) {
+  GraphicsAPI::Vulkan::StagingRing &ring = vulkan->getStagingRing();
+  size_t uploaded = 0;
+
   for (std::unique_ptr<MeshInfo> &mesh_data : meshes) {
     auto vk_mesh_data = static_cast<MeshInfo::Vulkan *>(mesh_data.get());
     
-    if (!mesh_data->alive || mesh_data->gpu_uploaded)
+    if (!mesh_data->alive || mesh_data->gpu_uploaded || vk_mesh_data->upload || !mesh_data->hasCPUData())
+      continue;
+    if (vk_mesh_data->failed_revision == mesh_data->revision)
+      continue;
+
+    if (uploaded > 0 && uploaded + mesh_data->getSizeInBytes() > byte_budget)
+      break;
+
+    uploaded += mesh_data->getSizeInBytes();
+
+    auto upload = std::make_unique<MeshInfo::Vulkan::Upload>();
+    upload->revision = mesh_data->revision;
+
+    /* the batch holds on to the staging buffer until its copy is done, markUploaded may drop the mesh's reference */
+    auto staging = std::static_pointer_cast<Staging>(mesh_data->staging);
+    bool queued = staging ? uploadStaged(staging, *upload) : uploadHost(*mesh_data, *upload);
+
+    if (!queued) {
+      LOG_ERROR("[MeshManager::Vulkan]: Failed to queue mesh upload, it is retried once the mesh is updated");
+      vk_mesh_data->failed_revision = mesh_data->revision;
+      /* copies already recorded may still write to the ranges, and their acquires are still to be recorded */
+      ring.onComplete([this, vertices = upload->vertices, indices = upload->indices](bool) {
+        retireRanges(vertices, indices);
+      });
       continue;
+    }
 
-    if (!mesh_data->cpu_vertices.empty())
-      vulkan->createBuffer(mesh_data->cpu_vertices.data(),
-                           std::span(mesh_data->cpu_vertices).size_bytes(),
-                           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                           vk_mesh_data->vertex_buffer,
-                           vk_mesh_data->vertex_memory);
-
-    if (!mesh_data->cpu_indices.empty())
-      vulkan->createBuffer(mesh_data->cpu_indices.data(),
-                           std::span(mesh_data->cpu_indices).size_bytes(),
-                           VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                           vk_mesh_data->index_buffer,
-                           vk_mesh_data->index_memory);
-
-    mesh_data->gpu_uploaded = true;
+    /* meshes are never erased, the info outlives the batch */
+    vk_mesh_data->upload = std::move(upload);
+    ring.onComplete([this, vk_mesh_data, staging = std::move(staging)](bool completed) {
+      completeUpload(*vk_mesh_data, completed);
+    });
   }
+
+  /* everything above goes to the GPU as one batch, drawn once it has completed */
+  if (uploaded > 0)
+    ring.submit();
+
+  return uploaded;
 }
 
-} /* namespace Engine */
\ No newline at end of file
+} /* namespace Engine */
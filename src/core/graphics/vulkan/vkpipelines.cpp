@@ -0,0 +1,305 @@
+#include <core/graphics/vulkan/vkpipelines.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkinstances.hpp>
+#include <core/graphics/vulkan/descriptor_manager.hpp>
+#include <core/assets/vfs.hpp>
+#include <core/logging.hpp>
+
+#include <array>
+#include <vector>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+Vulkan::PipelineStateCache::~PipelineStateCache() noexcept {
+  if (device == VK_NULL_HANDLE)
+    return;
+
+  for (auto &[state, pipeline] : pipelines)
+    vkDestroyPipeline(device, pipeline, VK_NULL_HANDLE);
+  pipelines.clear();
+
+  if (layout != VK_NULL_HANDLE)
+    vkDestroyPipelineLayout(device, layout, VK_NULL_HANDLE);
+}
+
+bool Vulkan::PipelineStateCache::init(Vulkan *_vulkan) {
+  vulkan = _vulkan;
+  device = vulkan->getDeviceManager().getDevice();
+  return true;
+}
+
+VkPipelineLayout Vulkan::PipelineStateCache::getLayout() {
+  if (layout != VK_NULL_HANDLE)
+    return layout;
+
+  const std::array set_layouts {
+    vulkan->getDescriptorManager().getLayouts()[static_cast<size_t>(UniformBufferType::Camera)],
+    vulkan->getInstanceBuffer().getSetLayout(),
+  };
+  static_assert(InstanceBuffer::SET == 1);
+
+  if (set_layouts[0] == VK_NULL_HANDLE) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::PipelineStateCache]: The camera set layout does not exist yet");
+    return VK_NULL_HANDLE;
+  }
+
+  VkPipelineLayoutCreateInfo layout_info {
+    .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .pNext                  = VK_NULL_HANDLE,
+    .flags                  = 0,
+    .setLayoutCount         = static_cast<uint32_t>(set_layouts.size()),
+    .pSetLayouts            = set_layouts.data(),
+    .pushConstantRangeCount = 0,
+    .pPushConstantRanges    = VK_NULL_HANDLE
+  };
+
+  if (vkCreatePipelineLayout(device, &layout_info, VK_NULL_HANDLE, &layout) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::PipelineStateCache]: Failed to create pipeline layout");
+    layout = VK_NULL_HANDLE;
+  }
+
+  return layout;
+}
+
+VkPipeline Vulkan::PipelineStateCache::get(const PipelineState &state, std::span<const Shader> shaders) {
+  if (auto it = pipelines.find(state); it != pipelines.end())
+    return it->second;
+
+  VkPipeline pipeline = create(state, shaders);
+  if (pipeline != VK_NULL_HANDLE)
+    pipelines.emplace(state, pipeline);
+  return pipeline;
+}
+
+VkPipeline Vulkan::PipelineStateCache::find(const PipelineState &state) const {
+  auto it = pipelines.find(state);
+  return it != pipelines.end() ? it->second : VK_NULL_HANDLE;
+}
+
+std::optional<std::filesystem::file_time_type> Vulkan::PipelineStateCache::getWriteTime(const File::Path &path) {
+  /* packed shaders change with their archive */
+  std::optional<File::VFS::Location> location = File::locate(path);
+  if (!location)
+    return std::nullopt;
+
+  std::error_code error;
+  std::filesystem::file_time_type write_time = std::filesystem::last_write_time(location->file, error);
+  if (error)
+    return std::nullopt;
+  return write_time;
+}
+
+bool Vulkan::PipelineStateCache::findShaderHash(const File::Path &path, Hash::Hash128 &hash) const {
+  auto it = shader_files.find(path.string());
+  if (it == shader_files.end())
+    return false;
+
+  std::optional<std::filesystem::file_time_type> write_time = getWriteTime(path);
+  if (!write_time || *write_time != it->second.write_time)
+    return false;
+
+  hash = it->second.hash;
+  return true;
+}
+
+void Vulkan::PipelineStateCache::rememberShaderHash(const File::Path &path, std::filesystem::file_time_type write_time,
+                                                    const Hash::Hash128 &hash) {
+  shader_files.insert_or_assign(path.string(), ShaderFile { .hash = hash, .write_time = write_time });
+}
+
+VkPipeline Vulkan::PipelineStateCache::create(const PipelineState &state, std::span<const Shader> shaders) {
+  /* --- Shader Stages, the modules are only needed while compiling --- */
+  std::vector<VkShaderModule> modules;
+  std::vector<VkPipelineShaderStageCreateInfo> stages_info;
+
+  auto destroyModules = [&] {
+    for (VkShaderModule module : modules)
+      vkDestroyShaderModule(device, module, VK_NULL_HANDLE);
+  };
+
+  for (const Shader &shader : shaders) {
+    VkShaderModuleCreateInfo module_info {
+      .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+      .pNext    = VK_NULL_HANDLE,
+      .flags    = 0,
+      .codeSize = shader.code.size(),
+      .pCode    = reinterpret_cast<const uint32_t *>(shader.code.data())
+    };
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(device, &module_info, VK_NULL_HANDLE, &module) != VK_SUCCESS) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::PipelineStateCache]: Failed to create shader module");
+      destroyModules();
+      return VK_NULL_HANDLE;
+    }
+    modules.push_back(module);
+
+    stages_info.push_back(
+      VkPipelineShaderStageCreateInfo {
+        .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .pNext               = VK_NULL_HANDLE,
+        .flags               = 0,
+        .stage               = shader.stage,
+        .module              = module,
+        .pName               = "main",
+        .pSpecializationInfo = VK_NULL_HANDLE
+      }
+    );
+  }
+
+  /* --- Vertex Input --- */
+  VkVertexInputBindingDescription binding_description {
+    .binding   = 0,
+    .stride    = state.vertex_stride,
+    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+  };
+
+  VkPipelineVertexInputStateCreateInfo vertex_input_info {
+    .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    .pNext                           = VK_NULL_HANDLE,
+    .flags                           = 0,
+    .vertexBindingDescriptionCount   = state.attribute_count > 0 ? 1u : 0u,
+    .pVertexBindingDescriptions      = &binding_description,
+    .vertexAttributeDescriptionCount = state.attribute_count,
+    .pVertexAttributeDescriptions    = state.attributes.data()
+  };
+
+  /* --- Input Assembly --- */
+  VkPipelineInputAssemblyStateCreateInfo input_assembly {
+    .sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+    .pNext                  = VK_NULL_HANDLE,
+    .flags                  = 0,
+    .topology               = state.topology,
+    .primitiveRestartEnable = VK_FALSE
+  };
+
+  /* --- Viewport & Scissor, set per frame so pipelines survive swapchain resizes --- */
+  VkPipelineViewportStateCreateInfo viewport_state {
+    .sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+    .pNext         = VK_NULL_HANDLE,
+    .flags         = 0,
+    .viewportCount = 1,
+    .pViewports    = VK_NULL_HANDLE,
+    .scissorCount  = 1,
+    .pScissors     = VK_NULL_HANDLE
+  };
+
+  const std::array dynamic_states { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+  VkPipelineDynamicStateCreateInfo dynamic_state {
+    .sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+    .pNext             = VK_NULL_HANDLE,
+    .flags             = 0,
+    .dynamicStateCount = static_cast<uint32_t>(dynamic_states.size()),
+    .pDynamicStates    = dynamic_states.data()
+  };
+
+  /* --- Rasterizer --- */
+  VkPipelineRasterizationStateCreateInfo rasterizer {
+    .sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+    .pNext                   = VK_NULL_HANDLE,
+    .flags                   = 0,
+    .depthClampEnable        = VK_FALSE,
+    .rasterizerDiscardEnable = VK_FALSE,
+    .polygonMode             = state.polygon_mode,
+    .cullMode                = state.cull_mode,
+    .frontFace               = state.front_face,
+    .depthBiasEnable         = VK_FALSE,
+    .depthBiasConstantFactor = 0.0f,
+    .depthBiasClamp          = 0.0f,
+    .depthBiasSlopeFactor    = 0.0f,
+    .lineWidth               = 1.0f
+  };
+
+  /* --- Multisampling --- */
+  VkPipelineMultisampleStateCreateInfo multisampling {
+    .sType                 = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+    .pNext                 = VK_NULL_HANDLE,
+    .flags                 = 0,
+    .rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT,
+    .sampleShadingEnable   = VK_FALSE,
+    .minSampleShading      = 1.0f,
+    .pSampleMask           = VK_NULL_HANDLE,
+    .alphaToCoverageEnable = VK_FALSE,
+    .alphaToOneEnable      = VK_FALSE
+  };
+
+  /* --- Color Blend --- */
+  VkPipelineColorBlendAttachmentState color_blend_attachment {
+    .blendEnable         = state.blend_enable,
+    .srcColorBlendFactor = state.src_color_factor,
+    .dstColorBlendFactor = state.dst_color_factor,
+    .colorBlendOp        = state.color_op,
+    .srcAlphaBlendFactor = state.src_alpha_factor,
+    .dstAlphaBlendFactor = state.dst_alpha_factor,
+    .alphaBlendOp        = state.alpha_op,
+    .colorWriteMask      = state.color_write_mask
+  };
+
+  VkPipelineColorBlendStateCreateInfo color_blending {
+    .sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+    .pNext           = VK_NULL_HANDLE,
+    .flags           = 0,
+    .logicOpEnable   = VK_FALSE,
+    .logicOp         = VK_LOGIC_OP_COPY,
+    .attachmentCount = 1,
+    .pAttachments    = &color_blend_attachment,
+    .blendConstants  { 0.0f, 0.0f, 0.0f, 0.0f }
+  };
+
+  /* --- Depth Stencil --- */
+  VkPipelineDepthStencilStateCreateInfo depth_stencil {
+    .sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+    .pNext                 = VK_NULL_HANDLE,
+    .flags                 = 0,
+    .depthTestEnable       = state.depth_test,
+    .depthWriteEnable      = state.depth_write,
+    .depthCompareOp        = state.depth_compare,
+    .depthBoundsTestEnable = VK_FALSE,
+    .stencilTestEnable     = VK_FALSE,
+    .front                 {},
+    .back                  {},
+    .minDepthBounds        = 0.0f,
+    .maxDepthBounds        = 1.0f
+  };
+
+  /* --- Graphics Pipeline --- */
+  VkGraphicsPipelineCreateInfo pipeline_info {
+    .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .pNext               = VK_NULL_HANDLE,
+    .flags               = 0,
+    .stageCount          = static_cast<uint32_t>(stages_info.size()),
+    .pStages             = stages_info.data(),
+    .pVertexInputState   = &vertex_input_info,
+    .pInputAssemblyState = &input_assembly,
+    .pTessellationState  = VK_NULL_HANDLE,
+    .pViewportState      = &viewport_state,
+    .pRasterizationState = &rasterizer,
+    .pMultisampleState   = &multisampling,
+    .pDepthStencilState  = &depth_stencil,
+    .pColorBlendState    = &color_blending,
+    .pDynamicState       = &dynamic_state,
+    .layout              = state.layout,
+    .renderPass          = state.render_pass,
+    .subpass             = 0,
+    .basePipelineHandle  = VK_NULL_HANDLE,
+    .basePipelineIndex   = -1
+  };
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkPipelineCache cache = vulkan->getDeviceManager().getPipelineCache();
+  if (vkCreateGraphicsPipelines(device, cache, 1, &pipeline_info, VK_NULL_HANDLE, &pipeline) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::PipelineStateCache]: Failed to create graphics pipeline");
+    pipeline = VK_NULL_HANDLE;
+  } else {
+    LOG_INFO("[GraphicsAPI::Vulkan::PipelineStateCache]: Graphics pipeline created, {} cached",
+             pipelines.size() + 1);
+  }
+
+  destroyModules();
+  return pipeline;
+}
+
+} /* namespace Engine */
@@ -0,0 +1,425 @@
+#include <core/graphics/vulkan/vkstaging.hpp>
+#include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/logging.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+namespace Engine {
+
+using Vulkan = GraphicsAPI::Vulkan;
+
+static constexpr VkMemoryPropertyFlags HOST_MEMORY = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+/* larger uploads get a staging buffer of their own rather than draining the ring */
+static constexpr VkDeviceSize MAX_RING_UPLOAD = Vulkan::StagingRing::SIZE / 4;
+
+/* every kind of read a freshly uploaded buffer can see */
+static constexpr VkAccessFlags CONSUMER_ACCESS = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                                 VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+                                                 VK_ACCESS_SHADER_READ_BIT;
+
+Vulkan::StagingRing::~StagingRing() noexcept {
+  if (device == VK_NULL_HANDLE)
+    return;
+
+  while (!in_flight.empty()) {
+    wait(in_flight.front());
+    retire(in_flight.front());
+    in_flight.pop_front();
+  }
+
+  /* recorded but never submitted, nothing on the GPU references it */
+  if (recording) {
+    vkEndCommandBuffer(current.command_buffer);
+    current.end = head;
+    retire(current);
+  }
+
+  if (timeline != VK_NULL_HANDLE)
+    vkDestroySemaphore(device, timeline, VK_NULL_HANDLE);
+
+  if (command_pool != VK_NULL_HANDLE)
+    vkDestroyCommandPool(device, command_pool, VK_NULL_HANDLE);
+
+  allocator->destroyBuffer(buffer, allocation);
+}
+
+bool Vulkan::StagingRing::init(DeviceManager *device_manager, MemoryAllocator *memory_allocator) {
+  device = device_manager->getDevice();
+  queue = device_manager->getTransferQueue();
+  transfer_family = device_manager->getTransferQueueFamily();
+  graphics_family = device_manager->getGraphicsQueueFamily();
+  transfer_ownership = device_manager->hasDedicatedTransferQueue();
+  allocator = memory_allocator;
+
+  VkCommandPoolCreateInfo pool_info {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    .queueFamilyIndex = transfer_family,
+  };
+
+  if (vkCreateCommandPool(device, &pool_info, VK_NULL_HANDLE, &command_pool) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to create command pool");
+    return false;
+  }
+
+  VkSemaphoreTypeCreateInfo type_info {
+    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+    .initialValue = 0,
+  };
+  VkSemaphoreCreateInfo semaphore_info {
+    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    .pNext = &type_info,
+    .flags = 0,
+  };
+
+  if (vkCreateSemaphore(device, &semaphore_info, VK_NULL_HANDLE, &timeline) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to create timeline semaphore");
+    return false;
+  }
+
+  if (!allocator->createBuffer(SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, HOST_MEMORY, 0, buffer, allocation)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to create ring buffer");
+    return false;
+  }
+
+  return true;
+}
+
+bool Vulkan::StagingRing::begin() {
+  if (recording)
+    return true;
+
+  if (!idle.empty()) {
+    current = std::move(idle.back());
+    idle.pop_back();
+  } else {
+    VkCommandBufferAllocateInfo alloc_info {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .pNext = VK_NULL_HANDLE,
+      .commandPool = command_pool,
+      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .commandBufferCount = 1,
+    };
+
+    current = Batch {};
+    if (vkAllocateCommandBuffers(device, &alloc_info, &current.command_buffer) != VK_SUCCESS) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to allocate command buffer");
+      return false;
+    }
+  }
+
+  VkCommandBufferBeginInfo begin_info {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    .pInheritanceInfo = VK_NULL_HANDLE,
+  };
+
+  if (vkBeginCommandBuffer(current.command_buffer, &begin_info) != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to begin command buffer");
+    idle.push_back(std::move(current));
+    return false;
+  }
+
+  recording = true;
+  recording_start = head;
+  return true;
+}
+
+void Vulkan::StagingRing::record(VkBuffer source, VkDeviceSize source_offset,
+                                 VkBuffer destination, VkDeviceSize destination_offset, VkDeviceSize size) {
+  VkBufferCopy region {
+    .srcOffset = source_offset,
+    .dstOffset = destination_offset,
+    .size = size,
+  };
+  vkCmdCopyBuffer(current.command_buffer, source, destination, 1, &region);
+
+  if (!transfer_ownership)
+    return;
+
+  /* release half of the ownership transfer, its destination access is ignored */
+  current.releases.push_back(VkBufferMemoryBarrier {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .pNext = VK_NULL_HANDLE,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = 0,
+    .srcQueueFamilyIndex = transfer_family,
+    .dstQueueFamilyIndex = graphics_family,
+    .buffer = destination,
+    .offset = destination_offset,
+    .size = size,
+  });
+}
+
+bool Vulkan::StagingRing::reserve(VkDeviceSize size, VkDeviceSize &offset) {
+  for (;;) {
+    /* an upload never wraps around, the end of the ring is skipped instead */
+    uint64_t start = (head + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (start % SIZE + size > SIZE)
+      start += SIZE - start % SIZE;
+
+    if (start + size - tail <= SIZE) {
+      head = start + size;
+      offset = start % SIZE;
+      return true;
+    }
+
+    reclaim();
+    if (in_flight.empty() && !recording) {
+      /* the GPU is done with everything, start over */
+      head = tail = 0;
+      continue;
+    }
+
+    if (in_flight.empty() && !submit())
+      return false;
+
+    if (!wait(in_flight.front()))
+      return false;
+    retire(in_flight.front());
+    in_flight.pop_front();
+  }
+}
+
+bool Vulkan::StagingRing::upload(const void *data, VkDeviceSize size, VkBuffer destination, VkDeviceSize destination_offset) {
+  if (size == 0)
+    return true;
+
+  if (size > MAX_RING_UPLOAD) {
+    VkBuffer staging = VK_NULL_HANDLE;
+    Allocation staging_allocation {};
+    if (!allocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, HOST_MEMORY, 0, staging, staging_allocation)) {
+      LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to create a staging buffer of {} bytes", size);
+      return false;
+    }
+
+    if (data)
+      std::memcpy(staging_allocation.mapped, data, size);
+    else
+      std::memset(staging_allocation.mapped, 0, size);
+
+    MemoryAllocator *owner = allocator;
+    auto release = [owner, staging, staging_allocation](bool) mutable { owner->destroyBuffer(staging, staging_allocation); };
+
+    if (!copy(staging, 0, destination, destination_offset, size)) {
+      release(false);
+      return false;
+    }
+
+    onComplete(std::move(release));
+    return true;
+  }
+
+  VkDeviceSize offset = 0;
+  if (!reserve(size, offset) || !begin())
+    return false;
+
+  char *target = static_cast<char *>(allocation.mapped) + offset;
+  if (data)
+    std::memcpy(target, data, size);
+  else
+    std::memset(target, 0, size);
+
+  record(buffer, offset, destination, destination_offset, size);
+  return true;
+}
+
+bool Vulkan::StagingRing::copy(VkBuffer source, VkDeviceSize source_offset,
+                               VkBuffer destination, VkDeviceSize destination_offset, VkDeviceSize size) {
+  if (size == 0)
+    return true;
+
+  if (!begin())
+    return false;
+
+  record(source, source_offset, destination, destination_offset, size);
+  return true;
+}
+
+void Vulkan::StagingRing::onComplete(Callback callback) {
+  if (recording)
+    current.callbacks.push_back(std::move(callback));
+  else if (!in_flight.empty())
+    in_flight.back().callbacks.push_back(std::move(callback));
+  else
+    callback(true);
+}
+
+bool Vulkan::StagingRing::submit() {
+  if (!recording)
+    return true;
+
+  if (transfer_ownership) {
+    vkCmdPipelineBarrier(
+      current.command_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      0, VK_NULL_HANDLE,
+      static_cast<uint32_t>(current.releases.size()), current.releases.data(),
+      0, VK_NULL_HANDLE
+    );
+  } else {
+    /* same queue as rendering, submission order does the rest */
+    VkMemoryBarrier barrier {
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = VK_NULL_HANDLE,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = CONSUMER_ACCESS,
+    };
+    vkCmdPipelineBarrier(
+      current.command_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      CONSUMER_STAGES,
+      0,
+      1, &barrier,
+      0, VK_NULL_HANDLE,
+      0, VK_NULL_HANDLE
+    );
+  }
+
+  recording = false;
+  current.end = head;
+  current.value = submitted_value + 1;
+
+  VkTimelineSemaphoreSubmitInfo timeline_info {
+    .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .waitSemaphoreValueCount = 0,
+    .pWaitSemaphoreValues = VK_NULL_HANDLE,
+    .signalSemaphoreValueCount = 1,
+    .pSignalSemaphoreValues = &current.value,
+  };
+  VkSubmitInfo submit_info {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .pNext = &timeline_info,
+    .waitSemaphoreCount = 0,
+    .pWaitSemaphores = VK_NULL_HANDLE,
+    .pWaitDstStageMask = VK_NULL_HANDLE,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &current.command_buffer,
+    .signalSemaphoreCount = 1,
+    .pSignalSemaphores = &timeline,
+  };
+
+  VkResult result = vkEndCommandBuffer(current.command_buffer);
+  if (result == VK_SUCCESS)
+    result = vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+
+  if (result != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to submit uploads with result: {}", (int32_t)result);
+    /*
+     * Nothing reached the GPU, but earlier batches may still read the ring ahead of this one:
+     * its space is held until they retire, which the previous timeline value tells.
+     */
+    current.releases.clear();
+    current.failed = true;
+    current.value = submitted_value;
+    in_flight.push_back(std::move(current));
+    current = Batch {};
+    return false;
+  }
+
+  submitted_value = current.value;
+
+  /* acquire half, matching the release above */
+  for (VkBufferMemoryBarrier release : current.releases) {
+    release.srcAccessMask = 0;
+    release.dstAccessMask = CONSUMER_ACCESS;
+    acquires.push_back(Acquire { .value = current.value, .barrier = release });
+  }
+  current.releases.clear();
+
+  in_flight.push_back(std::move(current));
+  current = Batch {};
+  return true;
+}
+
+void Vulkan::StagingRing::reclaim() {
+  if (in_flight.empty())
+    return;
+
+  uint64_t completed = 0;
+  if (vkGetSemaphoreCounterValue(device, timeline, &completed) != VK_SUCCESS)
+    return;
+
+  while (!in_flight.empty() && in_flight.front().value <= completed) {
+    retire(in_flight.front());
+    in_flight.pop_front();
+  }
+}
+
+uint64_t Vulkan::StagingRing::acquire(VkCommandBuffer command_buffer, uint64_t required) {
+  if (acquires.empty())
+    return 0;
+
+  uint64_t completed = 0;
+  vkGetSemaphoreCounterValue(device, timeline, &completed);
+
+  /* batches still in flight stay with the transfer family, unless this frame cannot do without them */
+  const uint64_t limit = std::min(std::max(completed, required), submitted_value);
+
+  std::vector<VkBufferMemoryBarrier> barriers;
+  uint64_t wait_value = 0;
+  while (!acquires.empty() && acquires.front().value <= limit) {
+    barriers.push_back(acquires.front().barrier);
+    wait_value = acquires.front().value;
+    acquires.pop_front();
+  }
+
+  if (barriers.empty())
+    return 0;
+
+  vkCmdPipelineBarrier(
+    command_buffer,
+    CONSUMER_STAGES,
+    CONSUMER_STAGES,
+    0,
+    0, VK_NULL_HANDLE,
+    static_cast<uint32_t>(barriers.size()), barriers.data(),
+    0, VK_NULL_HANDLE
+  );
+
+  return wait_value;
+}
+
+bool Vulkan::StagingRing::wait(const Batch &batch) {
+  VkSemaphoreWaitInfo wait_info {
+    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .flags = 0,
+    .semaphoreCount = 1,
+    .pSemaphores = &timeline,
+    .pValues = &batch.value,
+  };
+
+  VkResult result = vkWaitSemaphores(device, &wait_info, std::numeric_limits<uint64_t>::max());
+  if (result != VK_SUCCESS) {
+    LOG_ERROR("[GraphicsAPI::Vulkan::StagingRing]: Failed to wait for uploads with result: {}", (int32_t)result);
+    return false;
+  }
+  return true;
+}
+
+void Vulkan::StagingRing::retire(Batch &batch) {
+  /* batches complete in submission order, so the tail only ever moves forward */
+  tail = batch.end;
+
+  for (Callback &callback : batch.callbacks)
+    callback(!batch.failed);
+  batch.callbacks.clear();
+  batch.failed = false;
+
+  vkResetCommandBuffer(batch.command_buffer, 0);
+  idle.push_back(std::move(batch));
+}
+
+} /* namespace Engine */
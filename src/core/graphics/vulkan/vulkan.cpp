@@ -4,10 +4,18 @@
 #include <core/graphics/vulkan/vulkan.hpp>
 #include <core/graphics/vulkan/vkshader.hpp>
 #include <core/graphics/vulkan/vkdevice.hpp>
+#include <core/graphics/vulkan/vkallocator.hpp>
+#include <core/graphics/vulkan/vkstaging.hpp>
+#include <core/graphics/vulkan/vkgeometry.hpp>
+#include <core/graphics/vulkan/vkindirect.hpp>
+#include <core/graphics/vulkan/vkculling.hpp>
+#include <core/graphics/vulkan/vkinstances.hpp>
+#include <core/graphics/vulkan/vkpipelines.hpp>
 #include <core/graphics/vulkan/vksurface.hpp>
 #include <core/graphics/vulkan/vkinstance.hpp>
 #include <core/graphics/vulkan/descriptor_manager.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <string_view>
 
@@ -18,13 +26,22 @@ GraphicsAPI::Vulkan::Vulkan() noexcept :
   instance_manager(std::make_unique<Vulkan::InstanceManager>()),
   surface_manager(std::make_unique<Vulkan::SurfaceManager>()),
   device_manager(std::make_unique<Vulkan::DeviceManager>()),
-  descriptor_manager(std::make_unique<Vulkan::DescriptorManager>()) {
+  descriptor_manager(std::make_unique<Vulkan::DescriptorManager>()),
+  memory_allocator(std::make_unique<Vulkan::MemoryAllocator>()),
+  geometry_arena(std::make_unique<Vulkan::GeometryArena>()),
+  staging_ring(std::make_unique<Vulkan::StagingRing>()),
+  indirect_draws(std::make_unique<Vulkan::IndirectDraws>()),
+  instance_buffer(std::make_unique<Vulkan::InstanceBuffer>()),
+  pipeline_states(std::make_unique<Vulkan::PipelineStateCache>()),
+  gpu_culling(std::make_unique<Vulkan::GpuCulling>()) {
 }
 
 GraphicsAPI::Vulkan::~Vulkan() noexcept {
   if (device_manager->getDevice() != VK_NULL_HANDLE)
     vkDeviceWaitIdle(device_manager->getDevice());
 
+  collectDeferred(true);
+
   if (device_manager->getDevice() != VK_NULL_HANDLE) {
     for (auto &semaphore : image_available_semaphores)
       vkDestroySemaphore(device_manager->getDevice(), semaphore, VK_NULL_HANDLE);
@@ -129,13 +146,15 @@ bool Vulkan::createSwapchain() {
     .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
     .presentMode = present_mode,
     .clipped = VK_TRUE,
-    .oldSwapchain = VK_NULL_HANDLE
+    .oldSwapchain = swapchain /* lets the driver reuse what it can, the caller retires the old one */
   };
 
-  if (vkCreateSwapchainKHR(device_manager->getDevice(), &create_info, VK_NULL_HANDLE, &swapchain) != VK_SUCCESS) {
+  VkSwapchainKHR created = VK_NULL_HANDLE;
+  if (vkCreateSwapchainKHR(device_manager->getDevice(), &create_info, VK_NULL_HANDLE, &created) != VK_SUCCESS) {
     LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to create swapchain");
     return false;
   }
+  swapchain = created;
 
   // Retrieve swapchain images
   vkGetSwapchainImagesKHR(device_manager->getDevice(), swapchain, &image_count, VK_NULL_HANDLE);
@@ -300,6 +319,11 @@ bool Vulkan::createCommandPool() {
 }
 
 bool Vulkan::createCommandBuffers() {
+  /* one per swapchain image, a recreated swapchain with more images only adds the missing ones */
+  const size_t allocated = command_buffers.size();
+  if (allocated >= swapchain_images.size())
+    return true;
+
   command_buffers.resize(swapchain_images.size());
   
   VkCommandBufferAllocateInfo alloc_info{
@@ -307,11 +331,12 @@ bool Vulkan::createCommandBuffers() {
     .pNext = VK_NULL_HANDLE,
     .commandPool = command_pool,
     .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-    .commandBufferCount = static_cast<uint32_t>(command_buffers.size())
+    .commandBufferCount = static_cast<uint32_t>(command_buffers.size() - allocated)
   };
 
-  if (vkAllocateCommandBuffers(device_manager->getDevice(), &alloc_info, command_buffers.data()) != VK_SUCCESS) {
+  if (vkAllocateCommandBuffers(device_manager->getDevice(), &alloc_info, command_buffers.data() + allocated) != VK_SUCCESS) {
     LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to allocate command buffers");
+    command_buffers.resize(allocated);
     return false;
   }
 
@@ -392,15 +417,72 @@ VkPresentModeKHR Vulkan::choosePresentMode(std::span<VkPresentModeKHR> modes) {
 VkExtent2D Vulkan::chooseSwapExtent(VkSurfaceCapabilitiesKHR &capabilities) {
   if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
     return capabilities.currentExtent;
-  return { 1280, 720 }; // TODO: Should be changed to current screen size
+
+  /* the surface follows the swapchain (e.g. Wayland), size it after the framebuffer */
+  glm::uvec2 size = window->getFrameBufferSize();
+  return {
+    std::clamp(size.x, capabilities.minImageExtent.width, capabilities.maxImageExtent.width),
+    std::clamp(size.y, capabilities.minImageExtent.height, capabilities.maxImageExtent.height),
+  };
 }
 
-bool Vulkan::init(Window *window) {
+bool Vulkan::recreateSwapchain() {
+  swapchain_dirty = true;
+
+  /* minimized, there is nothing to present to until the window is restored */
+  glm::uvec2 size = window->getFrameBufferSize();
+  if (size.x == 0 || size.y == 0)
+    return false;
+
+  VkDevice device = device_manager->getDevice();
+  VkSwapchainKHR old_swapchain = swapchain;
+  std::vector<VkImageView> old_views = std::exchange(swapchain_image_views, {});
+  std::vector<VkFramebuffer> old_framebuffers = std::exchange(frame_buffers, {});
+
+  /* the surface format does not change with its size, the render pass and every pipeline stay valid */
+  if (!createSwapchain()) {
+    swapchain_image_views = std::move(old_views);
+    frame_buffers = std::move(old_framebuffers);
+    return false;
+  }
+
+  /* frames in flight may still render to or present the old images, no device-wide wait */
+  deferDestroy([device, old_swapchain, old_views = std::move(old_views), old_framebuffers = std::move(old_framebuffers)] {
+    for (VkFramebuffer framebuffer : old_framebuffers)
+      vkDestroyFramebuffer(device, framebuffer, VK_NULL_HANDLE);
+    for (VkImageView view : old_views)
+      vkDestroyImageView(device, view, VK_NULL_HANDLE);
+    vkDestroySwapchainKHR(device, old_swapchain, VK_NULL_HANDLE);
+  });
+
+  if (!createImageviews() || !createFramebuffers() || !createCommandBuffers()) {
+    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to recreate swapchain resources");
+    return false;
+  }
+
+  swapchain_dirty = false;
+  LOG_INFO("[GraphicsAPI::Vulkan]: Swapchain recreated at {}x{}", swapchain_extent.width, swapchain_extent.height);
+  return true;
+}
+
+void GraphicsAPI::Vulkan::resize(uint32_t, uint32_t) {
+  swapchain_dirty = true;
+}
+
+bool Vulkan::init(Window *_window) {
+  window = _window;
+
   if (
     !instance_manager->init(window, window->getTitle(), true) ||
     !surface_manager->init(&getInstanceManager(), window) ||
     !device_manager->init(&getInstanceManager(), &getSurfaceManager()) ||
+    !memory_allocator->init(&getDeviceManager()) ||
+    !geometry_arena->init(this) ||
+    !staging_ring->init(&getDeviceManager(), &getMemoryAllocator()) ||
+    !indirect_draws->init(this) ||
+    !instance_buffer->init(this) ||
     !descriptor_manager->init(&getDeviceManager()) ||
+    !pipeline_states->init(this) ||
     !createSwapchain() ||
     !createImageviews() ||
     !createRenderpass() ||
@@ -476,14 +558,41 @@ bool GraphicsAPI::Vulkan::beginFrame() {
   GraphicsAPI::Vulkan::DeviceManager &device_manager = getDeviceManager();
 
   device_manager.waitForFences({ fence });
-  vkAcquireNextImageKHR(
-    device_manager.getDevice(),
-    getSwapchain(),
-    std::numeric_limits<uint64_t>::max(),
-    getImageAvailableSemaphore(current_frame_index),
-    VK_NULL_HANDLE,
-    &current_image_index
-  );
+  collectDeferred(false);
+  staging_ring->reclaim();
+
+  /* rebuilt once the frame's fence is free, older frames keep the old swapchain until they are done */
+  if (swapchain_dirty && !recreateSwapchain())
+    return false;
+
+  auto acquire = [&] {
+    return vkAcquireNextImageKHR(
+      device_manager.getDevice(),
+      getSwapchain(),
+      std::numeric_limits<uint64_t>::max(),
+      getImageAvailableSemaphore(current_frame_index),
+      VK_NULL_HANDLE,
+      &current_image_index
+    );
+  };
+
+  /* out of date before the resize callback arrived, the frame goes to the new swapchain instead of being dropped */
+  VkResult acquired = acquire();
+  if (acquired == VK_ERROR_OUT_OF_DATE_KHR) {
+    if (!recreateSwapchain())
+      return false;
+    acquired = acquire();
+  }
+
+  /* still presentable, recreated by the next frame */
+  if (acquired == VK_SUBOPTIMAL_KHR) {
+    swapchain_dirty = true;
+  } else if (acquired != VK_SUCCESS) {
+    /* the fence stays signalled, the next frame does not wait on it */
+    swapchain_dirty = acquired == VK_ERROR_OUT_OF_DATE_KHR;
+    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to acquire a swapchain image (Error: {})", (int32_t)acquired);
+    return false;
+  }
   device_manager.resetFences({ fence });
 
   VkCommandBuffer command_buffer = getCommandBuffer(current_image_index);
@@ -497,6 +606,18 @@ bool GraphicsAPI::Vulkan::beginFrame() {
   };
   vkBeginCommandBuffer(command_buffer, &begin_info);
 
+  /* uploads recorded since the last frame go out in a single batch, the frame only waits for the ones it needs */
+  staging_ring->submit();
+  upload_wait_value = staging_ring->acquire(command_buffer, required_upload);
+  required_upload = 0;
+
+  bound_vertex_buffer = VK_NULL_HANDLE;
+  bound_index_buffer = VK_NULL_HANDLE;
+  indirect_draws->begin(current_frame_index);
+
+  /* compute work has to be recorded before the render pass begins */
+  gpu_culling->record(command_buffer, current_frame_index);
+
   // Begin render pass
   VkRenderPassBeginInfo renderpass_info{
     .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
@@ -509,7 +630,24 @@ bool GraphicsAPI::Vulkan::beginFrame() {
   };
   vkCmdBeginRenderPass(command_buffer, &renderpass_info, VK_SUBPASS_CONTENTS_INLINE);
 
-  return false;
+  /* dynamic in every pipeline, they follow the swapchain without being rebuilt */
+  const VkExtent2D extent = getSwapchainExtent();
+  VkViewport viewport {
+    .x        = 0.0f,
+    .y        = 0.0f,
+    .width    = static_cast<float>(extent.width),
+    .height   = static_cast<float>(extent.height),
+    .minDepth = 0.0f,
+    .maxDepth = 1.0f
+  };
+  VkRect2D scissor {
+    .offset { 0, 0 },
+    .extent = extent,
+  };
+  vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+  vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+  return true;
 };
 
 bool GraphicsAPI::Vulkan::endFrame(Window *) {
@@ -518,18 +656,35 @@ bool GraphicsAPI::Vulkan::endFrame(Window *) {
   VkCommandBuffer command_buffer = getCommandBuffer(current_image_index);
   VkSemaphore image_available_semaphore = getImageAvailableSemaphore(current_frame_index);
   VkSemaphore render_finished_semaphore = getRenderFinishedSemaphore(current_frame_index);
+  const std::array wait_semaphores {
+    image_available_semaphore,
+    staging_ring->getTimeline(),
+  };
   const std::array wait_dst_stage_masks {
     static_cast<uint32_t>(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT),
+    static_cast<uint32_t>(StagingRing::CONSUMER_STAGES),
   };
+  const std::array<uint64_t, 2> wait_values { 0, upload_wait_value };
 
   vkCmdEndRenderPass(command_buffer);
   vkEndCommandBuffer(command_buffer);
 
+  /* the staging ring's timeline is only waited on when acquire() handed over buffers still being written */
+  const uint32_t wait_count = upload_wait_value > 0 ? 2 : 1;
+  VkTimelineSemaphoreSubmitInfo timeline_info {
+    .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+    .pNext = VK_NULL_HANDLE,
+    .waitSemaphoreValueCount = wait_count,
+    .pWaitSemaphoreValues = wait_values.data(),
+    .signalSemaphoreValueCount = 0,
+    .pSignalSemaphoreValues = VK_NULL_HANDLE,
+  };
+
   VkSubmitInfo submit_info {
     .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-    .pNext = VK_NULL_HANDLE,
-    .waitSemaphoreCount = 1,
-    .pWaitSemaphores = &image_available_semaphore,
+    .pNext = upload_wait_value > 0 ? &timeline_info : VK_NULL_HANDLE,
+    .waitSemaphoreCount = wait_count,
+    .pWaitSemaphores = wait_semaphores.data(),
     .pWaitDstStageMask = wait_dst_stage_masks.data(),
     .commandBufferCount = 1,
     .pCommandBuffers = &command_buffer,
@@ -552,7 +707,14 @@ bool GraphicsAPI::Vulkan::endFrame(Window *) {
     .pResults = VK_NULL_HANDLE,
   };
 
-  vkQueuePresentKHR(device_manager.getPresentQueue(), &present_info);
+  /* the frame was submitted either way, the swapchain is rebuilt before the next one */
+  VkResult presented = vkQueuePresentKHR(device_manager.getPresentQueue(), &present_info);
+  if (presented == VK_ERROR_OUT_OF_DATE_KHR || presented == VK_SUBOPTIMAL_KHR)
+    swapchain_dirty = true;
+  else if (presented != VK_SUCCESS)
+    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to present (Error: {})", (int32_t)presented);
+
+  ++submitted_frames;
   current_frame_index = (current_frame_index + 1) % GraphicsAPI::Vulkan::MAX_FRAMES_IN_FLIGHT;
   return false;
 };
@@ -573,15 +735,37 @@ bool GraphicsAPI::Vulkan::drawIndexed(DrawInfo &mesh_data) {
   );
   */
 
-  size_t offset = 0;
   auto &vk_draw_data = static_cast<DrawInfo::Vulkan &>(mesh_data);
-  vkCmdBindVertexBuffers(vk_draw_data.command_buffer, 0, 1, &vk_draw_data.vertex_buffer, &offset);
-  vkCmdBindIndexBuffer(vk_draw_data.command_buffer, vk_draw_data.index_buffer, 0, VK_INDEX_TYPE_UINT32);
-  vkCmdDrawIndexed(vk_draw_data.command_buffer,vk_draw_data.index_count, 1, 0, 0, 0);
+  bindGeometry(vk_draw_data.command_buffer, vk_draw_data.vertex_buffer, vk_draw_data.index_buffer);
+
+  vkCmdDrawIndexed(vk_draw_data.command_buffer, vk_draw_data.index_count, vk_draw_data.instance_count,
+                   vk_draw_data.first_index, vk_draw_data.vertex_offset, vk_draw_data.first_instance);
 
   return true;
 }
 
+bool GraphicsAPI::Vulkan::flushDraws() {
+  return indirect_draws->flush(getCommandBuffer(current_image_index));
+}
+
+std::span<Mesh::InstanceData> GraphicsAPI::Vulkan::mapInstances(uint32_t count) {
+  return instance_buffer->map(current_frame_index, count);
+}
+
+void Vulkan::bindGeometry(VkCommandBuffer command_buffer, VkBuffer vertex_buffer, VkBuffer index_buffer) {
+  /* meshes share arena pages, most frames bind their geometry once */
+  if (vertex_buffer != bound_vertex_buffer) {
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertex_buffer, &offset);
+    bound_vertex_buffer = vertex_buffer;
+  }
+
+  if (index_buffer != bound_index_buffer) {
+    vkCmdBindIndexBuffer(command_buffer, index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    bound_index_buffer = index_buffer;
+  }
+}
+
 bool GraphicsAPI::Vulkan::updateUBO(UniformBufferType, const void *, size_t, size_t) {
   return true;
 }
@@ -591,109 +775,80 @@ VkResult Vulkan::submitQueue(VkQueue queue, const std::vector<VkSubmitInfo> &sub
 }
 
 bool Vulkan::createBuffer(void *data, uint32_t size, VkBufferUsageFlags usage, 
-                         VkBuffer &buffer, VkDeviceMemory &memory) {
-  VkBuffer staging_buffer = VK_NULL_HANDLE;
-  VkDeviceMemory staging_memory = VK_NULL_HANDLE;
-
-  if (!createRawBuffer(
-    size,
-    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    staging_buffer,
-    staging_memory)) {
-      LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to create staging buffer");
-      return false;
-    }
-
-  void *mapped = nullptr;
-  vkMapMemory(device_manager->getDevice(), staging_memory, 0, size, 0, &mapped);
-
-  if (data)
-    std::memcpy(mapped, data, size);
-  else
-    std::memset(mapped, 0, size);
-
-  vkUnmapMemory(device_manager->getDevice(), staging_memory);
-
+                         VkBuffer &buffer, Allocation &allocation) {
   if (!createRawBuffer(
       size,
       VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
       buffer,
-      memory))
-      return false;
-
-  VkCommandBuffer command_buffer = beginSingleTimeCommands();
-  if (!command_buffer) {
-    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to begin single time commands");
+      allocation))
     return false;
-  }
-
-  VkBufferCopy copy_region {
-    .srcOffset = 0,
-    .dstOffset = 0,
-    .size = size
-  };
-  vkCmdCopyBuffer(command_buffer, staging_buffer, buffer, 1, &copy_region);
 
-  if(!endSingleTimeCommands(command_buffer)) {
-    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to end single time commands");
+  /* no wait here, the copy goes out with the next staging ring batch */
+  if (!staging_ring->upload(data, size, buffer)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to stage buffer contents");
+    destroyBuffer(buffer, allocation);
     return false;
   }
 
-  vkDestroyBuffer(device_manager->getDevice(), staging_buffer, VK_NULL_HANDLE);
-  vkFreeMemory(device_manager->getDevice(), staging_memory, VK_NULL_HANDLE);
+  requireUpload(staging_ring->getRecordingValue());
   return true;
 }
 
+void Vulkan::requireUpload(uint64_t value) {
+  required_upload = std::max(required_upload, value);
+}
+
 bool Vulkan::createRawBuffer(size_t size,
                            VkBufferUsageFlags usage,
                            VkMemoryPropertyFlags properties,
                            VkBuffer &buffer,
-                           VkDeviceMemory &memory) {
-  VkBufferCreateInfo buffer_info {
-    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-    .pNext = VK_NULL_HANDLE,
-    .flags = 0,
-    .size = size,
-    .usage = usage,
-    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    .queueFamilyIndexCount = 0,
-    .pQueueFamilyIndices = VK_NULL_HANDLE,
-  };
-
-  if (vkCreateBuffer(device_manager->getDevice(), &buffer_info, VK_NULL_HANDLE, &buffer) != VK_SUCCESS) {
+                           Allocation &allocation) {
+  /* sub-allocated from a shared block, large buffers get memory of their own */
+  if (!memory_allocator->createBuffer(size, usage, properties, 0, buffer, allocation)) {
     LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to create buffer");
     return false;
   }
 
-  VkMemoryRequirements mem_requirements {};
-  vkGetBufferMemoryRequirements(device_manager->getDevice(), buffer, &mem_requirements);
+  return true;
+}
+
+bool Vulkan::createStagingBuffer(size_t size, VkBuffer &buffer, Allocation &allocation) {
+  constexpr VkMemoryPropertyFlags HOST = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-  uint32_t memory_type = findMemoryType(mem_requirements.memoryTypeBits, properties);
-  if (memory_type == std::numeric_limits<uint32_t>::max()) {
-    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to find suitable memory type");
+  if (!memory_allocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, HOST, VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                                      buffer, allocation)) {
+    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to create staging buffer");
     return false;
   }
 
-  VkMemoryAllocateInfo alloc_info{
-    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-    .pNext = VK_NULL_HANDLE,
-    .allocationSize = mem_requirements.size,
-    .memoryTypeIndex = memory_type
-  };
+  return true;
+}
 
-  if (vkAllocateMemory(device_manager->getDevice(), &alloc_info, VK_NULL_HANDLE, &memory) != VK_SUCCESS) {
-    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to allocate memory for buffer");
-    return false;
-  }
+void Vulkan::destroyBuffer(VkBuffer &buffer, Allocation &allocation) {
+  memory_allocator->destroyBuffer(buffer, allocation);
+}
 
-  if (vkBindBufferMemory(device_manager->getDevice(), buffer, memory, 0) != VK_SUCCESS) {
-    LOG_ERROR("[GraphicsAPI::Vulkan]: Failed to bind buffer memory");
-    return false;
-  }
+void Vulkan::deferDestroy(std::function<void()> destroy) {
+  deferred_destroys.push_back(DeferredDestroy {
+    .frame = submitted_frames,
+    .destroy = std::move(destroy),
+  });
+}
 
-  return true;
+void Vulkan::collectDeferred(bool everything) {
+  /*
+   * Called right after waiting on the oldest frame's fence: every frame older than
+   * the last MAX_FRAMES_IN_FLIGHT submissions is known to be complete.
+   */
+  while (!deferred_destroys.empty()) {
+    DeferredDestroy &front = deferred_destroys.front();
+    if (!everything && front.frame + MAX_FRAMES_IN_FLIGHT > submitted_frames)
+      break;
+
+    front.destroy();
+    deferred_destroys.pop_front();
+  }
 }
 
 VkCommandBuffer Vulkan::beginSingleTimeCommands() const {
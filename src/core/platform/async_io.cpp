@@ -0,0 +1,435 @@
+#include <core/platform/async_io.hpp>
+#include <core/logging.hpp>
+
+#include <atomic>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace Engine {
+
+/* Larger reads are split, both read() and io_uring cap a single transfer below 2 GiB */
+static constexpr size_t MAX_TRANSFER = size_t(1) << 30;
+
+/* An open file shared by the reads of one batch, closed with the last of them */
+struct AsyncIO::Handle {
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+#else
+  int fd = -1;
+#endif
+  int error = 0;
+
+  explicit Handle(const File::Path &path) noexcept {
+#ifdef _WIN32
+    file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                       nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      error = ENOENT;
+#else
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      error = errno;
+#endif
+  }
+
+  ~Handle() noexcept {
+#ifdef _WIN32
+    if (file != INVALID_HANDLE_VALUE)
+      CloseHandle(file);
+#else
+    if (fd >= 0)
+      ::close(fd);
+#endif
+  }
+};
+
+struct AsyncIO::Operation {
+  std::shared_ptr<Handle> handle;
+  char *destination = nullptr;
+  uint64_t offset = 0;
+  size_t size = 0;
+  size_t done = 0;
+  Callback callback;
+};
+
+#ifdef __linux__
+/* Raw io_uring: the submission and completion rings are shared with the kernel through mmap */
+struct AsyncIO::Ring {
+  int fd = -1;
+  unsigned entries = 0;
+  unsigned unsubmitted = 0; /* pushed but not yet handed to io_uring_enter */
+
+  void *sq_map = nullptr;
+  void *cq_map = nullptr;
+  size_t sq_map_size = 0;
+  size_t cq_map_size = 0;
+  io_uring_sqe *sqes = nullptr;
+  size_t sqes_size = 0;
+
+  unsigned *sq_head = nullptr, *sq_tail = nullptr, *sq_mask = nullptr, *sq_array = nullptr;
+  unsigned *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+  io_uring_cqe *cqes = nullptr;
+
+  Ring() noexcept = default;
+  ~Ring() noexcept {
+    if (sqes)
+      munmap(sqes, sqes_size);
+    if (cq_map && cq_map != sq_map)
+      munmap(cq_map, cq_map_size);
+    if (sq_map)
+      munmap(sq_map, sq_map_size);
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  Ring(const Ring &) = delete;
+  Ring &operator=(const Ring &) = delete;
+
+  static void *map(int fd, size_t size, off_t offset) noexcept {
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return address == MAP_FAILED ? nullptr : address;
+  }
+
+  bool setup(unsigned depth) noexcept {
+    io_uring_params params {};
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    if (fd < 0)
+      return false;
+
+    /* IORING_OP_READ arrived together with this feature (5.6) */
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+      errno = ENOSYS;
+      return false;
+    }
+
+    sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    const bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_map)
+      sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+
+    if (!(sq_map = map(fd, sq_map_size, IORING_OFF_SQ_RING)))
+      return false;
+    if (!(cq_map = single_map ? sq_map : map(fd, cq_map_size, IORING_OFF_CQ_RING)))
+      return false;
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    if (!(sqes = static_cast<io_uring_sqe *>(map(fd, sqes_size, IORING_OFF_SQES))))
+      return false;
+
+    auto sq = static_cast<char *>(sq_map);
+    sq_head  = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail  = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask  = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+    auto cq = static_cast<char *>(cq_map);
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes    = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    entries = params.sq_entries;
+    return true;
+  }
+
+  /* Single producer, callers serialize on AsyncIO::mutex */
+  bool push(const io_uring_sqe &sqe) noexcept {
+    const unsigned tail = *sq_tail;
+    if (tail - std::atomic_ref(*sq_head).load(std::memory_order_acquire) >= entries)
+      return false;
+
+    const unsigned index = tail & *sq_mask;
+    sqes[index] = sqe;
+    sq_array[index] = index;
+    std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+
+    ++unsubmitted;
+    return true;
+  }
+
+  void submit() noexcept {
+    while (unsubmitted > 0) {
+      const int submitted = static_cast<int>(syscall(__NR_io_uring_enter, fd, unsubmitted, 0, 0, nullptr, 0));
+      if (submitted < 0 && errno == EINTR)
+        continue;
+      if (submitted <= 0) {
+        /* the entries stay in the ring and go out with the next submit */
+        if (errno != EAGAIN && errno != EBUSY)
+          LOG_ERROR("[AsyncIO]: io_uring_enter failed, errno {}", errno);
+        return;
+      }
+      unsubmitted -= static_cast<unsigned>(submitted);
+    }
+  }
+
+  /* Blocks until at least one completion is posted */
+  void wait() noexcept {
+    if (syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+      LOG_ERROR("[AsyncIO]: Waiting on io_uring failed, errno {}", errno);
+  }
+
+  /* Single consumer, the reaper thread */
+  template <typename F>
+  void drain(F &&fn) {
+    unsigned head = *cq_head;
+    const unsigned tail = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+
+    for (; head != tail; ++head) {
+      const io_uring_cqe &cqe = cqes[head & *cq_mask];
+      fn(cqe.user_data, cqe.res);
+    }
+
+    std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+  }
+};
+#else
+struct AsyncIO::Ring {};
+#endif
+
+AsyncIO::AsyncIO(ThreadPool &_completions, uint32_t _queue_depth) noexcept :
+  completions(_completions),
+  queue_depth(std::max(_queue_depth, 1u)) {}
+
+AsyncIO::~AsyncIO() noexcept {
+  std::unique_lock lock(mutex);
+  idle.wait(lock, [this] { return outstanding == 0; });
+
+#ifdef __linux__
+  /* a no-op with null user data wakes the reaper for good */
+  if (ring) {
+    io_uring_sqe sqe {};
+    sqe.opcode = IORING_OP_NOP;
+    ring->push(sqe);
+    ring->submit();
+  }
+#endif
+  lock.unlock();
+
+  if (reaper.joinable())
+    reaper.join();
+}
+
+bool AsyncIO::init() {
+#ifdef __linux__
+  auto candidate = std::make_unique<Ring>();
+  if (candidate->setup(queue_depth)) {
+    ring = std::move(candidate);
+    queue_depth = ring->entries;
+    reaper = std::jthread([this](std::stop_token stop) { reap(stop); });
+
+    LOG_INFO("[AsyncIO]: Using io_uring with {} entries", queue_depth);
+    return true;
+  }
+
+  LOG_WARN("[AsyncIO]: io_uring is unavailable (errno {}), falling back to blocking reads", errno);
+#endif
+
+  LOG_INFO("[AsyncIO]: Reading on {} pool thread(s)", completions.getThreadCount());
+  return true;
+}
+
+void AsyncIO::submit(std::span<Read> reads) {
+  std::unordered_map<std::string, std::shared_ptr<Handle>> handles;
+  std::vector<Operation *> operations;
+  operations.reserve(reads.size());
+
+  for (Read &read : reads) {
+    std::shared_ptr<Handle> &handle = handles[read.path.string()];
+    if (!handle)
+      handle = std::make_shared<Handle>(read.path);
+
+    operations.push_back(new Operation {
+      .handle = handle,
+      .destination = static_cast<char *>(read.destination),
+      .offset = read.offset,
+      .size = read.size,
+      .callback = std::move(read.callback),
+    });
+  }
+
+  {
+    std::scoped_lock lock(mutex);
+    outstanding += operations.size();
+  }
+
+  for (Operation *operation : operations) {
+    if (operation->handle->error != 0 || operation->size == 0)
+      finish(operation, Result { .error = operation->handle->error });
+    else
+      start(operation);
+  }
+
+  /* one io_uring_enter for the whole batch */
+  if (ring) {
+    std::scoped_lock lock(mutex);
+    fill();
+  }
+}
+
+std::future<AsyncIO::Result> AsyncIO::read(File::Path path, uint64_t offset, size_t size, void *destination) {
+  auto promise = std::make_shared<std::promise<Result>>();
+  std::future<Result> future = promise->get_future();
+
+  submit(Read {
+    .path = std::move(path),
+    .offset = offset,
+    .size = size,
+    .destination = destination,
+    .callback = [promise](Result result) { promise->set_value(result); },
+  });
+
+  return future;
+}
+
+void AsyncIO::start(Operation *operation) {
+  if (ring) {
+    std::scoped_lock lock(mutex);
+    backlog.push_back(operation);
+    return;
+  }
+
+  completions.enqueue([this, operation] {
+    Result result;
+    readBlocking(*operation, result);
+
+    /* already on the pool, no need to queue the callback separately */
+    Callback callback = std::move(operation->callback);
+    delete operation;
+    callback(result);
+
+    std::scoped_lock lock(mutex);
+    if (--outstanding == 0)
+      idle.notify_all();
+  });
+}
+
+void AsyncIO::finish(Operation *operation, Result result) {
+  completions.enqueue([callback = std::move(operation->callback), result] { callback(result); });
+  delete operation;
+
+  std::scoped_lock lock(mutex);
+  if (--outstanding == 0)
+    idle.notify_all();
+}
+
+void AsyncIO::fill() {
+#ifdef __linux__
+  while (!backlog.empty() && in_flight < queue_depth) {
+    Operation *operation = backlog.front();
+    const size_t length = std::min(operation->size - operation->done, MAX_TRANSFER);
+
+    /* assigned field by field, the unions in io_uring_sqe move between kernel header versions */
+    io_uring_sqe sqe {};
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = operation->handle->fd;
+    sqe.off = operation->offset + operation->done;
+    sqe.addr = reinterpret_cast<uint64_t>(operation->destination + operation->done);
+    sqe.len = static_cast<uint32_t>(length);
+    sqe.user_data = reinterpret_cast<uint64_t>(operation);
+    if (!ring->push(sqe))
+      break;
+
+    backlog.pop_front();
+    ++in_flight;
+  }
+
+  ring->submit();
+#endif
+}
+
+void AsyncIO::reap(std::stop_token) {
+#ifdef __linux__
+  std::vector<std::pair<Operation *, Result>> finished;
+
+  for (bool woken = false; !woken;) {
+    ring->wait();
+
+    {
+      std::scoped_lock lock(mutex);
+      ring->drain([&](uint64_t user_data, int32_t res) {
+        auto operation = reinterpret_cast<Operation *>(user_data);
+        if (!operation) {
+          woken = true;
+          return;
+        }
+
+        --in_flight;
+        if (res < 0) {
+          finished.emplace_back(operation, Result { .bytes = operation->done, .error = -res });
+          return;
+        }
+
+        operation->done += static_cast<size_t>(res);
+        if (res == 0 || operation->done == operation->size)
+          finished.emplace_back(operation, Result { .bytes = operation->done });
+        else
+          backlog.push_front(operation); /* short read, the rest goes out next */
+      });
+
+      fill();
+    }
+
+    for (auto &[operation, result] : finished)
+      finish(operation, result);
+    finished.clear();
+  }
+#endif
+}
+
+void AsyncIO::readBlocking(Operation &operation, Result &result) {
+  while (operation.done < operation.size) {
+    const size_t length = std::min(operation.size - operation.done, MAX_TRANSFER);
+    const uint64_t offset = operation.offset + operation.done;
+    char *destination = operation.destination + operation.done;
+
+#ifdef _WIN32
+    OVERLAPPED overlapped {};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    DWORD read = 0;
+    if (!ReadFile(operation.handle->file, destination, static_cast<DWORD>(length), &read, &overlapped) &&
+        GetLastError() != ERROR_HANDLE_EOF) {
+      result.error = EIO;
+      break;
+    }
+#else
+    const ssize_t read = pread(operation.handle->fd, destination, length, static_cast<off_t>(offset));
+    if (read < 0 && errno == EINTR)
+      continue;
+    if (read < 0) {
+      result.error = errno;
+      break;
+    }
+#endif
+
+    if (read == 0)
+      break;
+    operation.done += static_cast<size_t>(read);
+  }
+
+  result.bytes = operation.done;
+}
+
+} /* namespace Engine */
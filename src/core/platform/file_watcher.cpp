@@ -0,0 +1,119 @@
+#include <core/platform/file_watcher.hpp>
+#include <core/logging.hpp>
+
+#include <array>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace Engine {
+
+FileWatcher::~FileWatcher() noexcept {
+#ifdef __linux__
+  if (fd >= 0)
+    close(fd);
+#endif
+}
+
+std::string FileWatcher::makeKey(const File::Path &path) {
+  std::error_code error;
+  File::Path absolute = std::filesystem::absolute(path, error);
+  return (error ? path : absolute).lexically_normal().string();
+}
+
+bool FileWatcher::init() {
+#ifdef __linux__
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    LOG_ERROR("[FileWatcher]: inotify_init1 failed, errno {}", errno);
+    return false;
+  }
+#endif
+  return true;
+}
+
+bool FileWatcher::watch(const File::Path &path, Callback callback) {
+  std::string key = makeKey(path);
+  Entry &entry = files[key];
+  entry.path = File::Path(key);
+  entry.callbacks.push_back(std::move(callback));
+
+  std::error_code error;
+  entry.last_write = std::filesystem::last_write_time(entry.path, error);
+
+#ifdef __linux__
+  File::Path directory = entry.path.parent_path();
+  /* only finished files: IN_CREATE fires before a new file has any contents */
+  int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (wd < 0) {
+    LOG_ERROR("[FileWatcher]: Unable to watch `{}`, errno {}", directory.string(), errno);
+    return false;
+  }
+
+  /* inotify hands out the same descriptor for a directory that is already watched */
+  directories.emplace(wd, directory);
+#endif
+
+  return true;
+}
+
+void FileWatcher::poll() {
+  std::unordered_set<std::string> changed;
+
+#ifdef __linux__
+  if (fd < 0)
+    return;
+
+  alignas(inotify_event) std::array<char, 4096> buffer;
+
+  while (true) {
+    ssize_t length = read(fd, buffer.data(), buffer.size());
+    if (length <= 0)
+      break;
+
+    for (ssize_t offset = 0; offset < length;) {
+      auto event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+      offset += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        /* events were dropped, treat everything as changed */
+        for (auto &[key, entry] : files)
+          changed.insert(key);
+        continue;
+      }
+
+      auto directory = directories.find(event->wd);
+      if (directory == directories.end() || event->len == 0)
+        continue;
+
+      std::string key = (directory->second / event->name).string();
+      if (files.contains(key))
+        changed.insert(std::move(key));
+    }
+  }
+#else
+  for (auto &[key, entry] : files) {
+    std::error_code error;
+    auto last_write = std::filesystem::last_write_time(entry.path, error);
+    if (!error && last_write != entry.last_write) {
+      entry.last_write = last_write;
+      changed.insert(key);
+    }
+  }
+#endif
+
+  for (const std::string &key : changed) {
+    /* copied, callbacks are free to add watches */
+    Entry entry = files.at(key);
+    LOG_INFO("[FileWatcher]: `{}` changed", entry.path.string());
+
+    for (const Callback &callback : entry.callbacks)
+      callback(entry.path);
+  }
+}
+
+} /* namespace Engine */
@@ -38,35 +38,44 @@ bool Window::init(Config::Window &config) {
                      static_cast<int>(mode->height / 2 - config.height / 2));
   }
 
-  /* Set user pointer for input callbacks */
-  glfwSetWindowUserPointer(handle, &input_manager);
+  /* Set user pointer for window and input callbacks */
+  glfwSetWindowUserPointer(handle, this);
 
-  /* Framebuffer and window size callbacks (currently no-op) */
-  glfwSetFramebufferSizeCallback(handle, [](GLFWwindow * /*handle*/, int /*w*/, int /*h*/) {});
+  /* Framebuffer size callback, the renderer picks the new size up through consumeResize() */
+  glfwSetFramebufferSizeCallback(handle, [](GLFWwindow *handle, int /*w*/, int /*h*/) {
+    auto *window = static_cast<Window *>(glfwGetWindowUserPointer(handle));
+    if (window) window->resized = true;
+  });
   glfwSetWindowSizeCallback(handle, [](GLFWwindow * /*handle*/, int /*w*/, int /*h*/) {});
 
+  /* Refresh callback, keeps frames coming while a resize blocks the event loop */
+  glfwSetWindowRefreshCallback(handle, [](GLFWwindow *handle) {
+    auto *window = static_cast<Window *>(glfwGetWindowUserPointer(handle));
+    if (window && window->on_refresh) window->on_refresh();
+  });
+
   /* Key input callback */
   glfwSetKeyCallback(handle, [](GLFWwindow *handle, int key, int /*scancode*/, int action, int /*mods*/) {
-    auto *input = static_cast<InputManager *>(glfwGetWindowUserPointer(handle));
-    if (input) input->onKey(key, action);
+    auto *window = static_cast<Window *>(glfwGetWindowUserPointer(handle));
+    if (window) window->input_manager.onKey(key, action);
   });
 
   /* Mouse button callback */
   glfwSetMouseButtonCallback(handle, [](GLFWwindow *handle, int button, int action, int /*mods*/) {
-    auto *input = static_cast<InputManager *>(glfwGetWindowUserPointer(handle));
-    if (input) input->onMouseButton(button, action);
+    auto *window = static_cast<Window *>(glfwGetWindowUserPointer(handle));
+    if (window) window->input_manager.onMouseButton(button, action);
   });
 
   /* Cursor position callback */
   glfwSetCursorPosCallback(handle, [](GLFWwindow *handle, double x, double y) {
-    auto *input = static_cast<InputManager *>(glfwGetWindowUserPointer(handle));
-    if (input) input->onMouseMove(x, y);
+    auto *window = static_cast<Window *>(glfwGetWindowUserPointer(handle));
+    if (window) window->input_manager.onMouseMove(x, y);
   });
 
   /* Scroll callback */
   glfwSetScrollCallback(handle, [](GLFWwindow *handle, double x, double y) {
-    auto *input = static_cast<InputManager *>(glfwGetWindowUserPointer(handle));
-    if (input) input->onScroll(x, y);
+    auto *window = static_cast<Window *>(glfwGetWindowUserPointer(handle));
+    if (window) window->input_manager.onScroll(x, y);
   });
 
   /* Window focus and close callbacks (currently no-op) */
@@ -7,9 +7,23 @@
 
 namespace Engine {
 
+Engine::Instance::~Instance() noexcept {
+  /* background loads still in flight finish before the file system goes away */
+  asset_loader.reset();
+  if (File::VFS::instance() == vfs.get())
+    File::VFS::setInstance(nullptr);
+}
+
 bool Engine::Instance::init(Config &config) {
   Engine::Logger::init(config.logger);
 
+  /* Mount asset sources, indexed once here so lookups never touch the disk afterwards */
+  vfs = std::make_unique<File::VFS>();
+  for (const Config::Assets::Mount &mount : config.assets.mounts)
+    if (!vfs->mount(mount.source, mount.mount_point, mount.priority))
+      return false;
+  File::VFS::setInstance(vfs.get());
+
   /* Initialize GLFW */
   if (!glfwInit()) {
     LOG_ERROR("[Engine]: Failed to initialize GLFW library");
@@ -32,6 +46,23 @@ bool Engine::Instance::init(Config &config) {
     return false;
   }
 
+  /* Watch shaders and loaded assets for changes */
+  if (config.assets.hot_reload) {
+    file_watcher = std::make_unique<FileWatcher>();
+    if (!file_watcher->init())
+      return false;
+
+    /* the watcher sees files on disk, pipelines know their shaders by virtual path */
+    for (const Pipeline::ShaderStages &stages : config.renderer.shader_paths)
+      for (const File::Path &path : { stages.vertex, stages.fragment, stages.geometry, stages.compute })
+        if (!path.empty())
+          if (std::optional<File::VFS::Location> location = File::locate(path); location && !location->packed)
+            file_watcher->watch(location->file, [this, path](const File::Path &) { renderer->reloadShader(path); });
+  }
+
+  /* Start background asset loading */
+  asset_loader = std::make_unique<AssetLoader>(*renderer, config.assets.worker_threads, file_watcher.get());
+
   /* Set up default perspective camera */
   camera = std::make_unique<Perspective>(
     config.camera.fov,
@@ -50,48 +81,78 @@ void Engine::Instance::run(Application &app) {
   }
 
   Timer timer;
-  auto tick_interval = window->getTickInterval();
+  bool running = true;
+  bool refreshed = false; /* a frame already ran from within this pollEvents() */
+
+  /* the OS holds pollEvents() while the window is resized, frames keep coming from there */
+  window->setRefreshCallback([&] {
+    if (running)
+      running = frame(app, timer);
+    refreshed = true;
+  });
 
   LOG_INFO("[Engine]: entering loop...");
 
   /* Main loop */
-  while (!window->shouldClose()) {
+  while (running && !window->shouldClose()) {
+    refreshed = false;
     window->pollEvents();
 
-    /* Application update */
-    if (!app.onUpdate()) {
-      return;
-    }
-
-    /* Call tick if interval passed */
-    if (timer.shouldTick(tick_interval)) {
-      app.onTick(timer.deltaTime());
-    }
-
-    /* Begin rendering */
-    renderer->beginFrame();
-
-    /* Update camera UBO (projection * view) */
-    if (!renderer->updateUniformBuffer(
-      UniformBufferType::Camera,
-      camera->getProjectionMatrix() * camera->getViewMatrix()
-    )) {
-      LOG_ERROR("[Engine]: Failed to update camera UBO");
-      return;
-    }
-
-    /* Application rendering */
-    if (!app.onRender()) {
-      return;
-    }
-    
-    /* Finalize frame */
-    renderer->endFrame();
-    
-    window->update();
+    if (running && !refreshed)
+      running = frame(app, timer);
   }
 
+  window->setRefreshCallback({});
   LOG_INFO("[Engine]: exiting loop...");
 }
 
+bool Engine::Instance::frame(Application &app, Timer &timer) {
+  /* Follow framebuffer size changes reported by the window */
+  if (window->consumeResize()) {
+    glm::uvec2 size = window->getFrameBufferSize();
+    if (size.x > 0 && size.y > 0)
+      camera->setAspectRatio(static_cast<float>(size.x) / static_cast<float>(size.y));
+    renderer->resize(size.x, size.y);
+  }
+
+  /* Application update */
+  if (!app.onUpdate()) {
+    return false;
+  }
+
+  /* Call tick if interval passed */
+  if (timer.shouldTick(window->getTickInterval())) {
+    app.onTick(timer.deltaTime());
+  }
+
+  /* Pick up files changed on disk */
+  if (file_watcher)
+    file_watcher->poll();
+
+  /* Hand assets finished in the background over to the renderer */
+  asset_loader->update();
+
+  /* Begin rendering, instances are culled against the camera as the frame starts */
+  const glm::mat4 proj_view = camera->getProjectionMatrix() * camera->getViewMatrix();
+  renderer->setCamera(*camera);
+  renderer->beginFrame();
+
+  /* Update camera UBO (projection * view) */
+  if (!renderer->updateUniformBuffer(UniformBufferType::Camera, proj_view)) {
+    LOG_ERROR("[Engine]: Failed to update camera UBO");
+    return false;
+  }
+
+  /* Application rendering */
+  if (!app.onRender()) {
+    return false;
+  }
+  
+  /* Finalize frame, a skipped frame (minimized window) drops what was queued */
+  renderer->endFrame();
+  
+  window->update();
+  return true;
+}
+
 } /* namespace Engine */
\ No newline at end of file
@@ -45,12 +45,12 @@ int main() {
     .backend = Engine::GraphicsAPI::Backend::Vulkan,
     .shader_paths = {
       {
-        "C:\\Users\\ayxan_5axucza\\source\\repos\\GameEngine\\shaders\\block_vert.spv",
-        "C:\\Users\\ayxan_5axucza\\source\\repos\\GameEngine\\shaders\\block_frag.spv",
-        // "C:\\Users\\ayxan_5axucza\\source\\repos\\GameEngine\\pipelines\\block.vert",
-        // "C:\\Users\\ayxan_5axucza\\source\\repos\\GameEngine\\pipelines\\block.frag",
+        "shaders/block_vert.spv",
+        "shaders/block_frag.spv",
       },
     },
+    .cull_shader = "shaders/cull_comp.spv",
+    .pipeline_cache = "pipeline_cache.bin",
   };
 
   Engine::Config::Camera camera_config {
@@ -59,11 +59,21 @@ int main() {
     .fov = 90.0f,
   };
 
+  /* paths below are virtual, a patch pack mounted with a higher priority overrides either directory */
+  Engine::Config::Assets assets_config {
+    .mounts = {
+      { .source = "assets" },
+      { .source = "shaders", .mount_point = "shaders" },
+    },
+    .hot_reload = true,
+  };
+
   Engine::Config engine_config {
     .logger = logger_config,
     .window = window_config,
     .renderer = renderer_config,
     .camera = camera_config,
+    .assets = assets_config,
   };
 
   Engine::Instance engine;
@@ -77,24 +87,22 @@ int main() {
 
 /* ----------------- Game Implementation ----------------- */
 bool MyGame::onInit() {
-  auto &renderer = instance.getRenderer();
-  auto &camera   = instance.getCamera();
+  auto &loader = instance.getAssetLoader();
+  auto &camera = instance.getCamera();
 
   // Setup camera
   camera.setPosition({0.0f, 20.0f, 20.0f});
   camera.setOrientation({glm::radians(45.0f), glm::radians(-45.0f), -1.0f});
 
-  File::Path path = "assets\\models\\test.obj";
+  File::Path path = "models/test.obj";
 
-  // Upload test mesh
-  auto mesh = Engine::Mesh::fromOBJ(path);
+  // Load test mesh in the background, a placeholder is drawn until it is ready
+  Engine::AssetLoader::MeshHandle mesh = loader.loadMesh(path, {
+    .generate_lods = true,
+    .build_meshlets = true,
+  });
 
-  if(!mesh){
-    LOG_ERROR("unable to load model from file `{}`", path.filename().string());
-    return false;
-  }
-  
-  Engine::Mesh::Handle mesh_handle = renderer.addMesh(mesh.value());
+  Engine::Mesh::Handle mesh_handle = mesh.getMesh();
   emanager.create<Engine::ECS::Component::Mesh, Engine::ECS::Component::Material>(
     Engine::ECS::Component::Mesh {.handle = mesh_handle},
     Engine::ECS::Component::Material {.handle = 0}
@@ -0,0 +1,219 @@
+#include <util/file_utils.hpp>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+namespace File {
+
+/* `allocate(size)` returns where the file goes, the read itself is a loop of plain read() calls */
+template <typename Allocate>
+static bool readInto(const Path &path, Allocate &&allocate) {
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size {};
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+
+  char *out = allocate(static_cast<size_t>(size.QuadPart));
+  size_t done = 0;
+  while (done < static_cast<size_t>(size.QuadPart)) {
+    /* ReadFile counts in DWORDs */
+    const DWORD chunk = static_cast<DWORD>(std::min<size_t>(static_cast<size_t>(size.QuadPart) - done, 1u << 30));
+    DWORD read = 0;
+    if (!ReadFile(file, out + done, chunk, &read, nullptr) || read == 0)
+      break;
+    done += read;
+  }
+
+  CloseHandle(file);
+  return done == static_cast<size_t>(size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat info {};
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  char *out = allocate(size);
+  size_t done = 0;
+  while (done < size) {
+    const ssize_t read = ::read(fd, out + done, size - done);
+    if (read < 0 && errno == EINTR)
+      continue;
+    if (read <= 0)
+      break;
+    done += static_cast<size_t>(read);
+  }
+
+  ::close(fd);
+  return done == size;
+#endif
+}
+
+bool readAll(const Path &path, Buffer &buffer) {
+  const bool read = readInto(path, [&buffer](size_t size) {
+    buffer = Buffer(size);
+    return buffer.data();
+  });
+
+  if (!read)
+    buffer.reset();
+  return read;
+}
+
+bool readContent(const Path &path, std::string &source) {
+  return readInto(path, [&source](size_t size) {
+    source.resize(size);
+    return source.data();
+  });
+}
+
+bool readContentBytes(const Path &path, std::vector<char> &bytes) {
+  return readInto(path, [&bytes](size_t size) {
+    bytes.resize(size);
+    return bytes.data();
+  });
+}
+
+bool MappedFile::open(const Path &path, Access access) {
+  close();
+
+#ifdef _WIN32
+  /* the cache manager takes its readahead policy from the file flags */
+  const DWORD flags = access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+                      access == Access::Random     ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, flags, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  file_handle = file;
+
+  LARGE_INTEGER size {};
+  if (!GetFileSizeEx(file, &size)) {
+    close();
+    return false;
+  }
+
+  /* empty files cannot be mapped */
+  if (size.QuadPart == 0) {
+    close();
+    opened = true;
+    return true;
+  }
+
+  mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping_handle) {
+    close();
+    return false;
+  }
+
+  bytes = static_cast<const char *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+  length = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat info {};
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  /* empty files cannot be mapped */
+  if (info.st_size == 0) {
+    ::close(fd);
+    opened = true;
+    return true;
+  }
+
+  void *address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); /* the mapping keeps the file alive */
+
+  if (address != MAP_FAILED) {
+    bytes = static_cast<const char *>(address);
+    length = static_cast<size_t>(info.st_size);
+  }
+#endif
+
+  if (!bytes) {
+    close();
+    return false;
+  }
+
+  opened = true;
+  advise(access);
+  return true;
+}
+
+void MappedFile::advise(Access access, size_t offset, size_t size) const noexcept {
+  if (!bytes || offset >= length || access == Access::Normal)
+    return;
+
+  size = std::min(size, length - offset);
+
+#ifdef _WIN32
+  /* sequential and random are file flags there, see open() */
+  if (access == Access::WillNeed) {
+    WIN32_MEMORY_RANGE_ENTRY range { .VirtualAddress = const_cast<char *>(bytes) + offset, .NumberOfBytes = size };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+  }
+#else
+  /* madvise wants a page-aligned start, the mapping itself is one */
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t begin = offset & ~(page_size - 1);
+
+  const int advice = access == Access::Sequential ? MADV_SEQUENTIAL :
+                     access == Access::Random     ? MADV_RANDOM : MADV_WILLNEED;
+  madvise(const_cast<char *>(bytes) + begin, offset + size - begin, advice);
+#endif
+}
+
+void MappedFile::close() noexcept {
+#ifdef _WIN32
+  if (bytes)
+    UnmapViewOfFile(bytes);
+  if (mapping_handle)
+    CloseHandle(mapping_handle);
+  if (file_handle)
+    CloseHandle(file_handle);
+#else
+  if (bytes)
+    munmap(const_cast<char *>(bytes), length);
+#endif
+
+  bytes = nullptr;
+  length = 0;
+  opened = false;
+  file_handle = nullptr;
+  mapping_handle = nullptr;
+}
+
+} /* namespace File */
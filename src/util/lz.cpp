@@ -0,0 +1,142 @@
+#include <util/lz.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace LZ {
+
+static constexpr size_t MIN_MATCH      = 4;
+static constexpr size_t LAST_LITERALS  = 5;  /* the block always ends in literals */
+static constexpr size_t MATCH_LIMIT    = 12; /* no match starts this close to the end */
+static constexpr size_t MAX_OFFSET     = 65535;
+static constexpr int HASH_BITS         = 14;
+
+static inline uint32_t read32(const char *p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline void writeLength(std::vector<char> &out, size_t length) {
+  for (; length >= 255; length -= 255)
+    out.push_back(static_cast<char>(255));
+  out.push_back(static_cast<char>(length));
+}
+
+static void writeSequence(std::vector<char> &out, const char *literals, size_t literal_length, size_t offset, size_t match_length) {
+  const size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+  out.push_back(static_cast<char>(std::min<size_t>(literal_length, 15) << 4 | std::min<size_t>(match_code, 15)));
+
+  if (literal_length >= 15)
+    writeLength(out, literal_length - 15);
+  out.insert(out.end(), literals, literals + literal_length);
+
+  if (!match_length)
+    return;
+
+  out.push_back(static_cast<char>(offset & 0xff));
+  out.push_back(static_cast<char>(offset >> 8));
+  if (match_code >= 15)
+    writeLength(out, match_code - 15);
+}
+
+std::vector<char> compress(std::span<const char> in) {
+  std::vector<char> out;
+  out.reserve(in.size() + in.size() / 255 + 16);
+
+  const char *base = in.data();
+  const size_t size = in.size();
+  size_t anchor = 0;
+
+  if (size > MATCH_LIMIT) {
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+    for (size_t i = 1; i + MATCH_LIMIT <= size;) {
+      const uint32_t sequence = read32(base + i);
+      const uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+      const size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(i);
+
+      if (i - candidate > MAX_OFFSET || read32(base + candidate) != sequence) {
+        ++i;
+        continue;
+      }
+
+      size_t length = MIN_MATCH;
+      while (i + length < size - LAST_LITERALS && base[candidate + length] == base[i + length])
+        ++length;
+
+      writeSequence(out, base + anchor, i - anchor, i - candidate, length);
+      i += length;
+      anchor = i;
+    }
+  }
+
+  writeSequence(out, base + anchor, size - anchor, 0, 0);
+  return out;
+}
+
+static inline bool readLength(const char *&in, const char *end, size_t &length) {
+  uint8_t byte;
+  do {
+    if (in == end)
+      return false;
+    byte = static_cast<uint8_t>(*in++);
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+bool decompress(std::span<const char> in, std::span<char> out) {
+  const char *src = in.data();
+  const char *src_end = src + in.size();
+  char *dst = out.data();
+  char *dst_end = dst + out.size();
+
+  while (src < src_end) {
+    const uint8_t token = static_cast<uint8_t>(*src++);
+
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !readLength(src, src_end, literal_length))
+      return false;
+    if (static_cast<size_t>(src_end - src) < literal_length || static_cast<size_t>(dst_end - dst) < literal_length)
+      return false;
+
+    std::memcpy(dst, src, literal_length);
+    src += literal_length;
+    dst += literal_length;
+
+    /* the last sequence has no match */
+    if (src == src_end)
+      break;
+
+    if (src_end - src < 2)
+      return false;
+    const size_t offset = static_cast<uint8_t>(src[0]) | static_cast<size_t>(static_cast<uint8_t>(src[1])) << 8;
+    src += 2;
+
+    size_t match_length = token & 15;
+    if (match_length == 15 && !readLength(src, src_end, match_length))
+      return false;
+    match_length += MIN_MATCH;
+
+    if (offset == 0 || offset > static_cast<size_t>(dst - out.data()) || static_cast<size_t>(dst_end - dst) < match_length)
+      return false;
+
+    /* may overlap its own output, which repeats the last `offset` bytes */
+    const char *match = dst - offset;
+    if (offset >= match_length) {
+      std::memcpy(dst, match, match_length);
+      dst += match_length;
+    }
+    else {
+      for (size_t i = 0; i < match_length; ++i)
+        *dst++ = match[i];
+    }
+  }
+
+  return dst == dst_end;
+}
+
+} /* namespace LZ */
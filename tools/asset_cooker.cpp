@@ -0,0 +1,400 @@
+/*
+ * Cooks every source mesh under a directory into the engine-native format (see Mesh::writeCooked).
+ *
+ *   asset_cooker <asset directory> <output directory> [--threads N] [--force] [--no-lods] [--no-meshlets]
+ *
+ * `models/crate.obj` becomes `<output>/models/crate.mesh`. Meshes are cooked in parallel, one per job.
+ * <output>/.cook_db remembers the inputs, their dependencies and a content hash of each cook,
+ * so a rerun only touches assets whose files (or the cooker settings) changed; --force cooks everything.
+ */
+#include <core/logging.hpp>
+#include <core/thread_pool.hpp>
+#include <core/graphics/mesh.hpp>
+#include <util/hash.hpp>
+#include <util/file_utils.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+/* bump whenever the cooked output of the same input changes, format changes are picked up from Mesh::COOKED_VERSION */
+static constexpr uint32_t COOKER_VERSION = 1;
+
+enum Stage : size_t { Import, Optimize, LODs, Meshlets, Write, StageCount };
+static constexpr std::array<std::string_view, StageCount> STAGE_NAMES { "import", "optimize", "lods", "meshlets", "write" };
+
+struct Settings {
+  bool lods = true;
+  bool meshlets = true;
+  bool force = false;
+  uint32_t threads = 0;
+};
+
+/* A file a cook read, with the stats it had back then */
+struct Dependency {
+  std::string path; /* relative to the asset directory */
+  uint64_t size = 0;
+  int64_t mtime = 0;
+};
+
+struct Record {
+  Hash::Hash128 settings {};
+  Hash::Hash128 content {};
+  std::vector<Dependency> dependencies; /* the input itself comes first */
+};
+
+using Database = std::unordered_map<std::string, Record>;
+
+struct Job {
+  std::string input; /* relative to the asset directory */
+  File::Path source;
+  File::Path output;
+
+  enum class Result { Skipped, Cooked, Failed } result = Result::Failed;
+  Record record;
+};
+
+struct Timings {
+  std::array<std::atomic<uint64_t>, StageCount> nanoseconds {};
+
+  template <typename F>
+  auto measure(Stage stage, F &&fn) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    nanoseconds[stage].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+    return result;
+  }
+};
+
+static std::string toHex(const Hash::Hash128 &hash) {
+  return std::format("{:016x}{:016x}", hash.high, hash.low);
+}
+
+static bool fromHex(std::string_view text, Hash::Hash128 &hash) {
+  if (text.size() != 32)
+    return false;
+
+  uint64_t parts[2] {};
+  for (size_t i = 0; i < 32; ++i) {
+    const char c = text[i];
+    const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    if (digit < 0)
+      return false;
+    parts[i / 16] = (parts[i / 16] << 4) | static_cast<uint64_t>(digit);
+  }
+
+  hash = Hash::Hash128 { .low = parts[1], .high = parts[0] };
+  return true;
+}
+
+/*
+ * One line per input, tab separated:
+ *   input  settings-hash  content-hash  (dependency  size  mtime)...
+ * Unreadable lines are dropped, which only costs a recook.
+ */
+static Database loadDatabase(const File::Path &path) {
+  Database database;
+  std::ifstream ifs(path);
+
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    for (std::string field; std::getline(stream, field, '\t');)
+      fields.push_back(std::move(field));
+
+    Record record;
+    if (fields.size() < 3 || (fields.size() - 3) % 3 != 0 || !fromHex(fields[1], record.settings) || !fromHex(fields[2], record.content))
+      continue;
+
+    bool valid = true;
+    for (size_t i = 3; i < fields.size() && valid; i += 3) {
+      try {
+        record.dependencies.push_back(Dependency { .path = fields[i], .size = std::stoull(fields[i + 1]), .mtime = std::stoll(fields[i + 2]) });
+      } catch (const std::exception &) {
+        valid = false;
+      }
+    }
+
+    if (valid)
+      database[fields[0]] = std::move(record);
+  }
+
+  return database;
+}
+
+/* Written next to the old one and renamed over it, an interrupted save keeps the previous database */
+static bool saveDatabase(const File::Path &path, const Database &database) {
+  std::vector<const Database::value_type *> sorted;
+  for (const auto &entry : database)
+    sorted.push_back(&entry);
+  std::sort(sorted.begin(), sorted.end(), [](auto *a, auto *b) { return a->first < b->first; });
+
+  File::Path temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream ofs(temporary, std::ios::trunc);
+    for (const auto *entry : sorted) {
+      ofs << entry->first << '\t' << toHex(entry->second.settings) << '\t' << toHex(entry->second.content);
+      for (const Dependency &dependency : entry->second.dependencies)
+        ofs << '\t' << dependency.path << '\t' << dependency.size << '\t' << dependency.mtime;
+      ofs << '\n';
+    }
+    if (!ofs)
+      return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  return !error;
+}
+
+static Hash::Hash128 settingsHash(const Settings &settings) {
+  const std::string text = std::format("asset_cooker {} / mesh {}|lods={}|meshlets={}", COOKER_VERSION,
+                                       Engine::Mesh::COOKED_VERSION, settings.lods, settings.meshlets);
+  return Hash::murmur3_128(text.data(), text.size());
+}
+
+/* External buffers of a .gltf, found by their "uri" values; data: URIs are embedded and .glb files self-contained */
+static std::vector<std::string> gltfBuffers(const File::Path &source) {
+  std::vector<std::string> uris;
+  std::string text;
+  if (source.extension() != ".gltf" || !File::readContent(source, text))
+    return uris;
+
+  for (size_t at = text.find("\"uri\""); at != std::string::npos; at = text.find("\"uri\"", at + 5)) {
+    const size_t colon = text.find(':', at + 5);
+    const size_t open = colon == std::string::npos ? colon : text.find('"', colon + 1);
+    const size_t close = open == std::string::npos ? open : text.find('"', open + 1);
+    if (close == std::string::npos)
+      break;
+
+    std::string uri = text.substr(open + 1, close - open - 1);
+    if (!uri.starts_with("data:"))
+      uris.push_back(std::move(uri));
+  }
+
+  return uris;
+}
+
+static bool readStats(const File::Path &root, Dependency &dependency) {
+  std::error_code error;
+  const File::Path path = root / dependency.path;
+
+  const auto size = std::filesystem::file_size(path, error);
+  if (error)
+    return false;
+  const auto mtime = std::filesystem::last_write_time(path, error);
+  if (error)
+    return false;
+
+  dependency.size = size;
+  dependency.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+  return true;
+}
+
+/* Fresh dependency stats and the hash of their bytes, which is what decides whether a cook is stale */
+static bool hashInputs(const File::Path &root, const Job &job, Record &record) {
+  record.dependencies.clear();
+  record.dependencies.push_back(Dependency { .path = job.input });
+
+  const File::Path directory = File::Path(job.input).parent_path();
+  for (const std::string &uri : gltfBuffers(job.source))
+    record.dependencies.push_back(Dependency { .path = (directory / uri).lexically_normal().generic_string() });
+
+  Hash::Murmur3_128 hasher;
+  for (Dependency &dependency : record.dependencies) {
+    File::MappedFile bytes;
+    if (!readStats(root, dependency) || !bytes.open(root / dependency.path, File::MappedFile::Access::Sequential))
+      return false;
+
+    hasher.update(dependency.path.data(), dependency.path.size() + 1);
+    hasher.update(bytes.data(), bytes.size());
+  }
+
+  record.content = hasher.finish();
+  return true;
+}
+
+static bool upToDate(const File::Path &root, const Job &job, const Record &previous) {
+  std::error_code error;
+  if (!std::filesystem::exists(job.output, error))
+    return false;
+
+  for (const Dependency &dependency : previous.dependencies) {
+    Dependency current { .path = dependency.path };
+    if (!readStats(root, current) || current.size != dependency.size || current.mtime != dependency.mtime)
+      return false;
+  }
+
+  return !previous.dependencies.empty();
+}
+
+static bool cook(const Job &job, const Settings &settings, Timings &timings) {
+  std::optional<Engine::Mesh> mesh = timings.measure(Import, [&] {
+    return job.source.extension() == ".obj" ? Engine::Mesh::fromOBJ(job.source) : Engine::Mesh::fromGLTF(job.source);
+  });
+  if (!mesh)
+    return false;
+
+  timings.measure(Optimize, [&] { return mesh->optimizeVertexFetch(); });
+  if (settings.lods)
+    timings.measure(LODs, [&] { return mesh->generateLODs(Engine::Mesh::LODSettings{}); });
+  if (settings.meshlets)
+    timings.measure(Meshlets, [&] { return mesh->buildMeshlets(); });
+
+  return timings.measure(Write, [&] {
+    std::error_code error;
+    std::filesystem::create_directories(job.output.parent_path(), error);
+
+    File::Path temporary = job.output;
+    temporary += ".tmp";
+    if (!mesh->writeCooked(temporary))
+      return false;
+
+    std::filesystem::rename(temporary, job.output, error);
+    return !error;
+  });
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: asset_cooker <asset directory> <output directory> [--threads N] [--force] [--no-lods] [--no-meshlets]\n";
+    return 1;
+  }
+
+  const File::Path root = argv[1];
+  const File::Path output = argv[2];
+
+  Settings settings;
+  for (int i = 3; i < argc; ++i) {
+    const std::string_view argument = argv[i];
+    if (argument == "--force")
+      settings.force = true;
+    else if (argument == "--no-lods")
+      settings.lods = false;
+    else if (argument == "--no-meshlets")
+      settings.meshlets = false;
+    else if (argument == "--threads" && i + 1 < argc)
+      settings.threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    else {
+      std::cerr << std::format("asset_cooker: unknown option `{}`\n", argument);
+      return 1;
+    }
+  }
+
+  /* the mesh code reports through the engine logger */
+  Engine::Config::Logger logger_config;
+  Engine::Logger::init(logger_config);
+
+  std::error_code error;
+  std::vector<Job> jobs;
+  std::unordered_map<std::string, std::string> outputs;
+
+  for (const auto &entry : std::filesystem::recursive_directory_iterator(root, error)) {
+    const File::Path extension = entry.path().extension();
+    if (!entry.is_regular_file() || (extension != ".obj" && extension != ".gltf" && extension != ".glb"))
+      continue;
+
+    Job job;
+    job.source = entry.path();
+    job.input = entry.path().lexically_relative(root).generic_string();
+    job.output = output / File::Path(job.input).replace_extension(".mesh");
+
+    auto [it, inserted] = outputs.emplace(job.output.generic_string(), job.input);
+    if (!inserted) {
+      std::cerr << std::format("asset_cooker: `{}` and `{}` would both cook to `{}`\n", it->second, job.input, it->first);
+      return 1;
+    }
+    jobs.push_back(std::move(job));
+  }
+
+  if (error) {
+    std::cerr << std::format("asset_cooker: cannot read `{}`: {}\n", root.string(), error.message());
+    return 1;
+  }
+
+  std::sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b) { return a.input < b.input; });
+
+  std::filesystem::create_directories(output, error);
+  const File::Path database_path = output / ".cook_db";
+  const Database previous = settings.force ? Database{} : loadDatabase(database_path);
+  const Hash::Hash128 settings_hash = settingsHash(settings);
+
+  Timings timings;
+  std::mutex report_mutex;
+  const auto start = std::chrono::steady_clock::now();
+
+  /* every job is a whole mesh, the mesh passes themselves stay single-threaded */
+  Engine::ThreadPool pool(settings.threads);
+  pool.parallelFor(jobs.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      Job &job = jobs[i];
+      auto it = previous.find(job.input);
+      const Record *cached = it != previous.end() && it->second.settings == settings_hash ? &it->second : nullptr;
+
+      /* unchanged stats are trusted, changed ones fall back to comparing content */
+      if (cached && upToDate(root, job, *cached)) {
+        job.record = *cached;
+        job.result = Job::Result::Skipped;
+        continue;
+      }
+
+      job.record.settings = settings_hash;
+      if (!hashInputs(root, job, job.record)) {
+        std::scoped_lock lock(report_mutex);
+        std::cerr << std::format("asset_cooker: cannot read the inputs of `{}`\n", job.input);
+        job.result = Job::Result::Failed;
+        continue;
+      }
+
+      std::error_code exists_error;
+      if (cached && cached->content == job.record.content && std::filesystem::exists(job.output, exists_error)) {
+        job.result = Job::Result::Skipped;
+        continue;
+      }
+
+      job.result = cook(job, settings, timings) ? Job::Result::Cooked : Job::Result::Failed;
+
+      std::scoped_lock lock(report_mutex);
+      std::cout << std::format("asset_cooker: {} `{}`\n", job.result == Job::Result::Cooked ? "cooked" : "FAILED", job.input);
+    }
+  });
+
+  const auto wall = std::chrono::steady_clock::now() - start;
+
+  /* failed inputs are left out, so the next run retries them */
+  Database database;
+  size_t counts[3] {};
+  for (Job &job : jobs) {
+    ++counts[static_cast<size_t>(job.result)];
+    if (job.result != Job::Result::Failed)
+      database[job.input] = std::move(job.record);
+  }
+
+  if (!saveDatabase(database_path, database))
+    std::cerr << std::format("asset_cooker: cannot write `{}`\n", database_path.string());
+
+  std::cout << std::format("asset_cooker: {} cooked, {} up to date, {} failed in {:.1f} ms\n",
+    counts[static_cast<size_t>(Job::Result::Cooked)], counts[static_cast<size_t>(Job::Result::Skipped)],
+    counts[static_cast<size_t>(Job::Result::Failed)], std::chrono::duration<double, std::milli>(wall).count());
+
+  /* summed over all workers, so the stages can add up to more than the wall time */
+  for (size_t stage = 0; stage < StageCount; ++stage)
+    std::cout << std::format("  {:<9} {:10.1f} ms\n", STAGE_NAMES[stage], timings.nanoseconds[stage].load() / 1e6);
+
+  return counts[static_cast<size_t>(Job::Result::Failed)] == 0 ? 0 : 1;
+}
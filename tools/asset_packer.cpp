@@ -0,0 +1,78 @@
+/*
+ * Packs a directory into an asset archive (see core/assets/pack.hpp).
+ *
+ *   asset_packer <asset directory> <output pack> [--store]
+ *
+ * Entries are named by their path relative to the directory, --store skips compression.
+ */
+#include <core/logging.hpp>
+#include <core/assets/pack.hpp>
+#include <util/file_utils.hpp>
+
+#include <vector>
+#include <format>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: asset_packer <asset directory> <output pack> [--store]\n";
+    return 1;
+  }
+
+  const File::Path root = argv[1];
+  const File::Path output = argv[2];
+  const bool store = argc > 3 && std::string_view(argv[3]) == "--store";
+
+  /* Pack reports through the engine logger */
+  Engine::Config::Logger logger_config;
+  Engine::Logger::init(logger_config);
+
+  std::error_code error;
+  std::vector<File::Path> files;
+  for (const auto &entry : std::filesystem::recursive_directory_iterator(root, error))
+    if (entry.is_regular_file())
+      files.push_back(entry.path());
+
+  if (error) {
+    std::cerr << std::format("asset_packer: cannot read `{}`: {}\n", root.string(), error.message());
+    return 1;
+  }
+
+  /* same input, same archive */
+  std::sort(files.begin(), files.end());
+
+  Engine::Pack::Writer writer;
+  if (!writer.open(output)) {
+    std::cerr << std::format("asset_packer: cannot write `{}`\n", output.string());
+    return 1;
+  }
+
+  const auto compression = store ? Engine::Pack::Compression::None : Engine::Pack::Compression::LZ;
+  uint64_t input_bytes = 0;
+
+  for (const File::Path &file : files) {
+    File::MappedFile data;
+    if (!data.open(file, File::MappedFile::Access::Sequential)) {
+      std::cerr << std::format("asset_packer: cannot read `{}`\n", file.string());
+      return 1;
+    }
+
+    const std::string name = file.lexically_relative(root).generic_string();
+    if (!writer.add(name, data.view(), compression)) {
+      std::cerr << std::format("asset_packer: failed to add `{}`\n", name);
+      return 1;
+    }
+    input_bytes += data.size();
+  }
+
+  if (!writer.finish()) {
+    std::cerr << std::format("asset_packer: failed to finish `{}`\n", output.string());
+    return 1;
+  }
+
+  std::cout << std::format("asset_packer: {} files, {} -> {} bytes\n", writer.getEntryCount(), input_bytes, writer.getStoredBytes());
+  return 0;
+}